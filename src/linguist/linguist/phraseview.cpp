@@ -75,12 +75,16 @@ PhraseView::PhraseView(MultiDataModel *model, QList<QHash<QString, QList<Phrase
     header()->restoreState(QSettings().value(phraseViewHeaderKey()).toByteArray());
 
     connect(this, SIGNAL(activated(QModelIndex)), this, SLOT(selectPhrase(QModelIndex)));
+    connect(m_dataModel, SIGNAL(modelAppended()), this, SLOT(clearGuessIndexes()));
+    connect(m_dataModel, SIGNAL(modelDeleted(int)), this, SLOT(clearGuessIndexes()));
+    connect(m_dataModel, SIGNAL(allModelsDeleted()), this, SLOT(clearGuessIndexes()));
 }
 
 PhraseView::~PhraseView()
 {
     QSettings().setValue(phraseViewHeaderKey(), header()->saveState());
     deleteGuesses();
+    clearGuessIndexes();
 }
 
 void PhraseView::toggleGuessing()
@@ -187,18 +191,49 @@ void PhraseView::resetNumGuesses()
     setSourceText(m_modelIndex, m_sourceText);
 }
 
-static CandidateList similarTextHeuristicCandidates(MultiDataModel *model, int mi,
-    const char *text, int maxCandidates)
+/*
+  The source texts of the messages of one model, in the order of the
+  model, so that guessing does not go through all of them again each
+  time another message is selected. Whether a message can serve as a
+  guess depends on its translation, which is checked for each guess.
+*/
+class GuessIndex
+{
+public:
+    SimilarTextIndex texts;
+    QVector<MultiDataIndex> messages;
+};
+
+const GuessIndex *PhraseView::guessIndex(int model)
+{
+    GuessIndex *&index = m_guessIndexes[model];
+    if (!index) {
+        index = new GuessIndex;
+        for (MultiDataModelIterator it(m_dataModel, model); it.isValid(); ++it) {
+            if (MessageItem *m = it.current()) {
+                index->texts.append(m->text());
+                index->messages.append(it);
+            }
+        }
+    }
+    return index;
+}
+
+void PhraseView::clearGuessIndexes()
+{
+    qDeleteAll(m_guessIndexes);
+    m_guessIndexes.clear();
+}
+
+static CandidateList similarTextHeuristicCandidates(MultiDataModel *model,
+    const GuessIndex *index, const char *text, int maxCandidates)
 {
     QList<int> scores;
     CandidateList candidates;
 
-    StringSimilarityMatcher stringmatcher(QString::fromLatin1(text));
-
-    for (MultiDataModelIterator it(model, mi); it.isValid(); ++it) {
-        MessageItem *m = it.current();
-        if (!m)
-            continue;
+    foreach (const SimilarTextIndex::Match &match,
+             index->texts.matches(QString::fromLatin1(text))) {
+        MessageItem *m = model->messageItem(index->messages.at(match.index));
 
         TranslatorMessage mtm = m->message();
         if (mtm.type() == TranslatorMessage::Unfinished
@@ -207,7 +242,7 @@ static CandidateList similarTextHeuristicCandidates(MultiDataModel *model, int m
 
         QString s = m->text();
 
-        int score = stringmatcher.getSimilarityScore(s);
+        int score = match.score;
 
         if (candidates.count() == maxCandidates && score > scores[maxCandidates - 1])
             candidates.removeLast();
@@ -249,7 +284,7 @@ void PhraseView::setSourceText(int model, const QString &sourceText)
         m_phraseModel->addPhrase(p);
 
     if (!sourceText.isEmpty() && m_doGuesses) {
-        CandidateList cl = similarTextHeuristicCandidates(m_dataModel, model,
+        CandidateList cl = similarTextHeuristicCandidates(m_dataModel, guessIndex(model),
             sourceText.toLatin1(), m_maxCandidates);
         int n = 0;
         foreach (const Candidate &candidate, cl) {
@@ -38,6 +38,7 @@ QT_BEGIN_NAMESPACE
 
 static const int DefaultMaxCandidates = 5;
 
+class GuessIndex;
 class MultiDataModel;
 class PhraseModel;
 
@@ -99,14 +100,17 @@ private slots:
     void moreGuesses();
     void fewerGuesses();
     void resetNumGuesses();
+    void clearGuessIndexes();
 
 private:
     QList<Phrase *> getPhrases(int model, const QString &sourceText);
     void deleteGuesses();
+    const GuessIndex *guessIndex(int model);
 
     MultiDataModel *m_dataModel;
     QList<QHash<QString, QList<Phrase *> > > *m_phraseDict;
     QList<Phrase *> m_guesses;
+    QHash<int, GuessIndex *> m_guessIndexes;
     PhraseModel *m_phraseModel;
     QString m_sourceText;
     int m_modelIndex;
@@ -29,10 +29,20 @@
 #include "cpp.h"
 
 #include <translator.h>
+#include <QtCore/QAtomicInt>
 #include <QtCore/QBitArray>
+#include <QtCore/QByteArrayList>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QMutex>
+#include <QtCore/QSaveFile>
 #include <QtCore/QStack>
 #include <QtCore/QTextCodec>
 #include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+
+#include <sstream>
 
 QT_BEGIN_NAMESPACE
 
@@ -48,32 +58,36 @@ static QString MagicComment(QLatin1String("TRANSLATOR"));
 
 uint qHash(const HashString &str)
 {
-    if (str.m_hash & 0x80000000)
-        str.m_hash = qHash(str.m_str) & 0x7fffffff;
-    return str.m_hash;
+    uint hash = str.m_hash.loadRelaxed();
+    if (hash & 0x80000000) {
+        hash = qHash(str.m_str) & 0x7fffffff;
+        str.m_hash.storeRelaxed(hash);
+    }
+    return hash;
 }
 
 
 uint qHash(const HashStringList &list)
 {
-    if (list.m_hash & 0x80000000) {
-        uint hash = 0;
+    uint hash = list.m_hash.loadRelaxed();
+    if (hash & 0x80000000) {
+        hash = 0;
         foreach (const HashString &qs, list.m_list) {
             hash ^= qHash(qs) ^ 0x6ad9f526;
             hash = ((hash << 13) & 0x7fffffff) | (hash >> 18);
         }
-        list.m_hash = hash;
+        list.m_hash.storeRelaxed(hash);
     }
-    return list.m_hash;
+    return hash;
 }
 
-static int nextFileId;
+static QAtomicInt nextFileId;
 
 class VisitRecorder {
 public:
     VisitRecorder()
     {
-        m_ba.resize(nextFileId);
+        m_ba.resize(nextFileId.loadRelaxed());
     }
     bool tryVisit(int fileId)
     {
@@ -86,12 +100,287 @@ private:
     QBitArray m_ba;
 };
 
+/*
+  Collects the warnings given while a file is parsed, so that they
+  can be printed in the order of the files even when the file was
+  parsed ahead of its turn.
+*/
+class WarningRecorder {
+public:
+    struct Warning {
+        QByteArray text;
+        Namespace *once; // the class that lacks Q_OBJECT, complained about once
+    };
+
+    WarningRecorder();
+    ~WarningRecorder();
+
+    QVector<Warning> takeWarnings();
+
+    static std::ostream &stream(Namespace *once);
+    static QByteArrayList print(const QVector<Warning> &warnings);
+
+private:
+    void flush();
+
+    QVector<Warning> m_warnings;
+    std::ostringstream m_text;
+    Namespace *m_once;
+    bool m_pending;
+    WarningRecorder *m_parent;
+
+    static thread_local WarningRecorder *s_current;
+};
+
+thread_local WarningRecorder *WarningRecorder::s_current = 0;
+
+WarningRecorder::WarningRecorder()
+    : m_once(0), m_pending(false), m_parent(s_current)
+{
+    s_current = this;
+}
+
+WarningRecorder::~WarningRecorder()
+{
+    s_current = m_parent;
+}
+
+void WarningRecorder::flush()
+{
+    if (!m_pending)
+        return;
+    Warning warning;
+    warning.text = QByteArray::fromStdString(m_text.str());
+    warning.once = m_once;
+    m_warnings << warning;
+    m_text.str(std::string());
+    m_pending = false;
+}
+
+QVector<WarningRecorder::Warning> WarningRecorder::takeWarnings()
+{
+    flush();
+    QVector<Warning> warnings;
+    warnings.swap(m_warnings);
+    return warnings;
+}
+
+/*
+  Returns the stream the next warning goes to: std::cerr, unless
+  the warnings of the current thread are being recorded.
+*/
+std::ostream &WarningRecorder::stream(Namespace *once)
+{
+    if (!s_current)
+        return std::cerr;
+    s_current->flush();
+    s_current->m_once = once;
+    s_current->m_pending = true;
+    return s_current->m_text;
+}
+
+/*
+  Prints \a warnings and returns the ones that were printed.
+*/
+QByteArrayList WarningRecorder::print(const QVector<Warning> &warnings)
+{
+    QByteArrayList printed;
+    foreach (const Warning &warning, warnings) {
+        if (warning.once) {
+            if (warning.once->complained)
+                continue;
+            warning.once->complained = true;
+        }
+        std::cerr << warning.text.constData();
+        printed << warning.text;
+    }
+    return printed;
+}
+
+/*
+  A file that is parsed ahead of its turn, on a worker thread or
+  before the files listed in front of it, must not change what the
+  parses of other files see. Its changes to CppFiles, and to the
+  namespaces of results it shares with other files, go to an overlay
+  on top of the overlay it was started from instead. loadCPP()
+  applies the overlay when it is the file's turn, if the parse would
+  still have been the same then.
+*/
+struct ParseOverlay {
+    explicit ParseOverlay(const ParseOverlay *base = 0) : base(base), conflict(false) {}
+    ~ParseOverlay() { qDeleteAll(discardedResults); }
+
+    void merge(const ParseOverlay &other);
+    void apply() const;
+    bool matchesNamespaces() const;
+
+    static ParseOverlay *current() { return s_current; }
+    static void setCurrent(ParseOverlay *overlay) { s_current = overlay; }
+
+    const ParseOverlay *base;
+    IncludeCycleHash includeCycles;
+    TranslatorHash translatedFiles;
+    QSet<QString> blacklistedFiles;
+    DependencyHash dependencies;
+    QHash<Namespace *, QString> trQualifications;
+    QHash<Namespace *, QString> trQualificationsRead; // As first seen, unless set by the parse
+    QHash<Namespace *, QHash<HashString, NamespaceList> > resolvedAliases; // Empty if unresolvable
+    QSet<Namespace *> complained;
+    QList<ParseResults *> discardedResults;
+    bool conflict; // The parse changed an include cycle that it did not create.
+
+private:
+    static thread_local ParseOverlay *s_current;
+};
+
+thread_local ParseOverlay *ParseOverlay::s_current = 0;
+
+template <typename Hash>
+static void insertMissing(Hash *hash, const Hash &other)
+{
+    for (auto it = other.cbegin(), end = other.cend(); it != end; ++it) {
+        if (!hash->contains(it.key()))
+            hash->insert(it.key(), it.value());
+    }
+}
+
+/*
+  Adds the changes of \a other, an overlay on top of this one, so
+  that the parses started from this overlay see them.
+*/
+void ParseOverlay::merge(const ParseOverlay &other)
+{
+    insertMissing(&includeCycles, other.includeCycles);
+    insertMissing(&translatedFiles, other.translatedFiles);
+    blacklistedFiles.unite(other.blacklistedFiles);
+    insertMissing(&dependencies, other.dependencies);
+    insertMissing(&trQualifications, other.trQualifications);
+}
+
+/*
+  Makes the changes of the overlay, which must not have a conflict,
+  to CppFiles and the namespaces. Results of files that got results
+  in the meantime are dropped, as a serial parse would have used
+  those.
+*/
+void ParseOverlay::apply() const
+{
+    insertMissing(&CppFiles::includeCycles(), includeCycles);
+    insertMissing(&CppFiles::translatedFiles(), translatedFiles);
+    CppFiles::blacklistedFiles().unite(blacklistedFiles);
+    insertMissing(&CppFiles::dependencies(), dependencies);
+    for (auto it = trQualifications.cbegin(), end = trQualifications.cend(); it != end; ++it) {
+        if (it.key()->trQualification.isEmpty())
+            it.key()->trQualification = it.value();
+    }
+    for (auto it = resolvedAliases.cbegin(), end = resolvedAliases.cend(); it != end; ++it) {
+        QHash<HashString, NamespaceList> &aliases = it.key()->aliases;
+        for (auto ait = it->cbegin(), aend = it->cend(); ait != aend; ++ait) {
+            auto real = aliases.find(ait.key());
+            if (real == aliases.end() || !real->last().value().isEmpty())
+                continue;
+            if (ait->isEmpty())
+                aliases.erase(real);
+            else
+                *real = *ait;
+        }
+    }
+    foreach (Namespace *ns, complained)
+        ns->complained = true;
+}
+
+/*
+  Returns whether the namespace state the overlay's parse read or
+  resolved is what a serial parse would find at the file's turn,
+  when the files in front of it have made their changes.
+*/
+bool ParseOverlay::matchesNamespaces() const
+{
+    for (auto it = trQualificationsRead.cbegin(), end = trQualificationsRead.cend(); it != end; ++it) {
+        if (it.key()->trQualification != it.value())
+            return false;
+    }
+    for (auto it = resolvedAliases.cbegin(), end = resolvedAliases.cend(); it != end; ++it) {
+        const QHash<HashString, NamespaceList> &aliases = it.key()->aliases;
+        for (auto ait = it->cbegin(), aend = it->cend(); ait != aend; ++ait) {
+            auto real = aliases.constFind(ait.key());
+            if (real == aliases.constEnd()) {
+                if (!ait->isEmpty())
+                    return false;
+            } else if (!real->last().value().isEmpty() && *real != *ait) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static QString trQualification(Namespace *ns)
+{
+    ParseOverlay * const current = ParseOverlay::current();
+    if (!current)
+        return ns->trQualification;
+    auto it = current->trQualifications.constFind(ns);
+    if (it != current->trQualifications.constEnd())
+        return *it;
+
+    QString qualification = ns->trQualification;
+    for (const ParseOverlay *overlay = current->base; overlay; overlay = overlay->base) {
+        auto bit = overlay->trQualifications.constFind(ns);
+        if (bit != overlay->trQualifications.constEnd()) {
+            qualification = *bit;
+            break;
+        }
+    }
+    if (!current->trQualificationsRead.contains(ns))
+        current->trQualificationsRead.insert(ns, qualification);
+    return qualification;
+}
+
+static void setTrQualification(Namespace *ns, const QString &qualification)
+{
+    if (ParseOverlay *overlay = ParseOverlay::current())
+        overlay->trQualifications.insert(ns, qualification);
+    else
+        ns->trQualification = qualification;
+}
+
+/*
+  The complaints of the overlays below do not count: which file
+  complains first is decided when the warnings are printed.
+*/
+static bool hasComplained(Namespace *ns)
+{
+    const ParseOverlay * const overlay = ParseOverlay::current();
+    return ns->complained || (overlay && overlay->complained.contains(ns));
+}
+
+static void setComplained(Namespace *ns)
+{
+    if (ParseOverlay *overlay = ParseOverlay::current())
+        overlay->complained.insert(ns);
+    else
+        ns->complained = true;
+}
+
+static void discardResults(ParseResults *results)
+{
+    // Its namespaces may be in the tables of the overlay.
+    if (ParseOverlay *overlay = ParseOverlay::current())
+        overlay->discardedResults << results;
+    else
+        delete results;
+}
+
+struct QualifyOneData;
+
 class CppParser {
 
 public:
     CppParser(ParseResults *results = 0);
     void setInput(const QString &in);
     void setInput(QTextStream &ts, const QString &fileName);
+    void setInput(const QString &in, QTextCodec *codec, const QString &fileName);
     void setTranslator(Translator *_tor) { tor = _tor; }
     void parse(ConversionData &cd, const QStringList &includeStack, QSet<QString> &inclusions);
     void parseInternal(ConversionData &cd, const QStringList &includeStack, QSet<QString> &inclusions);
@@ -134,7 +423,7 @@ private:
         Tok_Other
     };
 
-    std::ostream &yyMsg(int line = 0);
+    std::ostream &yyMsg(int line = 0, Namespace *once = 0);
 
     int getChar();
     TokenType lookAheadToSemicolonOrLeftBrace();
@@ -176,6 +465,8 @@ private:
                         VisitNamespaceCallback callback, void *context) const;
     bool qualifyOneCallbackOwn(const Namespace *ns, void *context) const;
     bool qualifyOneCallbackUsing(const Namespace *ns, void *context) const;
+    bool resolveAlias(ParseOverlay *overlay, const Namespace *ns, const NamespaceList &nsl,
+                      QualifyOneData *data) const;
     bool qualifyOne(const NamespaceList &namespaces, int nsCnt, const HashString &segment,
                     NamespaceList *resolved, QSet<HashStringList> *visitedUsings) const;
     bool qualifyOne(const NamespaceList &namespaces, int nsCnt, const HashString &segment,
@@ -265,9 +556,15 @@ CppParser::CppParser(ParseResults *_results)
 }
 
 
-std::ostream &CppParser::yyMsg(int line)
+/*
+  \a once is the class a warning about missing tr() functions is
+  given for. It is printed only if no other file complained about
+  the class before, which is known only when the file's turn comes.
+*/
+std::ostream &CppParser::yyMsg(int line, Namespace *once)
 {
-    return std::cerr << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
+    return WarningRecorder::stream(ParseOverlay::current() ? once : 0)
+            << qPrintable(yyFileName) << ':' << (line ? line : yyLineNo) << ": ";
 }
 
 void CppParser::setInput(const QString &in)
@@ -284,6 +581,13 @@ void CppParser::setInput(QTextStream &ts, const QString &fileName)
     yySourceCodec = ts.codec();
 }
 
+void CppParser::setInput(const QString &in, QTextCodec *codec, const QString &fileName)
+{
+    yyInStr = in;
+    yyFileName = fileName;
+    yySourceCodec = codec;
+}
+
 /*
   The first part of this source file is the C++ tokenizer.  We skip
   most of C++; the only tokens that interest us are defined here.
@@ -1029,6 +1333,8 @@ bool CppParser::qualifyOneCallbackOwn(const Namespace *ns, void *context) const
     if (nsai != ns->aliases.constEnd()) {
         const NamespaceList &nsl = *nsai;
         if (nsl.last().value().isEmpty()) { // Delayed alias resolution
+            if (ParseOverlay * const overlay = ParseOverlay::current())
+                return resolveAlias(overlay, ns, nsl, data);
             NamespaceList &nslIn = *const_cast<NamespaceList *>(&nsl);
             nslIn.removeLast();
             NamespaceList nslOut;
@@ -1044,6 +1350,42 @@ bool CppParser::qualifyOneCallbackOwn(const Namespace *ns, void *context) const
     return false;
 }
 
+/*
+  Resolves the alias \a nsl the way qualifyOneCallbackOwn() does
+  without an overlay, but keeps the resolution in \a overlay: the
+  namespace may belong to results that other parses read meanwhile.
+  Resolutions of other files are not used, as a serial parse might
+  have found the alias unresolved.
+*/
+bool CppParser::resolveAlias(ParseOverlay *overlay, const Namespace *ns, const NamespaceList &nsl,
+                             QualifyOneData *data) const
+{
+    Namespace * const mns = const_cast<Namespace *>(ns);
+    auto rit = overlay->resolvedAliases.constFind(mns);
+    if (rit != overlay->resolvedAliases.constEnd()) {
+        auto ait = rit->constFind(data->segment);
+        if (ait != rit->constEnd()) {
+            if (ait->isEmpty())
+                return false;
+            *data->resolved = *ait;
+            return true;
+        }
+    }
+
+    NamespaceList nslIn = nsl;
+    nslIn.removeLast();
+    // Looked up while it is resolved, the alias stands for itself.
+    overlay->resolvedAliases[mns].insert(data->segment, nslIn);
+    NamespaceList nslOut;
+    if (!fullyQualify(data->namespaces, data->nsCount, nslIn, false, &nslOut, 0)) {
+        overlay->resolvedAliases[mns].insert(data->segment, NamespaceList());
+        return false;
+    }
+    overlay->resolvedAliases[mns].insert(data->segment, nslOut);
+    *data->resolved = nslOut;
+    return true;
+}
+
 bool CppParser::qualifyOneCallbackUsing(const Namespace *ns, void *context) const
 {
     QualifyOneData *data = (QualifyOneData *)context;
@@ -1190,9 +1532,29 @@ QSet<QString> &CppFiles::blacklistedFiles()
     return blacklisted;
 }
 
+DependencyHash &CppFiles::dependencies()
+{
+    static DependencyHash deps;
+
+    return deps;
+}
+
+/*
+  While a parse uses an overlay, the functions below see the changes
+  in it and in the overlays below it, and make their changes to it.
+*/
+IncludeCycle *CppFiles::includeCycle(const QString &cleanFile)
+{
+    for (const ParseOverlay *overlay = ParseOverlay::current(); overlay; overlay = overlay->base) {
+        if (IncludeCycle * const cycle = overlay->includeCycles.value(cleanFile))
+            return cycle;
+    }
+    return includeCycles().value(cleanFile);
+}
+
 QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
 {
-    IncludeCycle * const cycle = includeCycles().value(cleanFile);
+    IncludeCycle * const cycle = includeCycle(cleanFile);
 
     if (cycle)
         return cycle->results;
@@ -1202,11 +1564,20 @@ QSet<const ParseResults *> CppFiles::getResults(const QString &cleanFile)
 
 void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 {
-    IncludeCycle *cycle = includeCycles().value(cleanFile);
+    ParseOverlay * const overlay = ParseOverlay::current();
+    IncludeCycleHash &cycles = overlay ? overlay->includeCycles : includeCycles();
+    IncludeCycle *cycle = cycles.value(cleanFile);
 
     if (!cycle) {
-        cycle = new IncludeCycle;
-        includeCycles().insert(cleanFile, cycle);
+        if (overlay && (cycle = includeCycle(cleanFile))) {
+            overlay->conflict = true;
+            cycle = new IncludeCycle(*cycle);
+            foreach (const QString &fileName, cycle->fileNames)
+                cycles.insert(fileName, cycle);
+        } else {
+            cycle = new IncludeCycle;
+            cycles.insert(cleanFile, cycle);
+        }
     }
 
     cycle->fileNames.insert(cleanFile);
@@ -1215,44 +1586,252 @@ void CppFiles::setResults(const QString &cleanFile, const ParseResults *results)
 
 const Translator *CppFiles::getTranslator(const QString &cleanFile)
 {
+    for (const ParseOverlay *overlay = ParseOverlay::current(); overlay; overlay = overlay->base) {
+        if (const Translator *tor = overlay->translatedFiles.value(cleanFile))
+            return tor;
+    }
     return translatedFiles().value(cleanFile);
 }
 
 void CppFiles::setTranslator(const QString &cleanFile, const Translator *tor)
 {
-    translatedFiles().insert(cleanFile, tor);
+    if (ParseOverlay * const overlay = ParseOverlay::current())
+        overlay->translatedFiles.insert(cleanFile, tor);
+    else
+        translatedFiles().insert(cleanFile, tor);
 }
 
 bool CppFiles::isBlacklisted(const QString &cleanFile)
 {
+    for (const ParseOverlay *overlay = ParseOverlay::current(); overlay; overlay = overlay->base) {
+        if (overlay->blacklistedFiles.contains(cleanFile))
+            return true;
+    }
     return blacklistedFiles().contains(cleanFile);
 }
 
 void CppFiles::setBlacklisted(const QString &cleanFile)
 {
-    blacklistedFiles().insert(cleanFile);
+    if (ParseOverlay * const overlay = ParseOverlay::current())
+        overlay->blacklistedFiles.insert(cleanFile);
+    else
+        blacklistedFiles().insert(cleanFile);
+}
+
+QSet<QString> CppFiles::blacklisted()
+{
+    QSet<QString> fileNames = blacklistedFiles();
+    for (const ParseOverlay *overlay = ParseOverlay::current(); overlay; overlay = overlay->base)
+        fileNames.unite(overlay->blacklistedFiles);
+    return fileNames;
+}
+
+/*
+  Returns the files that were read to parse \a cleanFile stand-alone,
+  including the file itself and the other files of its include cycle,
+  if any.
+*/
+QSet<QString> CppFiles::getDependencies(const QString &cleanFile)
+{
+    auto dependenciesOf = [](const QString &fileName) {
+        for (const ParseOverlay *overlay = ParseOverlay::current(); overlay; overlay = overlay->base) {
+            auto it = overlay->dependencies.constFind(fileName);
+            if (it != overlay->dependencies.constEnd())
+                return *it;
+        }
+        return dependencies().value(fileName);
+    };
+
+    const IncludeCycle * const cycle = includeCycle(cleanFile);
+    if (!cycle)
+        return dependenciesOf(cleanFile) << cleanFile;
+
+    QSet<QString> fileNames = cycle->fileNames;
+    foreach (const QString &fileName, cycle->fileNames)
+        fileNames.unite(dependenciesOf(fileName));
+    return fileNames;
+}
+
+void CppFiles::setDependencies(const QString &cleanFile, const QSet<QString> &fileNames)
+{
+    if (ParseOverlay * const overlay = ParseOverlay::current())
+        overlay->dependencies.insert(cleanFile, fileNames);
+    else
+        dependencies().insert(cleanFile, fileNames);
 }
 
 void CppFiles::addIncludeCycle(const QSet<QString> &fileNames)
 {
+    ParseOverlay * const overlay = ParseOverlay::current();
+    IncludeCycleHash &cycles = overlay ? overlay->includeCycles : includeCycles();
+    if (overlay)
+        overlay->conflict = true;
+
     IncludeCycle * const cycle = new IncludeCycle;
     cycle->fileNames = fileNames;
 
     QSet<IncludeCycle *> intersectingCycles;
+    QSet<IncludeCycle *> ownCycles;
     foreach (const QString &fileName, fileNames) {
-        IncludeCycle *intersectingCycle = includeCycles().value(fileName);
+        IncludeCycle *intersectingCycle = includeCycle(fileName);
 
         if (intersectingCycle && !intersectingCycles.contains(intersectingCycle)) {
             intersectingCycles.insert(intersectingCycle);
+            // Cycles below the overlay stay as they are.
+            if (cycles.value(fileName) == intersectingCycle)
+                ownCycles.insert(intersectingCycle);
 
             cycle->fileNames.unite(intersectingCycle->fileNames);
             cycle->results.unite(intersectingCycle->results);
         }
     }
-    qDeleteAll(intersectingCycles);
+    qDeleteAll(ownCycles);
 
     foreach (const QString &fileName, cycle->fileNames)
-        includeCycles().insert(fileName, cycle);
+        cycles.insert(fileName, cycle);
+}
+
+/*
+  Reading and decoding the sources is independent of the parse, so
+  while the parser works through the listed headers one after
+  another, a pool of threads reads the next ones.
+*/
+
+struct SourceText {
+    SourceText() : requestedCodec(0), codec(0), ok(false), done(false) {}
+    QString text;
+    QTextCodec *requestedCodec;
+    QTextCodec *codec; // the codec actually used, after detecting a BOM
+    QString error;
+    bool ok;
+    bool done;
+};
+
+class SourcePrefetcher {
+public:
+    SourcePrefetcher(const QStringList &fileNames, QTextCodec *codec);
+    ~SourcePrefetcher();
+
+    void advance(int index);
+    void discard(const QString &fileName);
+    static SourceText read(const QString &fileName, QTextCodec *codec);
+
+private:
+    SourceText take(const QString &fileName, QTextCodec *codec);
+    static SourceText load(const QString &fileName, QTextCodec *codec);
+
+    QStringList m_fileNames;
+    QTextCodec *m_codec;
+    int m_scheduled;
+    int m_window;
+    QMutex m_mutex;
+    QWaitCondition m_ready;
+    QHash<QString, SourceText> m_sources;
+    QThreadPool m_pool;
+
+    static SourcePrefetcher *s_current;
+};
+
+SourcePrefetcher *SourcePrefetcher::s_current = 0;
+
+SourcePrefetcher::SourcePrefetcher(const QStringList &fileNames, QTextCodec *codec)
+    : m_fileNames(fileNames), m_codec(codec), m_scheduled(0)
+{
+    m_window = 4 * qMax(1, m_pool.maxThreadCount());
+    s_current = this;
+}
+
+SourcePrefetcher::~SourcePrefetcher()
+{
+    s_current = 0;
+    m_pool.waitForDone();
+}
+
+/*
+  Starts reading the files that follow the file at \a index, up to
+  a few per thread, so the texts waiting for the parser stay few.
+  Files that were already parsed as includes are not read again.
+*/
+void SourcePrefetcher::advance(int index)
+{
+    const int end = qMin(index + 1 + m_window, m_fileNames.count());
+    for (; m_scheduled < end; ++m_scheduled) {
+        const QString fileName = m_fileNames.at(m_scheduled);
+        if (!CppFiles::getResults(fileName).isEmpty() || CppFiles::isBlacklisted(fileName))
+            continue;
+        QMutexLocker locker(&m_mutex);
+        if (m_sources.contains(fileName))
+            continue;
+        m_sources.insert(fileName, SourceText());
+        locker.unlock();
+        QTextCodec *codec = m_codec;
+        m_pool.start([this, fileName, codec]() {
+            SourceText source = load(fileName, codec);
+            source.done = true;
+            QMutexLocker locker(&m_mutex);
+            m_sources[fileName] = source;
+            m_ready.wakeAll();
+        });
+    }
+}
+
+/*
+  Drops the text of \a fileName if it was read ahead, because the
+  file does not need to be parsed after all.
+*/
+void SourcePrefetcher::discard(const QString &fileName)
+{
+    take(fileName, m_codec);
+}
+
+/*
+  Returns the text of \a fileName, decoded with \a codec, and waits
+  for it if it is being read ahead. A text that was read ahead with
+  another codec is read again.
+*/
+SourceText SourcePrefetcher::take(const QString &fileName, QTextCodec *codec)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_sources.contains(fileName))
+        return SourceText();
+    while (!m_sources.value(fileName).done)
+        m_ready.wait(&m_mutex);
+    SourceText source = m_sources.take(fileName);
+    if (source.requestedCodec != codec)
+        return SourceText();
+    return source;
+}
+
+/*
+  Returns the text of \a fileName decoded with \a codec, taking it
+  from the current prefetcher if the file was read ahead.
+*/
+SourceText SourcePrefetcher::read(const QString &fileName, QTextCodec *codec)
+{
+    if (s_current) {
+        SourceText source = s_current->take(fileName, codec);
+        if (source.done)
+            return source;
+    }
+    return load(fileName, codec);
+}
+
+SourceText SourcePrefetcher::load(const QString &fileName, QTextCodec *codec)
+{
+    SourceText source;
+    source.requestedCodec = codec;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        source.error = file.errorString();
+        return source;
+    }
+    QTextStream ts(&file);
+    ts.setCodec(codec);
+    ts.setAutoDetectUnicode(true);
+    source.text = ts.readAll();
+    source.codec = ts.codec();
+    source.ok = true;
+    return source;
 }
 
 static bool isHeader(const QString &name)
@@ -1261,6 +1840,326 @@ static bool isHeader(const QString &name)
     return fileExt.isEmpty() || fileExt.startsWith(QLatin1Char('h'), Qt::CaseInsensitive);
 }
 
+/*
+  Collects the names of the files read while a file is parsed. A
+  recorder started inside another one passes its files on to it,
+  so the files read for a header that is parsed stand-alone count
+  for the file that includes it, too.
+*/
+class DependencyRecorder {
+public:
+    explicit DependencyRecorder(bool start = false);
+    ~DependencyRecorder();
+
+    bool isRecording() const { return m_recording; }
+    const QSet<QString> &fileNames() const { return m_fileNames; }
+
+    static void record(const QString &fileName);
+    static void record(const QSet<QString> &fileNames);
+
+private:
+    bool m_recording;
+    DependencyRecorder *m_parent;
+    QSet<QString> m_fileNames;
+
+    static thread_local DependencyRecorder *s_current;
+};
+
+thread_local DependencyRecorder *DependencyRecorder::s_current = 0;
+
+DependencyRecorder::DependencyRecorder(bool start)
+    : m_recording(start || s_current), m_parent(s_current)
+{
+    if (m_recording)
+        s_current = this;
+}
+
+DependencyRecorder::~DependencyRecorder()
+{
+    if (!m_recording)
+        return;
+    s_current = m_parent;
+    if (m_parent)
+        m_parent->m_fileNames.unite(m_fileNames);
+}
+
+void DependencyRecorder::record(const QString &fileName)
+{
+    if (s_current)
+        s_current->m_fileNames.insert(fileName);
+}
+
+void DependencyRecorder::record(const QSet<QString> &fileNames)
+{
+    if (s_current)
+        s_current->m_fileNames.unite(fileNames);
+}
+
+/*
+  The messages extracted from the source files that are not headers
+  are kept in the file given with -cache, so that the next run does
+  not need to parse the files that did not change.
+
+  An entry is used only if none of the files read for its parse has
+  changed, and if each of them is blacklisted exactly when it was
+  blacklisted back then, because that decides whether a header's
+  messages end up in the file that includes it. The headers that the
+  parse blacklisted are blacklisted again, so the files that follow
+  are parsed as before. Headers are always parsed, as their results
+  are needed by the files that include them.
+
+  Entries are not used either if the codec, the tr() function aliases,
+  the include path or the excluded files differ, which may happen when
+  several projects share the cache. The warnings printed for a file
+  are kept with its messages and printed again when its entry is used.
+*/
+class ExtractionCache {
+public:
+    ExtractionCache(ConversionData &cd, QTextCodec *codec);
+    ~ExtractionCache();
+
+    bool isEnabled() const { return !m_fileName.isEmpty(); }
+    bool isUpToDate(const QString &fileName);
+    bool restore(const QString &fileName);
+    void store(const QString &fileName, const QSet<QString> &dependencies,
+               const QSet<QString> &blacklistedBefore, const Translator *tor,
+               const QByteArrayList &warnings);
+
+private:
+    struct Dependency {
+        QString fileName;
+        QByteArray digest;
+        bool blacklisted;
+    };
+
+    struct Entry {
+        QByteArray configuration;
+        QVector<Dependency> dependencies;
+        QStringList blacklisted;
+        QList<TranslatorMessage> messages;
+        QByteArrayList warnings;
+    };
+
+    enum { Magic = 0x4c555843, Version = 2 };
+
+    QByteArray digest(const QString &fileName);
+    void load();
+    void save();
+
+    ConversionData &m_cd;
+    QString m_fileName;
+    QByteArray m_configuration;
+    QHash<QString, Entry> m_entries;
+    QHash<QString, QByteArray> m_digests;
+    bool m_modified;
+};
+
+ExtractionCache::ExtractionCache(ConversionData &cd, QTextCodec *codec)
+    : m_cd(cd), m_fileName(cd.m_cacheFile), m_modified(false)
+{
+    if (!isEnabled())
+        return;
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(codec->name());
+    foreach (const QString &alias, trFunctionAliasManager.availableFunctionsWithAliases())
+        hash.addData(alias.toUtf8());
+    foreach (const QString &path, cd.m_includePath)
+        hash.addData(path.toUtf8() + '\n');
+    foreach (const QString &ex, cd.m_excludes)
+        hash.addData(ex.toUtf8() + '\n');
+    QStringList cSources;
+    for (auto it = cd.m_allCSources.cbegin(), end = cd.m_allCSources.cend(); it != end; ++it)
+        cSources << it.key() + QLatin1Char('=') + it.value();
+    cSources.sort();
+    foreach (const QString &cSource, cSources)
+        hash.addData(cSource.toUtf8() + '\n');
+    m_configuration = hash.result();
+
+    load();
+}
+
+ExtractionCache::~ExtractionCache()
+{
+    if (m_modified)
+        save();
+}
+
+QByteArray ExtractionCache::digest(const QString &fileName)
+{
+    auto it = m_digests.find(fileName);
+    if (it == m_digests.end()) {
+        QByteArray result;
+        QFile file(fileName);
+        if (file.open(QIODevice::ReadOnly)) {
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(&file);
+            result = hash.result();
+        }
+        it = m_digests.insert(fileName, result);
+    }
+    return *it;
+}
+
+/*
+  Returns true if the cache entry of \a fileName can be used now.
+*/
+bool ExtractionCache::isUpToDate(const QString &fileName)
+{
+    if (!isEnabled() || isHeader(fileName))
+        return false;
+    auto it = m_entries.constFind(fileName);
+    if (it == m_entries.constEnd())
+        return false;
+
+    const Entry &entry = *it;
+    if (entry.configuration != m_configuration)
+        return false;
+    foreach (const Dependency &dep, entry.dependencies) {
+        if (CppFiles::isBlacklisted(dep.fileName) != dep.blacklisted)
+            return false;
+        const QByteArray d = digest(dep.fileName);
+        if (d.isEmpty() || d != dep.digest)
+            return false;
+    }
+    return true;
+}
+
+/*
+  Sets up the results of parsing \a fileName from its cache entry and
+  returns true, or returns false if the file needs to be parsed.
+*/
+bool ExtractionCache::restore(const QString &fileName)
+{
+    if (!isUpToDate(fileName))
+        return false;
+
+    const Entry &entry = *m_entries.constFind(fileName);
+    foreach (const QString &blacklisted, entry.blacklisted)
+        CppFiles::setBlacklisted(blacklisted);
+    if (!entry.messages.isEmpty()) {
+        Translator *tor = new Translator;
+        foreach (const TranslatorMessage &msg, entry.messages)
+            tor->append(msg);
+        CppFiles::setTranslator(fileName, tor);
+    }
+    foreach (const QByteArray &warning, entry.warnings)
+        std::cerr << warning.constData();
+    return true;
+}
+
+/*
+  Keeps the messages found in \a fileName and the warnings printed
+  for it, given the files read to parse it and the files that were
+  blacklisted before the parse.
+*/
+void ExtractionCache::store(const QString &fileName, const QSet<QString> &dependencies,
+                            const QSet<QString> &blacklistedBefore, const Translator *tor,
+                            const QByteArrayList &warnings)
+{
+    if (!isEnabled() || isHeader(fileName))
+        return;
+
+    Entry entry;
+    entry.configuration = m_configuration;
+    foreach (const QString &dependency, dependencies) {
+        Dependency dep;
+        dep.fileName = dependency;
+        dep.digest = digest(dependency);
+        if (dep.digest.isEmpty()) {
+            // Will not validate anyway.
+            m_modified |= m_entries.remove(fileName) != 0;
+            return;
+        }
+        dep.blacklisted = blacklistedBefore.contains(dependency);
+        if (!dep.blacklisted && CppFiles::isBlacklisted(dependency))
+            entry.blacklisted << dependency;
+        entry.dependencies << dep;
+    }
+    if (tor)
+        entry.messages = tor->messages();
+    entry.warnings = warnings;
+    m_entries.insert(fileName, entry);
+    m_modified = true;
+}
+
+void ExtractionCache::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != Magic || version != Version)
+        return;
+
+    qint32 entryCount;
+    in >> entryCount;
+    for (int i = 0; i < entryCount && in.status() == QDataStream::Ok; ++i) {
+        QString fileName;
+        Entry entry;
+        qint32 count;
+        in >> fileName >> entry.configuration >> count;
+        for (int j = 0; j < count && in.status() == QDataStream::Ok; ++j) {
+            Dependency dep;
+            in >> dep.fileName >> dep.digest >> dep.blacklisted;
+            entry.dependencies << dep;
+        }
+        in >> entry.blacklisted >> count;
+        for (int j = 0; j < count && in.status() == QDataStream::Ok; ++j) {
+            QString context, sourceText, comment, id, extraComment, msgFileName;
+            qint32 lineNumber, type;
+            TranslatorMessage::ExtraData extras;
+            bool plural;
+            in >> context >> sourceText >> comment >> id >> extraComment >> msgFileName
+               >> lineNumber >> extras >> type >> plural;
+            TranslatorMessage msg(context, sourceText, comment, QString(), msgFileName,
+                                  lineNumber, QStringList(),
+                                  TranslatorMessage::Type(type), plural);
+            msg.setId(id);
+            msg.setExtraComment(extraComment);
+            msg.setExtras(extras);
+            entry.messages << msg;
+        }
+        in >> entry.warnings;
+        if (in.status() == QDataStream::Ok)
+            m_entries.insert(fileName, entry);
+    }
+    if (in.status() != QDataStream::Ok)
+        m_entries.clear();
+}
+
+void ExtractionCache::save()
+{
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_cd.appendError(LU::tr("Cannot write cache file %1: %2").arg(m_fileName, file.errorString()));
+        return;
+    }
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_0);
+    out << quint32(Magic) << quint32(Version) << qint32(m_entries.count());
+    for (auto it = m_entries.cbegin(), end = m_entries.cend(); it != end; ++it) {
+        const Entry &entry = *it;
+        out << it.key() << entry.configuration << qint32(entry.dependencies.count());
+        foreach (const Dependency &dep, entry.dependencies)
+            out << dep.fileName << dep.digest << dep.blacklisted;
+        out << entry.blacklisted << qint32(entry.messages.count());
+        foreach (const TranslatorMessage &msg, entry.messages) {
+            out << msg.context() << msg.sourceText() << msg.comment() << msg.id()
+                << msg.extraComment() << msg.fileName() << qint32(msg.lineNumber())
+                << msg.extras() << qint32(msg.type()) << msg.isPlural();
+        }
+        out << entry.warnings;
+    }
+    if (!file.commit())
+        m_cd.appendError(LU::tr("Cannot write cache file %1: %2").arg(m_fileName, file.errorString()));
+}
+
 void CppParser::processInclude(const QString &file, ConversionData &cd, const QStringList &includeStack,
                                QSet<QString> &inclusions)
 {
@@ -1291,41 +2190,42 @@ void CppParser::processInclude(const QString &file, ConversionData &cd, const QS
         QSet<const ParseResults *> res = CppFiles::getResults(cleanFile);
         if (!res.isEmpty()) {
             results->includes.unite(res);
+            DependencyRecorder::record(CppFiles::getDependencies(cleanFile));
             return;
         }
 
         isIndirect = true;
     }
 
-    QFile f(cleanFile);
-    if (!f.open(QIODevice::ReadOnly)) {
-        yyMsg() << qPrintable(LU::tr("Cannot open %1: %2\n").arg(cleanFile, f.errorString()));
+    DependencyRecorder::record(cleanFile);
+    SourceText source = SourcePrefetcher::read(cleanFile, yySourceCodec);
+    if (!source.ok) {
+        yyMsg() << qPrintable(LU::tr("Cannot open %1: %2\n").arg(cleanFile, source.error));
         return;
     }
 
-    QTextStream ts(&f);
-    ts.setCodec(yySourceCodec);
-    ts.setAutoDetectUnicode(true);
-
     inclusions.insert(cleanFile);
     if (isIndirect) {
+        DependencyRecorder recorder;
         CppParser parser;
         foreach (const QString &projectRoot, cd.m_projectRoots)
             if (cleanFile.startsWith(projectRoot)) {
                 parser.setTranslator(new Translator);
                 break;
             }
-        parser.setInput(ts, cleanFile);
+        parser.setInput(source.text, source.codec, cleanFile);
         QStringList stack = includeStack;
         stack << cleanFile;
         parser.parse(cd, stack, inclusions);
         results->includes.insert(parser.recordResults(true));
+        if (recorder.isRecording())
+            CppFiles::setDependencies(cleanFile, recorder.fileNames());
     } else {
         CppParser parser(results);
         parser.namespaces = namespaces;
         parser.functionContext = functionContext;
         parser.functionContextUnresolved = functionContextUnresolved;
-        parser.setInput(ts, cleanFile);
+        parser.setInput(source.text, source.codec, cleanFile);
         parser.setTranslator(tor);
         QStringList stack = includeStack;
         stack << cleanFile;
@@ -1499,16 +2399,17 @@ void CppParser::handleTr(QString &prefix, bool plural)
                     if (idx == 1) {
                         context = stringifyNamespace(functionContext);
                         fctx = findNamespace(functionContext)->classDef;
-                        if (!fctx->complained) {
-                            yyMsg() << qPrintable(LU::tr("Class '%1' lacks Q_OBJECT macro\n")
-                                                 .arg(context));
-                            fctx->complained = true;
+                        if (!hasComplained(fctx)) {
+                            yyMsg(0, fctx) << qPrintable(LU::tr("Class '%1' lacks Q_OBJECT macro\n")
+                                                        .arg(context));
+                            setComplained(fctx);
                         }
                         goto gotctx;
                     }
                     --idx;
                 }
-                if (fctx->trQualification.isEmpty()) {
+                const QString qualification = trQualification(fctx);
+                if (qualification.isEmpty()) {
                     context.clear();
                     for (int i = 1;;) {
                         context += functionContext.at(i).value();
@@ -1516,9 +2417,9 @@ void CppParser::handleTr(QString &prefix, bool plural)
                             break;
                         context += QLatin1String("::");
                     }
-                    fctx->trQualification = context;
+                    setTrQualification(fctx, context);
                 } else {
-                    context = fctx->trQualification;
+                    context = qualification;
                 }
             } else {
                 context = joinNamespaces(stringifyNamespace(functionContext), functionContextUnresolved);
@@ -1537,15 +2438,16 @@ void CppParser::handleTr(QString &prefix, bool plural)
             NamespaceList unresolved;
             if (fullyQualify(functionContext, prefix, false, &nsl, &unresolved)) {
                 Namespace *fctx = findNamespace(nsl)->classDef;
-                if (fctx->trQualification.isEmpty()) {
+                const QString qualification = trQualification(fctx);
+                if (qualification.isEmpty()) {
                     context = stringifyNamespace(nsl);
-                    fctx->trQualification = context;
+                    setTrQualification(fctx, context);
                 } else {
-                    context = fctx->trQualification;
+                    context = qualification;
                 }
-                if (!fctx->hasTrFunctions && !fctx->complained) {
-                    yyMsg() << qPrintable(LU::tr("Class '%1' lacks Q_OBJECT macro\n").arg(context));
-                    fctx->complained = true;
+                if (!fctx->hasTrFunctions && !hasComplained(fctx)) {
+                    yyMsg(0, fctx) << qPrintable(LU::tr("Class '%1' lacks Q_OBJECT macro\n").arg(context));
+                    setComplained(fctx);
                 }
             } else {
                 context = joinNamespaces(stringifyNamespace(nsl), stringifyNamespace(0, unresolved));
@@ -2213,44 +3115,209 @@ const ParseResults *CppParser::recordResults(bool isHeader)
             && results->rootNamespace.usings.isEmpty()) {
             // This is a forwarding header. Slash it.
             pr = *results->includes.begin();
-            delete results;
+            discardResults(results);
         } else {
-            results->fileId = nextFileId++;
+            results->fileId = nextFileId.fetchAndAddRelaxed(1);
             pr = results;
         }
         CppFiles::setResults(yyFileName, pr);
         return pr;
     } else {
-        delete results;
+        discardResults(results);
         return 0;
     }
 }
 
+/*
+  The outcome of parsing one of the files given to loadCPP(): the
+  files that were read for it, those of them that were blacklisted
+  before, and the warnings.
+*/
+struct SourceParse {
+    QSet<QString> fileNames;
+    QSet<QString> blacklistedBefore;
+    QVector<WarningRecorder::Warning> warnings;
+    QString error;
+};
+
+static SourceParse parseSource(const QString &filename, QTextCodec *codec, ConversionData &cd)
+{
+    SourceParse result;
+    WarningRecorder warnings;
+    DependencyRecorder recorder(true);
+    DependencyRecorder::record(filename);
+    const QSet<QString> blacklisted = CppFiles::blacklisted();
+    const SourceText source = SourcePrefetcher::read(filename, codec);
+    if (!source.ok) {
+        result.error = LU::tr("Cannot open %1: %2").arg(filename, source.error);
+        return result;
+    }
+
+    CppParser parser;
+    parser.setInput(source.text, source.codec, filename);
+    Translator *tor = new Translator;
+    parser.setTranslator(tor);
+    QSet<QString> inclusions;
+    parser.parse(cd, QStringList(), inclusions);
+    parser.recordResults(isHeader(filename));
+    if (isHeader(filename))
+        CppFiles::setDependencies(filename, recorder.fileNames());
+
+    result.fileNames = recorder.fileNames();
+    foreach (const QString &fileName, result.fileNames) {
+        if (blacklisted.contains(fileName))
+            result.blacklistedBefore.insert(fileName);
+    }
+    result.warnings = warnings.takeWarnings();
+    return result;
+}
+
+/*
+  A file parsed ahead of its turn. Its parse is used if each of the
+  files it read is blacklisted exactly as it was for the parse when
+  the file's turn comes: only the blacklist decides whether a header
+  is scanned in place, and a header parsed stand-alone once more
+  yields the same results as it did for the file that parsed it first.
+  The tr() qualifications and aliases it read in shared namespaces
+  must also not have been set differently by the files in front of it.
+*/
+struct EarlyParse {
+    explicit EarlyParse(const ParseOverlay *base) : overlay(base), applied(false) {}
+
+    void run(const QString &filename, QTextCodec *codec, ConversionData &cd)
+    {
+        ParseOverlay::setCurrent(&overlay);
+        parse = parseSource(filename, codec, cd);
+        ParseOverlay::setCurrent(0);
+    }
+
+    bool isValid() const
+    {
+        if (overlay.conflict || !overlay.matchesNamespaces())
+            return false;
+        foreach (const QString &fileName, parse.fileNames) {
+            if (CppFiles::isBlacklisted(fileName) != parse.blacklistedBefore.contains(fileName))
+                return false;
+        }
+        return true;
+    }
+
+    ParseOverlay overlay;
+    SourceParse parse;
+    bool applied;
+};
+
+/*
+  The files are parsed as if one after another in the given order,
+  but the headers are parsed first, and the other files on a pool of
+  threads then. Each of them sees the results of all the headers, so
+  few headers are parsed more than once. The parses are then taken
+  over in the given order, and files whose parse would have been
+  different at their turn are parsed again. With one job, the files
+  are just parsed one after another.
+*/
 void loadCPP(Translator &translator, const QStringList &filenames, ConversionData &cd)
 {
     QTextCodec *codec = QTextCodec::codecForName(cd.m_sourceIsUtf16 ? "UTF-16" : "UTF-8");
 
-    foreach (const QString &filename, filenames) {
-        if (!CppFiles::getResults(filename).isEmpty() || CppFiles::isBlacklisted(filename))
-            continue;
+    ExtractionCache cache(cd, codec);
+    QVector<EarlyParse *> earlyParses(filenames.count());
+    QVector<int> sharedHeaders; // Those whose results the other files see
+    ParseOverlay headers;
+    if (cd.m_jobs != 1) {
+        QStringList headerNames;
+        foreach (const QString &filename, filenames) {
+            if (isHeader(filename))
+                headerNames << filename;
+        }
+        SourcePrefetcher prefetcher(headerNames, codec);
+        for (int i = 0, h = 0; i < filenames.count(); ++i) {
+            const QString &filename = filenames.at(i);
+            if (!isHeader(filename))
+                continue;
+            prefetcher.advance(h++);
+            ParseOverlay::setCurrent(&headers);
+            const bool skip = !CppFiles::getResults(filename).isEmpty()
+                    || CppFiles::isBlacklisted(filename);
+            ParseOverlay::setCurrent(0);
+            if (skip) {
+                prefetcher.discard(filename);
+                continue;
+            }
+            EarlyParse *early = new EarlyParse(&headers);
+            early->run(filename, codec, cd);
+            if (!early->overlay.conflict) {
+                headers.merge(early->overlay);
+                sharedHeaders << i;
+            }
+            earlyParses[i] = early;
+        }
+    }
+
+    if (cd.m_jobs != 1) {
+        trFunctionAliasManager.ensureTrFunctionHashUpdated();
+        ParseOverlay::setCurrent(&headers);
+        QThreadPool pool;
+        if (cd.m_jobs > 1)
+            pool.setMaxThreadCount(cd.m_jobs);
+        for (int i = 0; i < filenames.count(); ++i) {
+            const QString &filename = filenames.at(i);
+            if (isHeader(filename) || !CppFiles::getResults(filename).isEmpty()
+                || CppFiles::isBlacklisted(filename) || cache.isUpToDate(filename)) {
+                continue;
+            }
+            EarlyParse *early = new EarlyParse(&headers);
+            pool.start([early, filename, codec, &cd]() { early->run(filename, codec, cd); });
+            earlyParses[i] = early;
+        }
+        pool.waitForDone();
+        ParseOverlay::setCurrent(0);
+    }
 
-        QFile file(filename);
-        if (!file.open(QIODevice::ReadOnly)) {
-            cd.appendError(LU::tr("Cannot open %1: %2").arg(filename, file.errorString()));
+    // A serial parse would have parsed the shared headers a file read
+    // at the file's turn, so that is when their results become real.
+    auto takeOverHeaders = [&](int file, const QSet<QString> &fileNames) {
+        foreach (int i, sharedHeaders) {
+            EarlyParse *header = earlyParses.at(i);
+            if (i == file || header->applied || !fileNames.contains(filenames.at(i)))
+                continue;
+            if (!CppFiles::getResults(filenames.at(i)).isEmpty() || !header->isValid())
+                return false;
+            WarningRecorder::print(header->parse.warnings);
+            header->overlay.apply();
+            header->applied = true;
+        }
+        return true;
+    };
+
+    for (int i = 0; i < filenames.count(); ++i) {
+        const QString &filename = filenames.at(i);
+        if (!CppFiles::getResults(filename).isEmpty() || CppFiles::isBlacklisted(filename)
+            || cache.restore(filename)) {
             continue;
         }
 
-        CppParser parser;
-        QTextStream ts(&file);
-        ts.setCodec(codec);
-        ts.setAutoDetectUnicode(true);
-        parser.setInput(ts, filename);
-        Translator *tor = new Translator;
-        parser.setTranslator(tor);
-        QSet<QString> inclusions;
-        parser.parse(cd, QStringList(), inclusions);
-        parser.recordResults(isHeader(filename));
+        SourceParse parse;
+        QByteArrayList warnings;
+        EarlyParse *early = earlyParses.at(i);
+        if (early && takeOverHeaders(i, early->parse.fileNames) && early->isValid()) {
+            parse = early->parse;
+            // Before the overlay marks its classes as complained about.
+            warnings = WarningRecorder::print(parse.warnings);
+            early->overlay.apply();
+            early->applied = true;
+        } else {
+            parse = parseSource(filename, codec, cd);
+            warnings = WarningRecorder::print(parse.warnings);
+        }
+        if (!parse.error.isEmpty()) {
+            cd.appendError(parse.error);
+            continue;
+        }
+        cache.store(filename, parse.fileNames, parse.blacklistedBefore,
+                    CppFiles::getTranslator(filename), warnings);
     }
+    qDeleteAll(earlyParses);
 
     foreach (const QString &filename, filenames) {
         if (!CppFiles::isBlacklisted(filename)) {
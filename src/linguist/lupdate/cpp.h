@@ -31,6 +31,7 @@
 
 #include "lupdate.h"
 
+#include <QtCore/QAtomicInteger>
 #include <QtCore/QSet>
 
 #include <iostream>
@@ -40,12 +41,14 @@ QT_BEGIN_NAMESPACE
 struct HashString {
     HashString() : m_hash(0x80000000) {}
     explicit HashString(const QString &str) : m_str(str), m_hash(0x80000000) {}
-    void setValue(const QString &str) { m_str = str; m_hash = 0x80000000; }
+    void setValue(const QString &str) { m_str = str; m_hash.storeRelaxed(0x80000000); }
     const QString &value() const { return m_str; }
     bool operator==(const HashString &other) const { return m_str == other.m_str; }
     QString m_str;
 
-    mutable uint m_hash; // We use the highest bit as a validity indicator (set => invalid)
+    // We use the highest bit as a validity indicator (set => invalid). Atomic, because
+    // the results of headers are looked up by several threads.
+    mutable QAtomicInteger<uint> m_hash;
 };
 
 struct HashStringList {
@@ -54,7 +57,7 @@ struct HashStringList {
     bool operator==(const HashStringList &other) const { return m_list == other.m_list; }
 
     QList<HashString> m_list;
-    mutable uint m_hash; // We use the highest bit as a validity indicator (set => invalid)
+    mutable QAtomicInteger<uint> m_hash; // See HashString::m_hash
 };
 
 typedef QList<HashString> NamespaceList;
@@ -104,9 +107,13 @@ struct IncludeCycle {
     QSet<const ParseResults *> results;
 };
 
+typedef QHash<QString, QSet<QString> > DependencyHash;
+
 typedef QHash<QString, IncludeCycle *> IncludeCycleHash;
 typedef QHash<QString, const Translator *> TranslatorHash;
 
+struct ParseOverlay;
+
 class CppFiles {
 
 public:
@@ -116,12 +123,19 @@ public:
     static void setTranslator(const QString &cleanFile, const Translator *results);
     static bool isBlacklisted(const QString &cleanFile);
     static void setBlacklisted(const QString &cleanFile);
+    static QSet<QString> blacklisted();
     static void addIncludeCycle(const QSet<QString> &fileNames);
+    static QSet<QString> getDependencies(const QString &cleanFile);
+    static void setDependencies(const QString &cleanFile, const QSet<QString> &fileNames);
 
 private:
+    friend struct ParseOverlay;
+
+    static IncludeCycle *includeCycle(const QString &cleanFile);
     static IncludeCycleHash &includeCycles();
     static TranslatorHash &translatedFiles();
     static QSet<QString> &blacklistedFiles();
+    static DependencyHash &dependencies();
 };
 
 QT_END_NAMESPACE
@@ -53,6 +53,8 @@
 bool useClangToParseCpp = false;
 QString commandLineCompileCommands; // for the path to the json file passed as a command line argument.
                                     // Has priority over what is in the .pro file and passed to the project.
+static QString cacheFile;
+static int jobs = 0;
 
 // Can't have an array of QStaticStringData<N> for different N, so
 // use QString, which requires constructor calls. Doesn't matter
@@ -245,6 +247,13 @@ static void printUsage()
         "           Do not recursively scan directories.\n"
         "    -recursive\n"
         "           Recursively scan directories (default).\n"
+        "    -cache <filename>\n"
+        "           Keep the messages found in C++ source files in the given file, and\n"
+        "           only parse the files that changed since it was written.\n"
+        "           Does not apply to -clang-parser.\n"
+        "    -jobs <n>\n"
+        "           Parse C++ source files on n threads. With 1, parse them one after\n"
+        "           another. Default is the number of cores.\n"
         "    -I <includepath> or -I<includepath>\n"
         "           Additional location to look for include files.\n"
         "           May be specified multiple times.\n"
@@ -604,6 +613,8 @@ private:
             cd.m_compileCommandsPath = prj.compileCommands;
         else
             cd.m_compileCommandsPath = commandLineCompileCommands;
+        cd.m_cacheFile = cacheFile;
+        cd.m_jobs = jobs;
 
         QStringList tsFiles;
         if (hasTranslations(prj)) {
@@ -838,6 +849,24 @@ int main(int argc, char **argv)
             proFiles += file;
             numFiles++;
             continue;
+        } else if (arg == QLatin1String("-cache")) {
+            ++i;
+            if (i == argc) {
+                printErr(LU::tr("The -cache option should be followed by a filename.\n"));
+                return 1;
+            }
+            cacheFile = QDir::cleanPath(QFileInfo(args[i]).absoluteFilePath());
+            continue;
+        } else if (arg == QLatin1String("-jobs")) {
+            ++i;
+            bool ok = false;
+            if (i != argc)
+                jobs = args[i].toInt(&ok);
+            if (!ok || jobs < 1) {
+                printErr(LU::tr("The -jobs option should be followed by a number of threads.\n"));
+                return 1;
+            }
+            continue;
         } else if (arg == QLatin1String("-pro-out")) {
             ++i;
             if (i == argc) {
@@ -1033,6 +1062,8 @@ int main(int argc, char **argv)
         cd.m_includePath = includePath;
         cd.m_allCSources = allCSources;
         cd.m_compileCommandsPath = commandLineCompileCommands;
+        cd.m_cacheFile = cacheFile;
+        cd.m_jobs = jobs;
         for (const QString &resource : qAsConst(resourceFiles))
             sourceFiles << getResources(resource);
         processSources(fetchedTor, sourceFiles, cd);
@@ -31,7 +31,11 @@
 
 #include <QtCore/QByteArray>
 #include <QtCore/QString>
+#include <QtCore/qalgorithms.h>
 #include <QtCore/QList>
+#include <QtCore/private/qsimd_p.h>
+
+#include <algorithm>
 
 
 QT_BEGIN_NAMESPACE
@@ -96,29 +100,6 @@ static const int indexOf[256] = {
     15, 12, 16, 17, 18, 19, 2,  10, 15, 7,  19, 2,  6,  7,  10, 0
 };
 
-/*
-  The entry bitCount[i] (for i between 0 and 255) is the number of bits used to
-  represent i in binary.
-*/
-static const int bitCount[256] = {
-    0,  1,  1,  2,  1,  2,  2,  3,  1,  2,  2,  3,  2,  3,  3,  4,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    1,  2,  2,  3,  2,  3,  3,  4,  2,  3,  3,  4,  3,  4,  4,  5,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    2,  3,  3,  4,  3,  4,  4,  5,  3,  4,  4,  5,  4,  5,  5,  6,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    3,  4,  4,  5,  4,  5,  5,  6,  4,  5,  5,  6,  5,  6,  6,  7,
-    4,  5,  5,  6,  5,  6,  6,  7,  5,  6,  6,  7,  6,  7,  7,  8
-};
-
 static inline void setCoOccurence(CoMatrix &m, char c, char d)
 {
     int k = indexOf[(uchar) c] + 20 * indexOf[(uchar) d];
@@ -130,7 +111,7 @@ CoMatrix::CoMatrix(const QString &str)
     QByteArray ba = str.toUtf8();
     const char *text = ba.constData();
     char c = '\0', d;
-    memset( b, 0, 52 );
+    memset( b, 0, 64 );
     /*
       The Knuth books are not in the office only for show; they help make
       loops 30% faster and 20% as readable.
@@ -144,28 +125,32 @@ CoMatrix::CoMatrix(const QString &str)
     }
 }
 
+/*
+  The bits of the matrix are counted a word at a time. The bits after the
+  first 400 are never set.
+*/
 static inline int worth(const CoMatrix &m)
 {
     int w = 0;
-    for (int i = 0; i < 50; i++)
-        w += bitCount[m.b[i]];
+    for (int i = 0; i < 16; ++i)
+        w += qPopulationCount(m.w[i]);
     return w;
 }
 
-static inline CoMatrix reunion(const CoMatrix &m, const CoMatrix &n)
+static inline int similarityScore(int common, int all, int delta)
 {
-    CoMatrix p;
-    for (int i = 0; i < 13; ++i)
-        p.w[i] = m.w[i] | n.w[i];
-    return p;
+    return ((common + 1) << 10) / (all + (delta << 1) + 1);
 }
 
-static inline CoMatrix intersection(const CoMatrix &m, const CoMatrix &n)
+/*
+  Returns whether two texts whose matrices have \a worth1 and \a worth2
+  bits set and whose lengths differ by \a delta can reach \a threshold.
+  The score is highest when all the bits of the smaller matrix are set
+  in the larger one, too.
+*/
+static inline bool canReach(int worth1, int worth2, int delta, int threshold)
 {
-    CoMatrix p;
-    for (int i = 0; i < 13; ++i)
-        p.w[i] = m.w[i] & n.w[i];
-    return p;
+    return similarityScore(qMin(worth1, worth2), qMax(worth1, worth2), delta) >= threshold;
 }
 
 StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
@@ -176,13 +161,224 @@ StringSimilarityMatcher::StringSimilarityMatcher(const QString &stringToMatch)
 
 int StringSimilarityMatcher::getSimilarityScore(const QString &strCandidate)
 {
-    CoMatrix cmTarget(strCandidate);
-    int delta = qAbs(m_length - strCandidate.size());
-    int score = ( (worth(intersection(m_cm, cmTarget)) + 1) << 10 ) /
-        ( worth(reunion(m_cm, cmTarget)) + (delta << 1) + 1 );
+    const CoMatrix cmTarget(strCandidate);
+    const int length = strCandidate.size();
+    int score;
+    getSimilarityScores(&cmTarget, &length, 1, &score);
     return score;
 }
 
+/*
+  The scoring kernels count the bits set in both matrices and in either
+  of them in the same pass over the words, without building the
+  intersection and union matrices.
+*/
+#ifndef __SSE2__
+static void scoresScalar(const CoMatrix &query, int length, const CoMatrix *candidates,
+                         const int *lengths, int count, int *scores)
+{
+    const quint32 * const q = query.w;
+    for (int j = 0; j < count; ++j) {
+        const quint32 * const c = candidates[j].w;
+        int common = 0;
+        int all = 0;
+        for (int i = 0; i < 16; ++i) {
+            common += qPopulationCount(q[i] & c[i]);
+            all += qPopulationCount(q[i] | c[i]);
+        }
+        scores[j] = similarityScore(common, all, qAbs(length - lengths[j]));
+    }
+}
+#else
+// SSE2 has no population count, so the bits are added up within each byte.
+static inline __m128i popCountBytesSse2(__m128i v)
+{
+    const __m128i m1 = _mm_set1_epi8(0x55);
+    const __m128i m2 = _mm_set1_epi8(0x33);
+    const __m128i m4 = _mm_set1_epi8(0x0f);
+    v = _mm_sub_epi8(v, _mm_and_si128(_mm_srli_epi16(v, 1), m1));
+    v = _mm_add_epi8(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi16(v, 2), m2));
+    return _mm_and_si128(_mm_add_epi8(v, _mm_srli_epi16(v, 4)), m4);
+}
+
+static inline int sumBytesSse2(__m128i v)
+{
+    const __m128i sums = _mm_sad_epu8(v, _mm_setzero_si128());
+    return _mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+}
+
+static void scoresSse2(const CoMatrix &query, int length, const CoMatrix *candidates,
+                       const int *lengths, int count, int *scores)
+{
+    __m128i q[4];
+    for (int i = 0; i < 4; ++i)
+        q[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(query.w) + i);
+    for (int j = 0; j < count; ++j) {
+        const __m128i *c = reinterpret_cast<const __m128i *>(candidates[j].w);
+        __m128i common = _mm_setzero_si128();
+        __m128i all = _mm_setzero_si128();
+        for (int i = 0; i < 4; ++i) {
+            const __m128i v = _mm_loadu_si128(c + i);
+            common = _mm_add_epi8(common, popCountBytesSse2(_mm_and_si128(q[i], v)));
+            all = _mm_add_epi8(all, popCountBytesSse2(_mm_or_si128(q[i], v)));
+        }
+        scores[j] = similarityScore(sumBytesSse2(common), sumBytesSse2(all),
+                                    qAbs(length - lengths[j]));
+    }
+}
+#endif
+
+#if QT_COMPILER_SUPPORTS_HERE(POPCNT)
+QT_FUNCTION_TARGET(POPCNT)
+static void scoresPopcnt(const CoMatrix &query, int length, const CoMatrix *candidates,
+                         const int *lengths, int count, int *scores)
+{
+    const quint32 * const q = query.w;
+    for (int j = 0; j < count; ++j) {
+        const quint32 * const c = candidates[j].w;
+        int common = 0;
+        int all = 0;
+        for (int i = 0; i < 16; ++i) {
+            common += _mm_popcnt_u32(q[i] & c[i]);
+            all += _mm_popcnt_u32(q[i] | c[i]);
+        }
+        scores[j] = similarityScore(common, all, qAbs(length - lengths[j]));
+    }
+}
+#endif
+
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+// The bits of each half byte are counted through a table.
+QT_FUNCTION_TARGET(AVX2)
+static inline __m256i popCountBytesAvx2(__m256i v)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0f);
+    return _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+                           _mm256_shuffle_epi8(table,
+                                               _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+}
+
+QT_FUNCTION_TARGET(AVX2)
+static inline int sumBytesAvx2(__m256i v)
+{
+    const __m256i sums = _mm256_sad_epu8(v, _mm256_setzero_si256());
+    const __m128i halves = _mm_add_epi64(_mm256_castsi256_si128(sums),
+                                         _mm256_extracti128_si256(sums, 1));
+    return _mm_cvtsi128_si32(halves) + _mm_cvtsi128_si32(_mm_srli_si128(halves, 8));
+}
+
+QT_FUNCTION_TARGET(AVX2)
+static void scoresAvx2(const CoMatrix &query, int length, const CoMatrix *candidates,
+                       const int *lengths, int count, int *scores)
+{
+    const __m256i q0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(query.w));
+    const __m256i q1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(query.w) + 1);
+    for (int j = 0; j < count; ++j) {
+        const __m256i *c = reinterpret_cast<const __m256i *>(candidates[j].w);
+        const __m256i c0 = _mm256_loadu_si256(c);
+        const __m256i c1 = _mm256_loadu_si256(c + 1);
+        const __m256i common = _mm256_add_epi8(popCountBytesAvx2(_mm256_and_si256(q0, c0)),
+                                               popCountBytesAvx2(_mm256_and_si256(q1, c1)));
+        const __m256i all = _mm256_add_epi8(popCountBytesAvx2(_mm256_or_si256(q0, c0)),
+                                            popCountBytesAvx2(_mm256_or_si256(q1, c1)));
+        scores[j] = similarityScore(sumBytesAvx2(common), sumBytesAvx2(all),
+                                    qAbs(length - lengths[j]));
+    }
+}
+#endif
+
+/*
+  Scores the \a count matrices at \a candidates, of texts whose lengths
+  are at \a lengths, and stores the scores at \a scores. Uses AVX2 or
+  POPCNT if the processor has them, SSE2 on other x86 processors, and
+  plain words elsewhere.
+*/
+void StringSimilarityMatcher::getSimilarityScores(const CoMatrix *candidates, const int *lengths,
+                                                  int count, int *scores) const
+{
+#if QT_COMPILER_SUPPORTS_HERE(AVX2)
+    if (qCpuHasFeature(AVX2)) {
+        scoresAvx2(m_cm, m_length, candidates, lengths, count, scores);
+        return;
+    }
+#endif
+#if QT_COMPILER_SUPPORTS_HERE(POPCNT)
+    if (qCpuHasFeature(POPCNT)) {
+        scoresPopcnt(m_cm, m_length, candidates, lengths, count, scores);
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    scoresSse2(m_cm, m_length, candidates, lengths, count, scores);
+#else
+    scoresScalar(m_cm, m_length, candidates, lengths, count, scores);
+#endif
+}
+
+SimilarTextIndex::SimilarTextIndex()
+    : m_count(0), m_byWorth(401)
+{
+}
+
+void SimilarTextIndex::clear()
+{
+    m_count = 0;
+    for (Bucket &bucket : m_byWorth) {
+        bucket.matrices.clear();
+        bucket.lengths.clear();
+        bucket.indexes.clear();
+    }
+}
+
+/*
+  Adds \a text to the index and returns its index.
+*/
+int SimilarTextIndex::append(const QString &text)
+{
+    const CoMatrix cm(text);
+    Bucket &bucket = m_byWorth[worth(cm)];
+    bucket.matrices.append(cm);
+    bucket.lengths.append(text.length());
+    bucket.indexes.append(m_count);
+    return m_count++;
+}
+
+/*
+  Returns the texts that are at least \a threshold similar to \a text,
+  in the order in which they were appended. Only the texts whose number
+  of co-occurrences is close enough to the one of \a text are scored,
+  each group of them in one batch.
+*/
+QVector<SimilarTextIndex::Match> SimilarTextIndex::matches(const QString &text,
+                                                           int threshold) const
+{
+    const StringSimilarityMatcher matcher(text);
+    const int w = worth(CoMatrix(text));
+
+    QVector<Match> result;
+    QVector<int> scores;
+    for (int cw = 0; cw < m_byWorth.size(); ++cw) {
+        const Bucket &bucket = m_byWorth.at(cw);
+        if (bucket.indexes.isEmpty() || !canReach(w, cw, 0, threshold))
+            continue;
+        scores.resize(bucket.indexes.size());
+        matcher.getSimilarityScores(bucket.matrices.constData(), bucket.lengths.constData(),
+                                    bucket.indexes.size(), scores.data());
+        for (int i = 0; i < scores.size(); ++i) {
+            if (scores.at(i) >= threshold) {
+                const Match match = { bucket.indexes.at(i), scores.at(i) };
+                result.append(match);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Match &m1, const Match &m2) {
+        return m1.index < m2.index;
+    });
+    return result;
+}
+
 CandidateList similarTextHeuristicCandidates(const Translator *tor,
     const QString &text, int maxCandidates)
 {
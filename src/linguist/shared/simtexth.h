@@ -33,6 +33,7 @@ const int textSimilarityThreshold = 190;
 
 #include <QString>
 #include <QList>
+#include <QVector>
 
 QT_BEGIN_NAMESPACE
 
@@ -69,10 +70,12 @@ struct CoMatrix
     /*
       The matrix has 20 * 20 = 400 entries.  This requires 50 bytes, or 13
       words.  Some operations are performed on words for more efficiency.
+      The matrix is padded with zeros to 16 words, so that they can be
+      processed 128 or 256 bits at a time, too.
     */
     union {
-        quint8 b[52];
-        quint32 w[13];
+        quint8 b[64];
+        quint32 w[16];
     };
 };
 
@@ -86,6 +89,8 @@ class StringSimilarityMatcher {
 public:
     StringSimilarityMatcher(const QString &stringToMatch);
     int getSimilarityScore(const QString &strCandidate);
+    void getSimilarityScores(const CoMatrix *candidates, const int *lengths, int count,
+                             int *scores) const;
 
 private:
     CoMatrix m_cm;
@@ -104,6 +109,40 @@ static inline int getSimilarityScore(const QString &str1, const QString &str2)
     return StringSimilarityMatcher(str1).getSimilarityScore(str2);
 }
 
+/**
+ * Keeps the co-occurrence matrices of many texts, so that the texts similar
+ * to a given one can be found without building them again for each search.
+ * The matrices are stored contiguously and scored in batches.
+ * Texts are identified by the order in which they were appended.
+ * \sa StringSimilarityMatcher
+ */
+class SimilarTextIndex {
+public:
+    struct Match {
+        int index;
+        int score;
+    };
+
+    SimilarTextIndex();
+
+    void clear();
+    int append(const QString &text);
+    int size() const { return m_count; }
+
+    QVector<Match> matches(const QString &text, int threshold = textSimilarityThreshold) const;
+
+private:
+    // The texts whose matrices have the same number of bits set
+    struct Bucket {
+        QVector<CoMatrix> matrices;
+        QVector<int> lengths;
+        QVector<int> indexes;
+    };
+
+    int m_count;
+    QVector<Bucket> m_byWorth;
+};
+
 CandidateList similarTextHeuristicCandidates( const Translator *tor,
                                               const QString &text,
                                               int maxCandidates );
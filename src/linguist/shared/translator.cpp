@@ -53,7 +53,8 @@ QT_BEGIN_NAMESPACE
 
 Translator::Translator() :
     m_locationsType(AbsoluteLocations),
-    m_indexOk(true)
+    m_indexOk(true),
+    m_refIdxOk(false)
 {
 }
 
@@ -110,6 +111,25 @@ void Translator::ensureIndexed() const
     }
 }
 
+void Translator::addRefIndex(int idx, const TranslatorMessage &msg) const
+{
+    foreach (const TranslatorMessage::Reference &ref, msg.allReferences()) {
+        const TMRefKey key(msg.context(), msg.comment(), ref);
+        if (!m_refIdx.contains(key))
+            m_refIdx.insert(key, idx);
+    }
+}
+
+void Translator::ensureRefIndexed() const
+{
+    if (!m_refIdxOk) {
+        m_refIdxOk = true;
+        m_refIdx.clear();
+        for (int i = 0; i < m_messages.count(); i++)
+            addRefIndex(i, m_messages.at(i));
+    }
+}
+
 void Translator::replaceSorted(const TranslatorMessage &msg)
 {
     int index = find(msg);
@@ -119,6 +139,7 @@ void Translator::replaceSorted(const TranslatorMessage &msg)
         delIndex(index);
         m_messages[index] = msg;
         addIndex(index, msg);
+        m_refIdxOk = false;
     }
 }
 
@@ -161,6 +182,12 @@ void Translator::extend(const TranslatorMessage &msg, ConversionData &cd)
             return;
         }
         emsg.addReferenceUniq(msg.fileName(), msg.lineNumber());
+        if (m_refIdxOk) {
+            const TMRefKey key(emsg.context(), emsg.comment(),
+                               TranslatorMessage::Reference(msg.fileName(), msg.lineNumber()));
+            if (!m_refIdx.contains(key))
+                m_refIdx.insert(key, index);
+        }
         if (!msg.extraComment().isEmpty()) {
             QString cmt = emsg.extraComment();
             if (!cmt.isEmpty()) {
@@ -185,6 +212,12 @@ void Translator::insert(int idx, const TranslatorMessage &msg)
         else
             m_indexOk = false;
     }
+    if (m_refIdxOk) {
+        if (idx == m_messages.count())
+            addRefIndex(idx, msg);
+        else
+            m_refIdxOk = false;
+    }
     m_messages.insert(idx, msg);
 }
 
@@ -382,19 +415,16 @@ int Translator::find(const TranslatorMessage &msg) const
 int Translator::find(const QString &context,
     const QString &comment, const TranslatorMessage::References &refs) const
 {
-    if (!refs.isEmpty()) {
-        for (TMM::ConstIterator it = m_messages.constBegin(); it != m_messages.constEnd(); ++it) {
-            if (it->context() == context && it->comment() == comment) {
-                foreach (const TranslatorMessage::Reference &itref, it->allReferences()) {
-                    foreach (const TranslatorMessage::Reference &ref, refs) {
-                        if (itref == ref)
-                            return it - m_messages.constBegin();
-                    }
-                }
-            }
-        }
+    if (refs.isEmpty())
+        return -1;
+    ensureRefIndexed();
+    int found = -1;
+    foreach (const TranslatorMessage::Reference &ref, refs) {
+        const int i = m_refIdx.value(TMRefKey(context, comment, ref), -1);
+        if (i >= 0 && (found < 0 || i < found))
+            found = i;
     }
-    return -1;
+    return found;
 }
 
 int Translator::find(const QString &context) const
@@ -411,6 +441,7 @@ void Translator::stripObsoleteMessages()
         else
             ++it;
     m_indexOk = false;
+    m_refIdxOk = false;
 }
 
 void Translator::stripFinishedMessages()
@@ -421,6 +452,7 @@ void Translator::stripFinishedMessages()
         else
             ++it;
     m_indexOk = false;
+    m_refIdxOk = false;
 }
 
 void Translator::stripUntranslatedMessages()
@@ -431,6 +463,7 @@ void Translator::stripUntranslatedMessages()
         else
             ++it;
     m_indexOk = false;
+    m_refIdxOk = false;
 }
 
 bool Translator::translationsExist()
@@ -452,6 +485,7 @@ void Translator::stripEmptyContexts()
         else
             ++it;
     m_indexOk = false;
+    m_refIdxOk = false;
 }
 
 void Translator::stripNonPluralForms()
@@ -462,6 +496,7 @@ void Translator::stripNonPluralForms()
         else
             ++it;
     m_indexOk = false;
+    m_refIdxOk = false;
 }
 
 void Translator::stripIdenticalSourceTranslations()
@@ -474,6 +509,7 @@ void Translator::stripIdenticalSourceTranslations()
             ++it;
     }
     m_indexOk = false;
+    m_refIdxOk = false;
 }
 
 void Translator::dropTranslations()
@@ -503,6 +539,7 @@ void Translator::dropUiLines()
         }
         it->setReferences(refs);
     }
+    m_refIdxOk = false;
 }
 
 struct TranslatorMessageIdPtr {
@@ -613,6 +650,7 @@ Translator::Duplicates Translator::resolveDuplicates()
         if (!omsg->isTranslated() && msg.isTranslated())
             omsg->setTranslations(msg.translations());
         m_indexOk = false;
+        m_refIdxOk = false;
         m_messages.removeAt(i);
     }
     return dups;
@@ -656,6 +694,7 @@ void Translator::makeFileNamesAbsolute(const QDir &originalPath)
             msg.addReference(fileName, ref.lineNumber());
         }
     }
+    m_refIdxOk = false;
 }
 
 QList<TranslatorMessage> Translator::messages() const
@@ -58,7 +58,8 @@ public:
         m_sortContexts(false),
         m_noUiLines(false),
         m_idBased(false),
-        m_saveMode(SaveEverything)
+        m_saveMode(SaveEverything),
+        m_jobs(0)
     {}
 
     // tag manipulation
@@ -81,6 +82,7 @@ public:
     QString m_sourceFileName;
     QString m_targetFileName;
     QString m_compileCommandsPath;
+    QString m_cacheFile; // CPP specific
     QStringList m_excludes;
     QDir m_sourceDir;
     QDir m_targetDir; // FIXME: TS specific
@@ -95,6 +97,7 @@ public:
     bool m_noUiLines;
     bool m_idBased;
     TranslatorSaveMode m_saveMode;
+    int m_jobs; // CPP specific, 0 for as many as there are cores
 };
 
 class TMMKey {
@@ -108,6 +111,20 @@ public:
 Q_DECLARE_TYPEINFO(TMMKey, Q_MOVABLE_TYPE);
 inline uint qHash(const TMMKey &key) { return qHash(key.context) ^ qHash(key.source) ^ qHash(key.comment); }
 
+class TMRefKey {
+public:
+    TMRefKey(const QString &ctx, const QString &cmt, const TranslatorMessage::Reference &ref)
+        : context(ctx), comment(cmt), fileName(ref.fileName()), lineNumber(ref.lineNumber()) {}
+    bool operator==(const TMRefKey &o) const
+        { return lineNumber == o.lineNumber && fileName == o.fileName
+                 && context == o.context && comment == o.comment; }
+    QString context, comment, fileName;
+    int lineNumber;
+};
+Q_DECLARE_TYPEINFO(TMRefKey, Q_MOVABLE_TYPE);
+inline uint qHash(const TMRefKey &key)
+    { return qHash(key.context) ^ qHash(key.comment) ^ qHash(key.fileName) ^ uint(key.lineNumber); }
+
 class Translator
 {
 public:
@@ -161,7 +178,7 @@ public:
     QStringList normalizedTranslations(const TranslatorMessage &m, ConversionData &cd, bool *ok) const;
 
     int messageCount() const { return m_messages.size(); }
-    TranslatorMessage &message(int i) { return m_messages[i]; }
+    TranslatorMessage &message(int i) { m_refIdxOk = false; return m_messages[i]; }
     const TranslatorMessage &message(int i) const { return m_messages.at(i); }
     const TranslatorMessage &constMessage(int i) const { return m_messages.at(i); }
     void dump() const;
@@ -206,6 +223,8 @@ private:
     void addIndex(int idx, const TranslatorMessage &msg) const;
     void delIndex(int idx) const;
     void ensureIndexed() const;
+    void addRefIndex(int idx, const TranslatorMessage &msg) const;
+    void ensureRefIndexed() const;
 
     typedef QList<TranslatorMessage> TMM;       // int stores the sequence position.
 
@@ -230,6 +249,9 @@ private:
     mutable QHash<QString, int> m_ctxCmtIdx;
     mutable QHash<QString, int> m_idMsgIdx;
     mutable QHash<TMMKey, int> m_msgIdx;
+    // (context, comment, file, line) -> first message with that reference
+    mutable bool m_refIdxOk;
+    mutable QHash<TMRefKey, int> m_refIdx;
 };
 
 bool getNumerusInfo(QLocale::Language language, QLocale::Country country,
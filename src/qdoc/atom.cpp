@@ -34,6 +34,7 @@
 #include <QtCore/qdebug.h>
 #include <QtCore/qregexp.h>
 
+#include <cstddef>
 #include <stdio.h>
 
 QT_BEGIN_NAMESPACE
@@ -353,6 +354,61 @@ QString Atom::typeString() const
   \also type(), next()
 */
 
+/*
+  Atoms are allocated from chunks of equally sized blocks that are
+  recycled through a free list, instead of one heap allocation each.
+  A doc comment becomes a long chain of atoms that is walked from
+  start to end, and consecutive atoms then lie next to each other in
+  memory. The chunks live until qdoc exits; freed blocks are reused
+  by the next atoms. Each thread has its own free list.
+ */
+struct FreeAtomBlock
+{
+    FreeAtomBlock *next_;
+};
+
+static const size_t atomBlockAlignment = alignof(std::max_align_t);
+static const size_t atomBlockSize =
+        (qMax(sizeof(Atom), sizeof(LinkAtom)) + atomBlockAlignment - 1) & ~(atomBlockAlignment - 1);
+static const int atomBlocksPerChunk = 512;
+static thread_local FreeAtomBlock *freeAtomBlocks = nullptr;
+
+/*!
+  Allocates \a size bytes for a new atom from the atom pool.
+ */
+void *Atom::operator new(size_t size)
+{
+    if (size > atomBlockSize)
+        return ::operator new(size);
+    if (freeAtomBlocks == nullptr) {
+        char *chunk = static_cast<char *>(::operator new(atomBlockSize * atomBlocksPerChunk));
+        for (int i = atomBlocksPerChunk - 1; i >= 0; --i) {
+            FreeAtomBlock *block = reinterpret_cast<FreeAtomBlock *>(chunk + i * atomBlockSize);
+            block->next_ = freeAtomBlocks;
+            freeAtomBlocks = block;
+        }
+    }
+    FreeAtomBlock *block = freeAtomBlocks;
+    freeAtomBlocks = block->next_;
+    return block;
+}
+
+/*!
+  Returns the \a size bytes at \a ptr to the atom pool.
+ */
+void Atom::operator delete(void *ptr, size_t size)
+{
+    if (ptr == nullptr)
+        return;
+    if (size > atomBlockSize) {
+        ::operator delete(ptr);
+        return;
+    }
+    FreeAtomBlock *block = static_cast<FreeAtomBlock *>(ptr);
+    block->next_ = freeAtomBlocks;
+    freeAtomBlocks = block;
+}
+
 /*!
   Dumps this Atom to stderr in printer friendly form.
  */
@@ -172,6 +172,9 @@ public:
 
     virtual ~Atom() { }
 
+    static void *operator new(size_t size);
+    static void operator delete(void *ptr, size_t size);
+
     void appendChar(QChar ch) { strs[0] += ch; }
     void appendString(const QString &string) { strs[0] += string; }
     void chopString() { strs[0].chop(1); }
@@ -48,16 +48,32 @@
 #include "generator.h"
 #include "loggingcategory.h"
 #include "qdocdatabase.h"
+#include "timings.h"
 #include "utilities.h"
 
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qlockfile.h>
+#include <QtCore/qsavefile.h>
 #include <QtCore/qscopedvaluerollback.h>
 #include <QtCore/qtemporarydir.h>
+#if QT_CONFIG(thread)
+#  include <QtCore/qmutex.h>
+#  include <QtCore/qthreadpool.h>
+#  include <QtCore/qwaitcondition.h>
+#endif
 
 #include <clang-c/Index.h>
 
+#include <algorithm>
+#include <memory>
+
 #include <errno.h>
 #include <stdio.h>
 
@@ -1006,6 +1022,198 @@ Node *ClangVisitor::nodeForCommentAtLocation(CXSourceLocation loc, CXSourceLocat
     return node;
 }
 
+/*!
+  \class TranslationUnitPrefetcher
+  \internal
+
+  Parses C++ source files into clang translation units on a pool
+  of worker threads, ahead of the point where ClangCodeParser
+  needs them. Each worker uses its own CXIndex; the precompiled
+  header is shared read-only by all of them.
+
+  Only the clang parse itself runs concurrently. Visiting the
+  translation units, parsing the documentation comments, and
+  adding nodes to the tree still happen on the main thread, in
+  the order the files are requested with take(). That keeps the
+  resulting tree, and thus the generated output, identical to a
+  serial run.
+ */
+class TranslationUnitPrefetcher
+{
+public:
+    TranslationUnitPrefetcher(int threads, CXTranslationUnit_Flags flags);
+    ~TranslationUnitPrefetcher();
+
+    void enqueue(const QString &filePath, const QVector<QByteArray> &args);
+    bool take(const QString &filePath, CXIndex *index, CXTranslationUnit *tu, CXErrorCode *err);
+
+private:
+    struct Job
+    {
+        QString filePath_;
+        QVector<QByteArray> args_;
+        CXIndex index_ = nullptr;
+        CXTranslationUnit tu_ = nullptr;
+        CXErrorCode err_ = CXError_Failure;
+        bool started_ = false;
+        bool done_ = false;
+        bool taken_ = false;
+    };
+
+    void run(Job *job);
+    void startJobs();
+
+    CXTranslationUnit_Flags flags_;
+    int window_;
+    int nextJob_ = 0;
+    int pending_ = 0;
+    std::vector<std::unique_ptr<Job>> jobs_;
+    QHash<QString, Job *> jobForFile_;
+#if QT_CONFIG(thread)
+    QThreadPool pool_;
+    QMutex mutex_;
+    QWaitCondition finished_;
+#endif
+};
+
+/*!
+  Constructs a prefetcher that parses up to \a threads files
+  concurrently with the translation unit \a flags. At most twice
+  that many parsed, but not yet taken, translation units are kept
+  in memory at any time.
+ */
+TranslationUnitPrefetcher::TranslationUnitPrefetcher(int threads, CXTranslationUnit_Flags flags)
+    : flags_(flags), window_(2 * threads)
+{
+#if QT_CONFIG(thread)
+    pool_.setMaxThreadCount(threads);
+    // Parsing deeply nested templates needs more than the default stack.
+    pool_.setStackSize(8 * 1024 * 1024);
+#endif
+}
+
+/*!
+  Waits for the running jobs to finish and disposes of all
+  translation units that were never taken.
+ */
+TranslationUnitPrefetcher::~TranslationUnitPrefetcher()
+{
+#if QT_CONFIG(thread)
+    pool_.waitForDone();
+#endif
+    for (const auto &job : jobs_) {
+        if (job->taken_)
+            continue;
+        if (job->tu_)
+            clang_disposeTranslationUnit(job->tu_);
+        if (job->index_)
+            clang_disposeIndex(job->index_);
+    }
+}
+
+/*!
+  Appends the source file \a filePath, to be parsed with the
+  command line \a args, to the queue of files to prefetch.
+ */
+void TranslationUnitPrefetcher::enqueue(const QString &filePath, const QVector<QByteArray> &args)
+{
+    if (jobForFile_.contains(filePath))
+        return;
+    auto job = std::make_unique<Job>();
+    job->filePath_ = filePath;
+    job->args_ = args;
+    jobForFile_.insert(filePath, job.get());
+    jobs_.push_back(std::move(job));
+#if QT_CONFIG(thread)
+    QMutexLocker locker(&mutex_);
+#endif
+    startJobs();
+}
+
+/*!
+  Parses the file of \a job. This is called on a worker thread.
+ */
+void TranslationUnitPrefetcher::run(Job *job)
+{
+    std::vector<const char *> args;
+    args.reserve(job->args_.size());
+    for (const auto &arg : qAsConst(job->args_))
+        args.push_back(arg.constData());
+
+    CXIndex index = clang_createIndex(1, 0);
+    CXTranslationUnit tu = nullptr;
+    CXErrorCode err = clang_parseTranslationUnit2(index, QFile::encodeName(job->filePath_).constData(),
+                                                  args.data(), static_cast<int>(args.size()),
+                                                  nullptr, 0, flags_, &tu);
+#if QT_CONFIG(thread)
+    QMutexLocker locker(&mutex_);
+#endif
+    job->index_ = index;
+    job->tu_ = tu;
+    job->err_ = err;
+    job->done_ = true;
+#if QT_CONFIG(thread)
+    finished_.wakeAll();
+#endif
+}
+
+/*!
+  Starts queued jobs until the prefetch window is full. The
+  caller must hold the mutex.
+ */
+void TranslationUnitPrefetcher::startJobs()
+{
+    while (pending_ < window_ && nextJob_ < static_cast<int>(jobs_.size())) {
+        Job *job = jobs_[nextJob_++].get();
+        job->started_ = true;
+        ++pending_;
+#if QT_CONFIG(thread)
+        pool_.start([this, job]() { run(job); });
+#else
+        run(job);
+#endif
+    }
+}
+
+/*!
+  Waits until the file \a filePath has been parsed and hands its
+  \a index, translation unit \a tu, and error code \a err over to
+  the caller, who becomes responsible for disposing of them.
+
+  Returns \c false if \a filePath was never enqueued, in which
+  case the caller must parse the file itself.
+ */
+bool TranslationUnitPrefetcher::take(const QString &filePath, CXIndex *index,
+                                     CXTranslationUnit *tu, CXErrorCode *err)
+{
+    Job *job = jobForFile_.value(filePath);
+    if (!job || job->taken_)
+        return false;
+#if QT_CONFIG(thread)
+    QMutexLocker locker(&mutex_);
+#endif
+    if (!job->started_) {
+        // Requested out of order; move it to the front of the queue.
+        auto it = std::find_if(jobs_.begin() + nextJob_, jobs_.end(),
+                               [job](const std::unique_ptr<Job> &j) { return j.get() == job; });
+        std::rotate(jobs_.begin() + nextJob_, it, it + 1);
+        ++window_;
+        startJobs();
+        --window_;
+    }
+#if QT_CONFIG(thread)
+    while (!job->done_)
+        finished_.wait(&mutex_);
+#endif
+    job->taken_ = true;
+    --pending_;
+    *index = job->index_;
+    *tu = job->tu_;
+    *err = job->err_;
+    startJobs();
+    return true;
+}
+
 /*!
   The destructor is trivial.
  */
@@ -1044,7 +1252,13 @@ void ClangCodeParser::initializeParser(const Config &config)
                         return path.prepend("-I");
                     });
     CppCodeParser::initializeParser(config);
+    pchUseLock_.reset(nullptr);
     pchFileDir_.reset(nullptr);
+    pchCacheDir_ = Config::pchCacheDir;
+    if (pchCacheDir_.isEmpty() && !config.getString(CONFIG_PCHCACHE).isEmpty())
+        pchCacheDir_ = QDir::current().absoluteFilePath(config.getString(CONFIG_PCHCACHE));
+    const int pchCacheSize = config.getInt(CONFIG_PCHCACHESIZE);
+    pchCacheSize_ = qint64(pchCacheSize > 0 ? pchCacheSize : 1024) * 1024 * 1024;
     allHeaders_.clear();
     pchName_.clear();
     defines_.clear();
@@ -1073,12 +1287,29 @@ void ClangCodeParser::initializeParser(const Config &config)
     }
     qCDebug(lcQdoc).nospace() << __FUNCTION__ << " Clang v" << CINDEX_VERSION_MAJOR
         << '.' << CINDEX_VERSION_MINOR;
+
+    /*
+      In incremental mode, the snapshot is kept in the output
+      directory unless -snapshot names a file, so each run replays
+      the source files that did not change since the previous one.
+     */
+    snapshotFile_ = Config::snapshotFile;
+    if (snapshotFile_.isEmpty() && Generator::incremental())
+        snapshotFile_ = QDir(config.getOutputDir()).absoluteFilePath(QLatin1String(".qdoc-snapshot"));
+    snapshot_.clear();
+    snapshotLoaded_ = false;
+    snapshotChanged_ = false;
+    headersStamp_.clear();
 }
 
 /*!
  */
 void ClangCodeParser::terminateParser()
 {
+    prefetcher_.reset(nullptr);
+    if (recordsSnapshot())
+        writeSnapshot();
+    snapshotNodes_.clear();
     CppCodeParser::terminateParser();
 }
 
@@ -1205,10 +1436,151 @@ bool ClangCodeParser::getMoreArgs()
     return guessedIncludePaths;
 }
 
+/*!
+  Computes the cache key for a precompiled header. The key is a
+  hash of the \a headerContents the PCH is built from, the clang
+  command line \a args (include paths and defines), the clang
+  version, and the path, size and modification time of each of the
+  module's headers in \a allHeaders.
+ */
+static QString pchCacheKey(const QByteArray &headerContents,
+                           const std::vector<const char *> &args,
+                           const QHash<QString, QString> &allHeaders)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(headerContents);
+    for (const char *arg : args)
+        hash.addData(arg, static_cast<int>(qstrlen(arg)) + 1);
+    hash.addData(fromCXString(clang_getClangVersion()).toUtf8());
+
+    QStringList names = allHeaders.keys();
+    names.sort();
+    for (const auto &name : qAsConst(names)) {
+        const QFileInfo fi(allHeaders.value(name) + QLatin1Char('/') + name);
+        hash.addData(fi.filePath().toUtf8());
+        hash.addData(QByteArray::number(fi.size()));
+        hash.addData(QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+    }
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+/*!
+  Returns the directory that holds the use locks of the qdoc
+  processes working with the PCH cache entry at \a entryPath.
+ */
+static QString pchCacheUsersDir(const QString &entryPath)
+{
+    return entryPath + QLatin1String(".users");
+}
+
+/*!
+  Registers this process as a user of the PCH cache entry at
+  \a entryPath and returns the use lock, or \c nullptr if it
+  cannot be taken. The caller must hold the entry lock.
+ */
+static QLockFile *lockPchCacheEntryForUse(const QString &entryPath)
+{
+    const QString usersDir = pchCacheUsersDir(entryPath);
+    if (!QDir().mkpath(usersDir))
+        return nullptr;
+    QScopedPointer<QLockFile> useLock(new QLockFile(usersDir + QLatin1Char('/')
+        + QString::number(QCoreApplication::applicationPid()) + QLatin1String(".lock")));
+    useLock->setStaleLockTime(0);
+    if (!useLock->tryLock(0))
+        return nullptr;
+    return useLock.take();
+}
+
+/*!
+  Returns \c true if a running qdoc process holds a use lock on
+  the PCH cache entry at \a entryPath. Use locks left behind by
+  processes that no longer run are removed. The caller must hold
+  the entry lock, so that no new user can register meanwhile.
+ */
+static bool isPchCacheEntryInUse(const QString &entryPath)
+{
+    const QDir usersDir(pchCacheUsersDir(entryPath));
+    const QStringList lockFiles = usersDir.entryList(QStringList("*.lock"), QDir::Files);
+    for (const auto &lockFile : lockFiles) {
+        QLockFile useLock(usersDir.filePath(lockFile));
+        useLock.setStaleLockTime(0);
+        if (!useLock.tryLock(0))
+            return true;
+        useLock.unlock();
+    }
+    return false;
+}
+
+/*!
+  Removes the PCH cache entry at \a entryPath and its use locks.
+ */
+static void removePchCacheEntry(const QString &entryPath)
+{
+    QDir(entryPath).removeRecursively();
+    QDir(pchCacheUsersDir(entryPath)).removeRecursively();
+}
+
+/*!
+  Removes the least recently used entries from the PCH cache in
+  \a cacheDir until the precompiled headers in it take up at most
+  \a maxSize bytes. The entry named \a keep is never removed.
+
+  An entry is only removed when its entry lock can be taken
+  without waiting and no running qdoc process uses it. Entries
+  that are being built, or whose PCH another process is parsing
+  with, stay in the cache.
+ */
+static void evictPchCache(const QString &cacheDir, const QString &keep, qint64 maxSize)
+{
+    struct Entry {
+        QString path_;
+        QDateTime lastUsed_;
+        qint64 size_;
+    };
+    QVector<Entry> entries;
+    const QFileInfoList dirs = QDir(cacheDir).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const auto &dir : dirs) {
+        if (dir.fileName().endsWith(QLatin1String(".users")))
+            continue;
+        const QFileInfoList pchFiles = QDir(dir.filePath()).entryInfoList(QStringList("*.pch"), QDir::Files);
+        Entry entry { dir.filePath(), dir.lastModified(), 0 };
+        for (const auto &pch : pchFiles) {
+            entry.size_ += pch.size();
+            entry.lastUsed_ = qMax(entry.lastUsed_, pch.lastModified());
+        }
+        entries.append(entry);
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.lastUsed_ > b.lastUsed_;
+    });
+    qint64 total = 0;
+    for (const auto &entry : qAsConst(entries)) {
+        total += entry.size_;
+        if (total <= maxSize || QFileInfo(entry.path_).fileName() == keep)
+            continue;
+        QLockFile entryLock(entry.path_ + QLatin1String(".lock"));
+        entryLock.setStaleLockTime(0);
+        if (!entryLock.tryLock(0) || isPchCacheEntryInUse(entry.path_))
+            continue;
+        qCDebug(lcQdoc) << "Evicting" << entry.path_ << "from the PCH cache";
+        removePchCacheEntry(entry.path_);
+        total -= entry.size_;
+    }
+}
+
 /*!
   Building the PCH must be possible when there are no .cpp
   files, so it is moved here to its own member function, and
   it is called after the list of header files is complete.
+
+  If the PCH cache is enabled, a PCH built by an earlier qdoc
+  run from the same module header, include paths, defines and
+  clang version is loaded from the cache instead of rebuilding
+  it. A freshly built PCH is stored in the cache. The cached PCH
+  is used in place, so the prepare and generate phases share it.
+  The parser keeps a use lock on the entry until it is
+  initialized for the next module or destroyed, because every
+  source file is parsed with the PCH.
  */
 void ClangCodeParser::buildPCH()
 {
@@ -1277,10 +1649,9 @@ void ClangCodeParser::buildPCH()
             }
             args_.push_back("-xc++");
             CXTranslationUnit tu;
-            QString tmpHeader = pchFileDir_->path() + "/" + module;
-            QFile tmpHeaderFile(tmpHeader);
-            if (tmpHeaderFile.open(QIODevice::Text | QIODevice::WriteOnly)) {
-                QTextStream out(&tmpHeaderFile);
+            QByteArray headerContents;
+            {
+                QTextStream out(&headerContents, QIODevice::WriteOnly);
                 if (header.isEmpty()) {
                     QList<QString> keys = allHeaders_.keys();
                     QList<QString> values = allHeaders_.values();
@@ -1305,7 +1676,73 @@ void ClangCodeParser::buildPCH()
                             out << line << "\n";
                     }
                 }
-            tmpHeaderFile.close();
+            }
+
+            /*
+              The cache entry directory holds both the generated
+              header and the PCH. The header must stay where the PCH
+              was built from it, or clang refuses to use the PCH.
+              The entry lock keeps concurrent qdoc processes from
+              building, replacing or evicting the same entry at the
+              same time. It is held only until this process has
+              registered its use lock on the entry.
+             */
+            QString pchDir = pchFileDir_->path();
+            QString cacheEntry;
+            QScopedPointer<QLockFile> cacheLock;
+            if (!pchCacheDir_.isEmpty() && QDir().mkpath(pchCacheDir_)) {
+                cacheEntry = QString::fromUtf8(module).replace(QLatin1Char('/'), QLatin1Char('_'))
+                    + QLatin1Char('-') + pchCacheKey(headerContents, args_, allHeaders_);
+                cacheLock.reset(new QLockFile(pchCacheDir_ + QLatin1Char('/') + cacheEntry + QLatin1String(".lock")));
+                cacheLock->setStaleLockTime(0);
+                if (cacheLock->lock())
+                    pchDir = pchCacheDir_ + QLatin1Char('/') + cacheEntry;
+                else
+                    cacheEntry.clear();
+            }
+
+            QByteArray pchFile = pchDir.toUtf8() + "/" + module + ".pch";
+            if (!cacheEntry.isEmpty() && QFile::exists(QString::fromUtf8(pchFile))) {
+                CXErrorCode err = clang_createTranslationUnit2(index_, pchFile.constData(), &tu);
+                qCDebug(lcQdoc) << __FUNCTION__ << "clang_createTranslationUnit2("
+                                << pchFile << ") returns" << err;
+                if (!err && tu)
+                    pchUseLock_.reset(lockPchCacheEntryForUse(pchDir));
+                if (!err && tu && pchUseLock_) {
+                    pchName_ = pchFile;
+                    // Mark the entry as recently used for eviction.
+                    QFile(QString::fromUtf8(pchFile)).setFileTime(QDateTime::currentDateTime(),
+                                                                  QFileDevice::FileModificationTime);
+                    CXCursor cur = clang_getTranslationUnitCursor(tu);
+                    ClangVisitor visitor(qdb_, allHeaders_);
+                    visitor.visitChildren(cur);
+                    clang_disposeTranslationUnit(tu);
+                    Location::logToStdErrAlways("PCH loaded from cache & visited for " + moduleHeader());
+                    Timings::increment(Timings::PchCacheHits);
+                    args_.pop_back(); // remove the "-xc++";
+                    return;
+                }
+                if (!err && tu)
+                    clang_disposeTranslationUnit(tu);
+                if (isPchCacheEntryInUse(pchDir)) {
+                    // Another process parses with it; build a private PCH.
+                    cacheLock.reset();
+                    cacheEntry.clear();
+                    pchDir = pchFileDir_->path();
+                    pchFile = pchDir.toUtf8() + "/" + module + ".pch";
+                } else {
+                    // The cached PCH is unusable; rebuild it.
+                    removePchCacheEntry(pchDir);
+                }
+            }
+            if (!cacheEntry.isEmpty())
+                QDir().mkpath(pchDir);
+
+            QString tmpHeader = pchDir + "/" + module;
+            QFile tmpHeaderFile(tmpHeader);
+            if (tmpHeaderFile.open(QIODevice::WriteOnly)) {
+                tmpHeaderFile.write(headerContents);
+                tmpHeaderFile.close();
             }
             if (printParsingErrors_ == 0)
                 Location::logToStdErrAlways("clang not printing errors; include paths were guessed");
@@ -1316,13 +1753,22 @@ void ClangCodeParser::buildPCH()
             qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2("
                             << tmpHeader <<  args_ << ") returns" << err;
             if (!err && tu) {
-                pchName_ = pchFileDir_->path().toUtf8() + "/" + module + ".pch";
+                pchName_ = pchFile;
                 auto error = clang_saveTranslationUnit(tu, pchName_.constData(), clang_defaultSaveOptions(tu));
+                if (!error && !cacheEntry.isEmpty()) {
+                    pchUseLock_.reset(lockPchCacheEntryForUse(pchDir));
+                    if (!pchUseLock_)
+                        error = CXSaveError_Unknown;
+                }
                 if (error) {
                     Location::logToStdErrAlways("Could not save PCH file for " + moduleHeader());
                     pchName_.clear();
+                    if (!cacheEntry.isEmpty())
+                        removePchCacheEntry(pchDir);
                 }
                 else {
+                    if (!cacheEntry.isEmpty())
+                        evictPchCache(pchCacheDir_, cacheEntry, pchCacheSize_);
                     // Visit the header now, as token from pre-compiled header won't be visited later
                     CXCursor cur = clang_getTranslationUnitCursor(tu);
                     ClangVisitor visitor(qdb_, allHeaders_);
@@ -1331,7 +1777,10 @@ void ClangCodeParser::buildPCH()
                 }
                 clang_disposeTranslationUnit(tu);
             } else {
-                pchFileDir_->remove();
+                if (cacheEntry.isEmpty())
+                    pchFileDir_->remove();
+                else
+                    removePchCacheEntry(pchDir);
                 Location::logToStdErrAlways("Could not create PCH file for " + moduleHeader());
             }
             args_.pop_back(); // remove the "-xc++";
@@ -1357,6 +1806,131 @@ void ClangCodeParser::precompileHeaders()
     clang_disposeIndex(index_);
 }
 
+/*!
+  Load the command line for parsing the source file \a filePath
+  into \a args_. This is the default arguments and defines, the
+  precompiled header, if there is one, and the include paths.
+ */
+void ClangCodeParser::getSourceArgs(const QString &filePath)
+{
+    getDefaultArgs();
+    if (!pchName_.isEmpty() && !filePath.endsWith(".mm")) {
+        args_.push_back("-w");
+        args_.push_back("-include-pch");
+        args_.push_back(pchName_.constData());
+    }
+    getMoreArgs();
+    for (const auto &p : qAsConst(moreArgs_))
+        args_.push_back(p.constData());
+}
+
+/*!
+  Start parsing the C++ source files in \a filePaths on a pool of
+  worker threads, if more than one job was requested with the
+  \c -jobs command line option. The files should be listed in the
+  order in which parseSourceFile() will be called for them.
+
+  parseSourceFile() then picks up the prefetched translation unit
+  instead of invoking clang itself. Must be called after
+  precompileHeaders().
+ */
+void ClangCodeParser::prefetchSourceFiles(const QStringList &filePaths)
+{
+#if QT_CONFIG(thread)
+    if (Config::jobs < 2 || filePaths.size() < 2)
+        return;
+
+    const auto flags = static_cast<CXTranslationUnit_Flags>(CXTranslationUnit_Incomplete
+                                                            | CXTranslationUnit_SkipFunctionBodies
+                                                            | CXTranslationUnit_KeepGoing);
+    prefetcher_.reset(new TranslationUnitPrefetcher(Config::jobs, flags));
+    for (const auto &filePath : filePaths) {
+        if (replaysSnapshot() && isSnapshotCurrent(filePath))
+            continue; // Replayed from the snapshot; see parseSourceFile().
+        getSourceArgs(filePath);
+        QVector<QByteArray> args;
+        args.reserve(static_cast<int>(args_.size()));
+        for (const char *arg : args_)
+            args.append(QByteArray(arg));
+        prefetcher_->enqueue(filePath, args);
+    }
+#else
+    Q_UNUSED(filePaths);
+#endif
+}
+
+static const quint32 snapshotMagic = 0x51445353; // "QDSS"
+static const quint32 snapshotVersion = 2;
+
+/*!
+  Returns \c true if the comments of the parsed source files are
+  recorded in the snapshot: in the prepare phase when a snapshot
+  file is given, and in every phase in incremental mode.
+ */
+bool ClangCodeParser::recordsSnapshot() const
+{
+    return !snapshotFile_.isEmpty() && (Generator::preparing() || Generator::incremental());
+}
+
+/*!
+  Returns \c true if unchanged source files are replayed from the
+  snapshot instead of being parsed: in the generate phase when a
+  snapshot file is given, and in every phase in incremental mode.
+ */
+bool ClangCodeParser::replaysSnapshot() const
+{
+    return !snapshotFile_.isEmpty() && (Generator::generating() || Generator::incremental());
+}
+
+/*!
+  Returns a hash of the include paths, the defines, and the path,
+  size and modification time of each header of the module. The
+  nodes that source file comments are tied to are created from
+  the headers, so a snapshot entry recorded with other headers is
+  not replayed.
+ */
+QByteArray ClangCodeParser::headersStamp()
+{
+    if (headersStamp_.isEmpty()) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (const auto &path : qAsConst(includePaths_))
+            hash.addData(path + '\0');
+        for (const auto &define : qAsConst(defines_))
+            hash.addData(define + '\0');
+        QStringList names = allHeaders_.keys();
+        names.sort();
+        for (const auto &name : qAsConst(names)) {
+            const QFileInfo fi(allHeaders_.value(name) + QLatin1Char('/') + name);
+            hash.addData(fi.filePath().toUtf8());
+            hash.addData(QByteArray::number(fi.size()));
+            hash.addData(QByteArray::number(fi.lastModified().toMSecsSinceEpoch()));
+        }
+        headersStamp_ = hash.result();
+    }
+    return headersStamp_;
+}
+
+/*
+  Returns a key that identifies \a node in the primary tree both
+  in the prepare and in the generate phase, where the tree is
+  rebuilt from the same headers.
+ */
+static QString snapshotKey(const Node *node)
+{
+    QString key = QString::number(node->nodeType()) + QLatin1Char(' ') + node->plainFullName();
+    if (node->isFunction()) {
+        const auto *fn = static_cast<const FunctionNode *>(node);
+        key += QLatin1Char('(') + fn->parameters().rawSignature() + QLatin1Char(')');
+        if (fn->isConst())
+            key += QLatin1String(" const");
+        if (fn->isRef())
+            key += QLatin1String(" &");
+        else if (fn->isRefRef())
+            key += QLatin1String(" &&");
+    }
+    return key;
+}
+
 static float getUnpatchedVersion(QString t)
 {
     if (t.count(QChar('.')) > 1)
@@ -1379,33 +1953,60 @@ void ClangCodeParser::parseSourceFile(const Location &/*location*/, const QStrin
      */
     qdb_->clearOpenNamespaces();
     currentFile_ = filePath;
+    if (replaysSnapshot()) {
+        const quint64 nodesBefore = QDocDatabase::nodeCount();
+        const bool replayed = replaySnapshot(filePath);
+        if (QDocDatabase::nodeCount() != nodesBefore)
+            snapshotNodes_.clear();
+        if (replayed) {
+            Timings::increment(Timings::FilesReplayed);
+            return;
+        }
+    }
+
+    /*
+      Parsing the file may create and move nodes, so the snapshot
+      keys looked up by later replays are computed afresh.
+     */
+    snapshotNodes_.clear();
     flags_ = static_cast<CXTranslationUnit_Flags>(CXTranslationUnit_Incomplete | CXTranslationUnit_SkipFunctionBodies | CXTranslationUnit_KeepGoing);
-    index_ = clang_createIndex(1, 0);
 
-    getDefaultArgs();
-    if (!pchName_.isEmpty() && !filePath.endsWith(".mm")) {
-        args_.push_back("-w");
-        args_.push_back("-include-pch");
-        args_.push_back(pchName_.constData());
+    CXTranslationUnit tu = nullptr;
+    CXErrorCode err = CXError_Failure;
+    if (prefetcher_ && prefetcher_->take(filePath, &index_, &tu, &err)) {
+        qCDebug(lcQdoc) << __FUNCTION__ << "prefetched" << filePath << "returns" << err;
+    } else {
+        index_ = clang_createIndex(1, 0);
+        getSourceArgs(filePath);
+        err = clang_parseTranslationUnit2(index_, filePath.toLocal8Bit(), args_.data(),
+                                          static_cast<int>(args_.size()), nullptr, 0, flags_, &tu);
+        qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2("
+            << filePath <<  args_ << ") returns" << err;
     }
-    getMoreArgs();
-    for (const auto &p : qAsConst(moreArgs_))
-        args_.push_back(p.constData());
-
-    CXTranslationUnit tu;
-    CXErrorCode err = clang_parseTranslationUnit2(index_, filePath.toLocal8Bit(), args_.data(),
-                                                  static_cast<int>(args_.size()), nullptr, 0, flags_, &tu);
-    qCDebug(lcQdoc) << __FUNCTION__ << "clang_parseTranslationUnit2("
-        << filePath <<  args_ << ") returns" << err;
     if (err || !tu) {
         qWarning() << "(qdoc) Could not parse source file" << filePath << " error code:" << err;
         clang_disposeIndex(index_);
+        if (recordsSnapshot()) {
+            loadSnapshot();
+            if (snapshot_.remove(filePath))
+                snapshotChanged_ = true;
+        }
         return;
     }
 
+    /*
+      The comments are recorded for the snapshot, unless visiting
+      the translation unit creates nodes, because a later run would
+      not create them when it replays the comments.
+     */
+    const bool recording = recordsSnapshot();
+    SnapshotFile record;
+    const quint64 nodesBefore = QDocDatabase::nodeCount();
+
     CXCursor cur = clang_getTranslationUnitCursor(tu);
     ClangVisitor visitor(qdb_, allHeaders_);
     visitor.visitChildren(cur);
+    const bool replayable = (QDocDatabase::nodeCount() == nodesBefore);
 
     CXToken *tokens;
     unsigned int numTokens = 0;
@@ -1423,6 +2024,19 @@ void ClangCodeParser::parseSourceFile(const Location &/*location*/, const QStrin
         auto end_loc = fromCXSourceLocation(clang_getRangeEnd(clang_getTokenExtent(tu, tokens[i])));
         Doc::trimCStyleComment(loc,comment);
 
+        SnapshotComment *recorded = nullptr;
+        if (recording && replayable) {
+            SnapshotComment c;
+            c.text_ = comment;
+            c.file_ = loc.filePath();
+            c.lineNo_ = loc.lineNo();
+            c.columnNo_ = loc.columnNo();
+            c.endLineNo_ = end_loc.lineNo();
+            c.endColumnNo_ = end_loc.columnNo();
+            record.comments_.append(c);
+            recorded = &record.comments_.last();
+        }
+
         // Doc constructor parses the comment.
         Doc doc(loc, end_loc, comment, commands, topicCommands());
         if (hasTooManyTopics(doc))
@@ -1448,23 +2062,24 @@ void ClangCodeParser::parseSourceFile(const Location &/*location*/, const QStrin
             }
 
             if (n) {
+                if (recorded) {
+                    recorded->nodeKey_ = snapshotKey(n);
+                    if (n->isFunction()) {
+                        const auto *fn = static_cast<const FunctionNode *>(n);
+                        recorded->metaness_ = fn->metaness();
+                        recorded->invokable_ = fn->isInvokable();
+                        recorded->override_ = fn->isOverride();
+                        const Parameters &parameters = fn->parameters();
+                        for (int j = 0; j < parameters.count(); ++j) {
+                            recorded->parameterNames_.append(parameters.at(j).name());
+                            recorded->defaultValues_.append(parameters.at(j).defaultValue());
+                        }
+                    }
+                }
                 nodes.append(n);
                 docs.append(doc);
-            } else if (CodeParser::isWorthWarningAbout(doc)) {
-                bool future = false;
-                if (doc.metaCommandsUsed().contains(COMMAND_SINCE)) {
-                    QString sinceVersion = doc.metaCommandArgs(COMMAND_SINCE)[0].first;
-                    if (getUnpatchedVersion(sinceVersion) > getUnpatchedVersion(version_))
-                        future = true;
-                }
-                if (!future) {
-                    doc.location().warning(tr("Cannot tie this documentation to anything"),
-                                           tr("qdoc found a /*! ... */ comment, but there was no "
-                                              "topic command (e.g., '\\%1', '\\%2') in the "
-                                              "comment and no function definition following "
-                                              "the comment.")
-                                           .arg(COMMAND_FN).arg(COMMAND_PAGE));
-                }
+            } else {
+                warnAboutUntiedDoc(doc);
             }
         } else {
             processTopicArgs(doc, topic, nodes, docs);
@@ -1475,6 +2090,244 @@ void ClangCodeParser::parseSourceFile(const Location &/*location*/, const QStrin
     clang_disposeTokens(tu, tokens, numTokens);
     clang_disposeTranslationUnit(tu);
     clang_disposeIndex(index_);
+
+    if (recording) {
+        loadSnapshot();
+        if (replayable) {
+            QFileInfo fi(filePath);
+            record.size_ = fi.size();
+            record.lastModified_ = fi.lastModified().toMSecsSinceEpoch();
+            record.headersStamp_ = headersStamp();
+            snapshot_.insert(filePath, record);
+        } else {
+            snapshot_.remove(filePath);
+        }
+        snapshotChanged_ = true;
+    }
+}
+
+/*!
+  Warns that the documentation comment \a doc has no topic
+  command and is not followed by a declaration, unless the
+  comment is for a future version.
+ */
+void ClangCodeParser::warnAboutUntiedDoc(const Doc &doc)
+{
+    if (!CodeParser::isWorthWarningAbout(doc))
+        return;
+    if (doc.metaCommandsUsed().contains(COMMAND_SINCE)) {
+        QString sinceVersion = doc.metaCommandArgs(COMMAND_SINCE)[0].first;
+        if (getUnpatchedVersion(sinceVersion) > getUnpatchedVersion(version_))
+            return;
+    }
+    doc.location().warning(tr("Cannot tie this documentation to anything"),
+                           tr("qdoc found a /*! ... */ comment, but there was no "
+                              "topic command (e.g., '\\%1', '\\%2') in the "
+                              "comment and no function definition following "
+                              "the comment.")
+                           .arg(COMMAND_FN).arg(COMMAND_PAGE));
+}
+
+/*!
+  Reads the snapshot file, once per module. A missing
+  or unreadable file leaves the snapshot empty, so every source
+  file is parsed.
+ */
+void ClangCodeParser::loadSnapshot()
+{
+    if (snapshotLoaded_)
+        return;
+    snapshotLoaded_ = true;
+
+    QFile file(snapshotFile_);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_12);
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version;
+    if (magic != snapshotMagic || version != snapshotVersion)
+        return;
+
+    qint32 fileCount = 0;
+    in >> fileCount;
+    for (qint32 i = 0; i < fileCount && in.status() == QDataStream::Ok; ++i) {
+        QString filePath;
+        SnapshotFile record;
+        qint32 commentCount = 0;
+        in >> filePath >> record.size_ >> record.lastModified_ >> record.headersStamp_
+           >> commentCount;
+        for (qint32 j = 0; j < commentCount && in.status() == QDataStream::Ok; ++j) {
+            SnapshotComment c;
+            qint32 lineNo, columnNo, endLineNo, endColumnNo, metaness;
+            in >> c.text_ >> c.file_ >> lineNo >> columnNo >> endLineNo >> endColumnNo
+               >> c.nodeKey_ >> metaness >> c.invokable_ >> c.override_
+               >> c.parameterNames_ >> c.defaultValues_;
+            c.lineNo_ = lineNo;
+            c.columnNo_ = columnNo;
+            c.endLineNo_ = endLineNo;
+            c.endColumnNo_ = endColumnNo;
+            c.metaness_ = metaness;
+            record.comments_.append(c);
+        }
+        snapshot_.insert(filePath, record);
+    }
+    if (in.status() != QDataStream::Ok) {
+        qCDebug(lcQdoc) << "Ignoring corrupt snapshot" << snapshotFile_;
+        snapshot_.clear();
+    }
+}
+
+/*!
+  Writes the recorded comments to the snapshot file. Entries for source files of other projects read
+  from an existing snapshot are kept.
+ */
+void ClangCodeParser::writeSnapshot()
+{
+    if (!snapshotChanged_)
+        return;
+    snapshotChanged_ = false;
+
+    QSaveFile file(snapshotFile_);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(lcQdoc) << "Cannot write snapshot" << snapshotFile_;
+        return;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_12);
+    out << snapshotMagic << snapshotVersion << qint32(snapshot_.size());
+    for (auto it = snapshot_.cbegin(); it != snapshot_.cend(); ++it) {
+        const SnapshotFile &record = it.value();
+        out << it.key() << record.size_ << record.lastModified_ << record.headersStamp_
+            << qint32(record.comments_.size());
+        for (const SnapshotComment &c : record.comments_) {
+            out << c.text_ << c.file_ << qint32(c.lineNo_) << qint32(c.columnNo_)
+                << qint32(c.endLineNo_) << qint32(c.endColumnNo_) << c.nodeKey_
+                << qint32(c.metaness_) << c.invokable_ << c.override_
+                << c.parameterNames_ << c.defaultValues_;
+        }
+    }
+    file.commit();
+}
+
+/*!
+  Returns \c true if the snapshot has an entry for \a filePath
+  and neither the file nor the module's headers have changed
+  since it was recorded.
+ */
+bool ClangCodeParser::isSnapshotCurrent(const QString &filePath)
+{
+    if (snapshotFile_.isEmpty())
+        return false;
+    loadSnapshot();
+    auto it = snapshot_.constFind(filePath);
+    if (it == snapshot_.constEnd())
+        return false;
+    QFileInfo fi(filePath);
+    return fi.size() == it->size_ && fi.lastModified().toMSecsSinceEpoch() == it->lastModified_
+            && it->headersStamp_ == headersStamp();
+}
+
+/*!
+  Processes the documentation comments of the source file
+  \a filePath from the snapshot instead of parsing the file.
+  Comments with topic commands are processed as usual. The other
+  comments are tied to the nodes recorded in the prepare phase.
+
+  Returns \c false, having done nothing, if the snapshot is not
+  current for the file or if one of the recorded nodes cannot be
+  found unambiguously, in which case the file must be parsed.
+ */
+bool ClangCodeParser::replaySnapshot(const QString &filePath)
+{
+    if (!isSnapshotCurrent(filePath))
+        return false;
+    const SnapshotFile &record = snapshot_[filePath];
+
+    QVector<Node *> tiedNodes(record.comments_.size(), nullptr);
+    for (int i = 0; i < record.comments_.size(); ++i) {
+        const QString &key = record.comments_.at(i).nodeKey_;
+        if (key.isEmpty())
+            continue;
+        tiedNodes[i] = findSnapshotNode(key);
+        if (!tiedNodes[i]) {
+            qCDebug(lcQdoc) << "Snapshot node" << key << "not found, parsing" << filePath;
+            return false;
+        }
+    }
+
+    const QSet<QString> &commands = topicCommands() + metaCommands();
+    for (int i = 0; i < record.comments_.size(); ++i) {
+        const SnapshotComment &c = record.comments_.at(i);
+        Location loc(c.file_);
+        loc.setLineNo(c.lineNo_);
+        loc.setColumnNo(c.columnNo_);
+        Location end_loc(c.file_);
+        end_loc.setLineNo(c.endLineNo_);
+        end_loc.setColumnNo(c.endColumnNo_);
+
+        Doc doc(loc, end_loc, c.text_, commands, topicCommands());
+        if (hasTooManyTopics(doc))
+            continue;
+
+        DocList docs;
+        NodeList nodes;
+        const TopicList &topics = doc.topicsUsed();
+        if (topics.isEmpty()) {
+            Node *n = tiedNodes.at(i);
+            if (n) {
+                if (n->isFunction()) {
+                    auto *fn = static_cast<FunctionNode *>(n);
+                    fn->setMetaness(static_cast<FunctionNode::Metaness>(c.metaness_));
+                    fn->setInvokable(c.invokable_);
+                    fn->setOverride(c.override_);
+                    Parameters &parameters = fn->parameters();
+                    const int count = qMin(parameters.count(), c.parameterNames_.size());
+                    for (int j = 0; j < count; ++j) {
+                        parameters[j].setName(c.parameterNames_.at(j));
+                        parameters[j].setDefaultValue(c.defaultValues_.value(j));
+                    }
+                }
+                nodes.append(n);
+                docs.append(doc);
+            } else {
+                warnAboutUntiedDoc(doc);
+            }
+        } else {
+            processTopicArgs(doc, topics[0].topic, nodes, docs);
+        }
+        processMetaCommands(nodes, docs);
+    }
+    return true;
+}
+
+/*!
+  Returns the node of the primary tree with the snapshot \a key,
+  or \c nullptr if there is none or more than one.
+ */
+Node *ClangCodeParser::findSnapshotNode(const QString &key)
+{
+    if (snapshotNodes_.isEmpty()) {
+        QVector<const Aggregate *> stack;
+        stack.append(qdb_->primaryTreeRoot());
+        while (!stack.isEmpty()) {
+            const Aggregate *aggregate = stack.takeLast();
+            for (Node *child : aggregate->childNodes()) {
+                if (child->parent() != aggregate)
+                    continue; // Reparented by \relates; visited under its new parent.
+                const QString key = snapshotKey(child);
+                auto it = snapshotNodes_.find(key);
+                if (it == snapshotNodes_.end())
+                    snapshotNodes_.insert(key, child);
+                else if (*it != child)
+                    *it = nullptr;
+                if (child->isAggregate())
+                    stack.append(static_cast<const Aggregate *>(child));
+            }
+        }
+    }
+    return snapshotNodes_.value(key);
 }
 
 /*!
@@ -42,10 +42,13 @@
 
 #include "cppcodeparser.h"
 
+#include <QtCore/qlockfile.h>
 #include <QtCore/qtemporarydir.h>
 
 QT_BEGIN_NAMESPACE
 
+class TranslationUnitPrefetcher;
+
 class ClangCodeParser : public CppCodeParser
 {
     Q_DECLARE_TR_FUNCTIONS(QDoc::ClangCodeParser)
@@ -62,11 +65,49 @@ public:
     void parseSourceFile(const Location &location, const QString &filePath) override;
     void precompileHeaders() override;
     Node *parseFnArg(const Location &location, const QString &fnArg) override;
+    void prefetchSourceFiles(const QStringList &filePaths);
 
  private:
+    /*
+      A documentation comment found in a source file in the prepare
+      phase, and for comments without a topic command, the node it
+      was tied to and what the definition contributed to that node.
+     */
+    struct SnapshotComment {
+        QString text_;
+        QString file_;
+        int lineNo_ = 0;
+        int columnNo_ = 0;
+        int endLineNo_ = 0;
+        int endColumnNo_ = 0;
+        QString nodeKey_;
+        int metaness_ = 0;
+        bool invokable_ = false;
+        bool override_ = false;
+        QStringList parameterNames_;
+        QStringList defaultValues_;
+    };
+
+    struct SnapshotFile {
+        qint64 size_ = 0;
+        qint64 lastModified_ = 0;
+        QByteArray headersStamp_;
+        QVector<SnapshotComment> comments_;
+    };
+
     void getDefaultArgs();
     bool getMoreArgs();
+    void getSourceArgs(const QString &filePath);
     void buildPCH();
+    void warnAboutUntiedDoc(const Doc &doc);
+    bool recordsSnapshot() const;
+    bool replaysSnapshot() const;
+    QByteArray headersStamp();
+    void loadSnapshot();
+    void writeSnapshot();
+    bool isSnapshotCurrent(const QString &filePath);
+    bool replaySnapshot(const QString &filePath);
+    Node *findSnapshotNode(const QString &key);
 
 private:
     int printParsingErrors_;
@@ -75,9 +116,19 @@ private:
     QVector<QByteArray> includePaths_;
     QScopedPointer<QTemporaryDir> pchFileDir_;
     QByteArray pchName_;
+    QString pchCacheDir_;
+    qint64 pchCacheSize_ = 0;
+    QScopedPointer<QLockFile> pchUseLock_; // held while pchName_ is a cached PCH
     QVector<QByteArray> defines_;
     std::vector<const char *> args_;
     QVector<QByteArray> moreArgs_;
+    QScopedPointer<TranslationUnitPrefetcher> prefetcher_;
+    QString snapshotFile_;
+    QByteArray headersStamp_;
+    bool snapshotLoaded_ = false;
+    bool snapshotChanged_ = false;
+    QHash<QString, SnapshotFile> snapshot_; // source file path->comments
+    QHash<QString, Node *> snapshotNodes_;
 };
 
 QT_END_NAMESPACE
@@ -100,10 +100,41 @@ void CodeMarker::terminate()
     QList<CodeMarker *>::ConstIterator m = markers.constBegin();
     while (m != markers.constEnd()) {
         (*m)->terminateMarker();
+        (*m)->synopses_.clear();
         ++m;
     }
 }
 
+/*!
+  Returns markedUpSynopsis() for \a node, \a relative, and
+  \a style. The marked-up synopsis doesn't depend on the output
+  format, so it is computed once and then shared by all the
+  generators, and by every page that lists the same node in the
+  same style.
+ */
+const QString &CodeMarker::synopsis(const Node *node, const Node *relative, Section::Style style)
+{
+    const SynopsisKey key { node, relative, int(style) };
+    auto it = synopses_.find(key);
+    if (it == synopses_.end())
+        it = synopses_.insert(key, markedUpSynopsis(node, relative, style));
+    return it.value();
+}
+
+/*!
+  Returns markedUpQmlItem() for \a node and \a summary, computed
+  once like synopsis().
+ */
+const QString &CodeMarker::qmlItem(const Node *node, bool summary)
+{
+    // Styles are non-negative; QML items use negative keys.
+    const SynopsisKey key { node, nullptr, summary ? -2 : -1 };
+    auto it = synopses_.find(key);
+    if (it == synopses_.end())
+        it = synopses_.insert(key, markedUpQmlItem(node, summary));
+    return it.value();
+}
+
 CodeMarker *CodeMarker::markerForCode(const QString &code)
 {
     CodeMarker *defaultMarker = markerForLanguage(defaultLang);
@@ -176,36 +207,31 @@ static const QString squot = QLatin1String("&quot;");
 
 QString CodeMarker::protect(const QString &str)
 {
-    int n = str.length();
     QString marked;
-    marked.reserve(n * 2 + 30);
-    const QChar *data = str.constData();
-    for (int i = 0; i != n; ++i) {
-        switch (data[i].unicode()) {
-        case '&': marked += samp;  break;
-        case '<': marked += slt;   break;
-        case '>': marked += sgt;   break;
-        case '"': marked += squot; break;
-        default : marked += data[i];
-        }
-    }
+    marked.reserve(str.size() + str.size() / 4 + 16);
+    appendProtectedString(&marked, QStringRef(&str));
     return marked;
 }
 
 void CodeMarker::appendProtectedString(QString *output, const QStringRef &str)
 {
     int n = str.length();
-    output->reserve(output->size() + n * 2 + 30);
     const QChar *data = str.constData();
+    int start = 0;
     for (int i = 0; i != n; ++i) {
+        const QString *entity = nullptr;
         switch (data[i].unicode()) {
-        case '&': *output += samp;  break;
-        case '<': *output += slt;   break;
-        case '>': *output += sgt;   break;
-        case '"': *output += squot; break;
-        default : *output += data[i];
+        case '&': entity = &samp;  break;
+        case '<': entity = &slt;   break;
+        case '>': entity = &sgt;   break;
+        case '"': entity = &squot; break;
+        default : continue;
         }
+        output->append(data + start, i - start);
+        *output += *entity;
+        start = i + 1;
     }
+    output->append(data + start, n - start);
 }
 
 QString CodeMarker::typified(const QString &string, bool trailingSpace)
@@ -32,6 +32,8 @@
 #include "atom.h"
 #include "sections.h"
 
+#include <QtCore/qhash.h>
+
 QT_BEGIN_NAMESPACE
 
 class Config;
@@ -74,6 +76,8 @@ public:
     static QString stringForNode(const Node *node);
 
     QString typified(const QString &string, bool trailingSpace = false);
+    const QString &synopsis(const Node *node, const Node *relative, Section::Style style);
+    const QString &qmlItem(const Node *node, bool summary);
 
 protected:
     static QString protect(const QString &string);
@@ -83,8 +87,23 @@ protected:
     QString linkTag(const Node *node, const QString &body);
 
 private:
+    struct SynopsisKey
+    {
+        const Node *node_;
+        const Node *relative_;
+        int style_;
+        bool operator==(const SynopsisKey &other) const {
+            return node_ == other.node_ && relative_ == other.relative_ && style_ == other.style_;
+        }
+    };
+    friend uint qHash(const SynopsisKey &key, uint seed) {
+        return qHash(key.node_, seed) ^ qHash(key.relative_, seed) ^ uint(key.style_);
+    }
+
     QString macName(const Node *parent, const QString &name = QString());
 
+    QHash<SynopsisKey, QString> synopses_;
+
     static QString defaultLang;
     static QList<CodeMarker *> markers;
 };
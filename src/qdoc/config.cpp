@@ -32,6 +32,7 @@
 
 #include "config.h"
 #include "generator.h"
+#include "timings.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
@@ -40,6 +41,8 @@
 #include <QtCore/qtextstream.h>
 #include <QtCore/qvariant.h>
 
+#include <algorithm>
+
 #include <stdlib.h>
 
 QT_BEGIN_NAMESPACE
@@ -93,6 +96,8 @@ QString ConfigStrings::OUTPUTENCODING = QStringLiteral("outputencoding");
 QString ConfigStrings::OUTPUTFORMATS = QStringLiteral("outputformats");
 QString ConfigStrings::OUTPUTPREFIXES = QStringLiteral("outputprefixes");
 QString ConfigStrings::OUTPUTSUFFIXES = QStringLiteral("outputsuffixes");
+QString ConfigStrings::PCHCACHE = QStringLiteral("pchcache");
+QString ConfigStrings::PCHCACHESIZE = QStringLiteral("pchcachesize");
 QString ConfigStrings::PROJECT = QStringLiteral("project");
 QString ConfigStrings::REDIRECTDOCUMENTATIONTODEVNULL = QStringLiteral("redirectdocumentationtodevnull");
 QString ConfigStrings::QHP = QStringLiteral("qhp");
@@ -246,10 +251,15 @@ bool Config::generateExamples = true;
 QString Config::overrideOutputDir;
 QString Config::installDir;
 QSet<QString> Config::overrideOutputFormats;
+int Config::jobs = 1;
+QString Config::snapshotFile;
+QString Config::pchCacheDir;
 QMap<QString, QString> Config::extractedDirs;
 int Config::numInstances;
 QStack<QString> Config::workingDirs_;
 QMap<QString, QStringList> Config::includeFilesMap_;
+QHash<QString, Config::DirectoryEntries> Config::directoryCache_;
+QVector<Config::FileNameIndex> Config::fileNameIndexes_;
 
 /*!
   \class Config
@@ -275,6 +285,7 @@ Config::Config(const QString &programName, const QStringList &args)
 Config::~Config()
 {
     clear();
+    clearDirectoryCache();
 }
 
 /*!
@@ -389,6 +400,9 @@ void Config::processCommandLineOptions(const QStringList &args)
 
     debug_ = m_parser.isSet(m_parser.debugOption);
 
+    if (m_parser.isSet(m_parser.jobsOption))
+        jobs = qMax(1, m_parser.value(m_parser.jobsOption).toInt());
+
     // TODO: Make Generator use Config instead of storing these separately
     if (m_parser.isSet(m_parser.prepareOption))
         Generator::setQDocPass(Generator::Prepare);
@@ -402,6 +416,14 @@ void Config::processCommandLineOptions(const QStringList &args)
         Location::startLoggingProgress();
     if (m_parser.isSet(m_parser.timestampsOption))
         Generator::setUseTimestamps();
+    if (m_parser.isSet(m_parser.incrementalOption))
+        Generator::setIncremental();
+    if (m_parser.isSet(m_parser.timingsOption))
+        Timings::setReportFile(QDir::current().absoluteFilePath(m_parser.value(m_parser.timingsOption)));
+    if (m_parser.isSet(m_parser.snapshotOption))
+        snapshotFile = QDir::current().absoluteFilePath(m_parser.value(m_parser.snapshotOption));
+    if (m_parser.isSet(m_parser.pchCacheOption))
+        pchCacheDir = QDir::current().absoluteFilePath(m_parser.value(m_parser.pchCacheOption));
 }
 
 void Config::setIncludePaths()
@@ -844,16 +866,19 @@ QString Config::findFile(const Location &location,
     QStringList components = fileName.split(QLatin1Char('?'));
     QString firstComponent = components.first();
 
-    QStringList::ConstIterator f = files.constBegin();
-    while (f != files.constEnd()) {
-        if (*f == firstComponent ||
-                (*f).endsWith(QLatin1Char('/') + firstComponent)) {
-            fileInfo.setFile(*f);
-            if (!fileInfo.exists())
-                location.fatal(tr("File '%1' does not exist").arg(*f));
-            break;
+    if (!files.isEmpty()) {
+        const FileNameIndex &index = fileNameIndex(files);
+        const QString baseName = firstComponent.mid(firstComponent.lastIndexOf(QLatin1Char('/')) + 1);
+        const QVector<int> positions = index.positions_.value(baseName);
+        for (int i : positions) {
+            const QString &f = files.at(i);
+            if (f == firstComponent || f.endsWith(QLatin1Char('/') + firstComponent)) {
+                fileInfo.setFile(f);
+                if (!fileInfo.exists())
+                    location.fatal(tr("File '%1' does not exist").arg(f));
+                break;
+            }
         }
-        ++f;
     }
 
     if (fileInfo.fileName().isEmpty()) {
@@ -1303,45 +1328,174 @@ bool Config::isFileExcluded(const QString &fileName, const QSet<QString> &exclud
     return excludedFiles.contains(fileName);
 }
 
+/*!
+  Returns the files below \a uncleanDir whose names match one of
+  the space-separated wildcards in \a nameFilter, sorted by name
+  within each directory. Directories are read only once for each
+  qdocconf file, until clearDirectoryCache() is called, so later
+  calls for the same tree, even with a different filter, do not
+  touch the file system again. If each wildcard is a suffix such
+  as \c{*.qdoc}, the files are looked up by suffix.
+ */
 QStringList Config::getFilesHere(const QString &uncleanDir,
                                  const QString &nameFilter,
                                  const Location &location,
                                  const QSet<QString> &excludedDirs,
                                  const QSet<QString> &excludedFiles)
 {
-    QString dir = location.isEmpty() ? QDir::cleanPath(uncleanDir) : QDir(uncleanDir).canonicalPath();
+    QVector<QRegExp> nameFilters;
+    QStringList suffixes;
+    bool suffixesOnly = true;
+    const QStringList filters = nameFilter.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    for (const QString &filter : filters) {
+        nameFilters.append(QRegExp(filter, Qt::CaseInsensitive, QRegExp::Wildcard));
+        const QString suffix = filter.mid(2);
+        if (filter.startsWith(QLatin1String("*.")) && !suffix.contains(QLatin1Char('*'))
+            && !suffix.contains(QLatin1Char('?')) && !suffix.contains(QLatin1Char('['))) {
+            suffixes.append(suffix.toLower());
+        } else {
+            suffixesOnly = false;
+        }
+    }
+    if (!suffixesOnly)
+        suffixes.clear();
+
+    bool canonical = !location.isEmpty();
+    QString dir = canonical ? QDir(uncleanDir).canonicalPath() : QDir::cleanPath(uncleanDir);
     QStringList result;
+    collectFiles(dir, nameFilters, suffixes, canonical, excludedDirs, excludedFiles, result);
+    return result;
+}
+
+/*!
+  Appends the files below \a dir that match one of \a nameFilters
+  to \a result. If \a suffixes is not empty, it holds the suffixes
+  that the filters match, and the files are looked up by them.
+ */
+void Config::collectFiles(const QString &dir,
+                          const QVector<QRegExp> &nameFilters,
+                          const QStringList &suffixes,
+                          bool canonical,
+                          const QSet<QString> &excludedDirs,
+                          const QSet<QString> &excludedFiles,
+                          QStringList &result)
+{
     if (excludedDirs.contains(dir))
-        return result;
+        return;
+
+    // Copied, since the recursion below may rehash the cache.
+    const DirectoryEntries entries = directoryEntries(dir);
+    auto addFile = [&](int i) {
+        const QString &filePath = entries.filePaths_.at(i);
+        if (!entries.fileNames_.at(i).startsWith(QLatin1Char('~'))
+            && !isFileExcluded(filePath, excludedFiles)) {
+            result.append(filePath);
+        }
+    };
+    if (!suffixes.isEmpty()) {
+        QVector<int> positions;
+        for (const QString &suffix : suffixes)
+            positions += entries.suffixPositions_.value(suffix);
+        // Keep the order by name; a file may match more than one suffix.
+        std::sort(positions.begin(), positions.end());
+        positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+        for (int i : qAsConst(positions))
+            addFile(i);
+    } else {
+        for (int i = 0; i < entries.fileNames_.size(); ++i) {
+            for (const QRegExp &filter : nameFilters) {
+                if (filter.exactMatch(entries.fileNames_.at(i))) {
+                    addFile(i);
+                    break;
+                }
+            }
+        }
+    }
 
-    QDir dirInfo(dir);
-    QStringList fileNames;
-    QStringList::const_iterator fn;
-
-    dirInfo.setNameFilters(nameFilter.split(QLatin1Char(' ')));
-    dirInfo.setSorting(QDir::Name);
-    dirInfo.setFilter(QDir::Files);
-    fileNames = dirInfo.entryList();
-    fn = fileNames.constBegin();
-    while (fn != fileNames.constEnd()) {
-        if (!fn->startsWith(QLatin1Char('~'))) {
-            QString s = dirInfo.filePath(*fn);
-            QString c = QDir::cleanPath(s);
-            if (!isFileExcluded(c, excludedFiles))
-                result.append(c);
+    const QStringList &subDirs = canonical ? entries.canonicalSubDirs_ : entries.subDirs_;
+    for (const QString &subDir : subDirs)
+        collectFiles(subDir, nameFilters, suffixes, canonical, excludedDirs, excludedFiles, result);
+}
+
+/*!
+  Reads the directory \a dir, or returns the cached result of
+  reading it earlier. Each directory costs a single listing.
+ */
+const Config::DirectoryEntries &Config::directoryEntries(const QString &dir)
+{
+    auto it = directoryCache_.find(dir);
+    if (it != directoryCache_.end())
+        return *it;
+
+    DirectoryEntries entries;
+    const QFileInfoList infos = QDir(dir).entryInfoList(QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot,
+                                                        QDir::Name);
+    for (const QFileInfo &info : infos) {
+        const QString path = QDir::cleanPath(info.filePath());
+        if (info.isDir()) {
+            entries.subDirs_.append(path);
+            entries.canonicalSubDirs_.append(info.isSymLink() ? info.canonicalFilePath() : path);
+        } else {
+            const QString fileName = info.fileName();
+            const QString lowerName = fileName.toLower();
+            for (int dot = lowerName.indexOf(QLatin1Char('.')); dot != -1;
+                 dot = lowerName.indexOf(QLatin1Char('.'), dot + 1)) {
+                entries.suffixPositions_[lowerName.mid(dot + 1)].append(entries.fileNames_.size());
+            }
+            entries.fileNames_.append(fileName);
+            entries.filePaths_.append(path);
         }
-        ++fn;
+    }
+    return *directoryCache_.insert(dir, entries);
+}
+
+/*!
+  Returns an index of the base names in \a files. The indexes of
+  the few most recently used lists are kept. A list is recognized
+  by sharing its data with the indexed one, which is the usual
+  case since the lists are implicitly shared, or else by its hash;
+  the lists are only compared in full when their hashes match.
+ */
+const Config::FileNameIndex &Config::fileNameIndex(const QStringList &files)
+{
+    int found = -1;
+    for (int i = 0; i < fileNameIndexes_.size() && found == -1; ++i) {
+        if (fileNameIndexes_.at(i).files_.isSharedWith(files))
+            found = i;
+    }
+    const uint hash = (found == -1) ? qHash(files) : 0;
+    for (int i = 0; i < fileNameIndexes_.size() && found == -1; ++i) {
+        const FileNameIndex &index = fileNameIndexes_.at(i);
+        if (index.hash_ == hash && index.files_ == files)
+            found = i;
+    }
+    if (found != -1) {
+        if (found > 0)
+            fileNameIndexes_.move(found, 0);
+        return fileNameIndexes_.first();
     }
 
-    dirInfo.setNameFilters(QStringList(QLatin1String("*")));
-    dirInfo.setFilter(QDir::Dirs|QDir::NoDotAndDotDot);
-    fileNames = dirInfo.entryList();
-    fn = fileNames.constBegin();
-    while (fn != fileNames.constEnd()) {
-        result += getFilesHere(dirInfo.filePath(*fn), nameFilter, location, excludedDirs, excludedFiles);
-        ++fn;
+    FileNameIndex index;
+    index.files_ = files;
+    index.hash_ = hash;
+    for (int i = 0; i < files.size(); ++i) {
+        const QString &f = files.at(i);
+        index.positions_[f.mid(f.lastIndexOf(QLatin1Char('/')) + 1)].append(i);
     }
-    return result;
+    if (fileNameIndexes_.size() == 4)
+        fileNameIndexes_.removeLast();
+    fileNameIndexes_.prepend(index);
+    return fileNameIndexes_.first();
+}
+
+/*!
+  Forgets all directory listings and file name indexes, so that
+  the next lookups see the current state of the file system.
+ */
+void Config::clearDirectoryCache()
+{
+    directoryCache_.clear();
+    fileNameIndexes_.clear();
 }
 
 /*!
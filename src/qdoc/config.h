@@ -36,11 +36,14 @@
 #include "location.h"
 #include "qdoccommandlineparser.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qpair.h>
+#include <QtCore/qregexp.h>
 #include <QtCore/qset.h>
 #include <QtCore/qstack.h>
 #include <QtCore/qstringlist.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -137,6 +140,7 @@ public:
     static bool removeDirContents(const QString &dir);
     static void pushWorkingDir(const QString &dir);
     static QString popWorkingDir();
+    static void clearDirectoryCache();
 
     static const QString dot;
 
@@ -144,8 +148,12 @@ public:
     static QString installDir;
     static QString overrideOutputDir;
     static QSet<QString> overrideOutputFormats;
+    static int jobs;
+    static QString snapshotFile;
+    static QString pchCacheDir;
 
     inline bool singleExec() const;
+    bool batch() const { return m_parser.isSet(m_parser.batchOption); }
     QStringList &defines() { return m_defines; }
     QStringList &dependModules() { return m_dependModules; }
     QStringList &includePaths() { return m_includePaths; }
@@ -156,6 +164,41 @@ public:
     void setPreviousCurrentDir(const QString &path) { m_previousCurrentDir = path; }
 
 private:
+    /*
+      The result of reading one directory. Subdirectories are
+      listed both as clean paths and as canonical paths; the two
+      only differ for symbolic links. The files are also indexed
+      by each of their lowercase suffixes, "gz" and "tar.gz" for
+      "a.tar.gz", so a filter like "*.qdoc" needs no matching.
+     */
+    struct DirectoryEntries {
+        QStringList fileNames_;
+        QStringList filePaths_;
+        QStringList subDirs_;
+        QStringList canonicalSubDirs_;
+        QHash<QString, QVector<int> > suffixPositions_;
+    };
+
+    /*
+      Maps the base names of the paths in a file list to their
+      positions in the list, so findFile() need not scan it.
+     */
+    struct FileNameIndex {
+        QStringList files_;
+        uint hash_;
+        QHash<QString, QVector<int> > positions_;
+    };
+
+    static const DirectoryEntries &directoryEntries(const QString &dir);
+    static void collectFiles(const QString &dir,
+                             const QVector<QRegExp> &nameFilters,
+                             const QStringList &suffixes,
+                             bool canonical,
+                             const QSet<QString> &excludedDirs,
+                             const QSet<QString> &excludedFiles,
+                             QStringList &result);
+    static const FileNameIndex &fileNameIndex(const QStringList &files);
+
     void processCommandLineOptions(const QStringList &args);
     void setIncludePaths();
     void setIndexDirs();
@@ -181,6 +224,8 @@ private:
     static int numInstances;
     static QStack<QString> workingDirs_;
     static QMap<QString, QStringList> includeFilesMap_;
+    static QHash<QString, DirectoryEntries> directoryCache_;
+    static QVector<FileNameIndex> fileNameIndexes_;
     QDocCommandLineParser m_parser;
 };
 
@@ -235,6 +280,8 @@ struct ConfigStrings
     static QString OUTPUTFORMATS;
     static QString OUTPUTPREFIXES;
     static QString OUTPUTSUFFIXES;
+    static QString PCHCACHE;
+    static QString PCHCACHESIZE;
     static QString PROJECT;
     static QString REDIRECTDOCUMENTATIONTODEVNULL;
     static QString QHP;
@@ -316,6 +363,8 @@ struct ConfigStrings
 #define CONFIG_OUTPUTFORMATS ConfigStrings::OUTPUTFORMATS
 #define CONFIG_OUTPUTPREFIXES ConfigStrings::OUTPUTPREFIXES
 #define CONFIG_OUTPUTSUFFIXES ConfigStrings::OUTPUTSUFFIXES
+#define CONFIG_PCHCACHE ConfigStrings::PCHCACHE
+#define CONFIG_PCHCACHESIZE ConfigStrings::PCHCACHESIZE
 #define CONFIG_PROJECT ConfigStrings::PROJECT
 #define CONFIG_REDIRECTDOCUMENTATIONTODEVNULL ConfigStrings::REDIRECTDOCUMENTATIONTODEVNULL
 #define CONFIG_QHP ConfigStrings::QHP
@@ -33,6 +33,7 @@
 #include "cppcodemarker.h"
 
 #include "generator.h"
+#include "scanners.h"
 #include "text.h"
 #include "tree.h"
 
@@ -519,9 +520,6 @@ QString CppCodeMarker::addMarkUp(const QString &in,
     int start = 0;
     int finish = 0;
     QChar ch;
-    QRegExp classRegExp("Qt?(?:[A-Z3]+[a-z][A-Za-z]*|t)");
-    QRegExp functionRegExp("q([A-Z][a-z]+)+");
-    QRegExp findFunctionRegExp(QStringLiteral("^\\s*\\("));
 
     readChar();
 
@@ -537,9 +535,9 @@ QString CppCodeMarker::addMarkUp(const QString &in,
                 readChar();
             } while (ch.isLetterOrNumber() || ch == '_');
 
-            if (classRegExp.exactMatch(ident)) {
+            if (Scanners::isQtClassName(ident)) {
                 tag = QStringLiteral("type");
-            } else if (functionRegExp.exactMatch(ident)) {
+            } else if (Scanners::isQtFunctionName(ident)) {
                 tag = QStringLiteral("func");
                 target = true;
             } else if (types.contains(ident)) {
@@ -547,8 +545,6 @@ QString CppCodeMarker::addMarkUp(const QString &in,
             } else if (keywords.contains(ident)) {
                 tag = QStringLiteral("keyword");
             } else if (braceDepth == 0 && parenDepth == 0) {
-                if (code.indexOf(findFunctionRegExp, i - 1) == i - 1)
-                    tag = QStringLiteral("func");
                 target = true;
             }
         } else if (ch.isDigit()) {
@@ -416,6 +416,55 @@ bool DocPrivate::isEnumDocSimplifiable() const
     return true;
 }
 
+/*
+  A qdoc include file as read from disk. The lines starting with
+  "//!" are located once, and the text between a pair of them is
+  extracted the first time an identifier is requested and kept,
+  so an include file shared by many comments is read and split
+  only once.
+ */
+struct IncludeFile
+{
+    QString text_;
+    QStringList lines_;
+    QVector<int> markers_;
+    QHash<QString, QString> segments_;
+
+    QString segment(const QString &identifier);
+};
+
+/*
+  Returns the lines between the first two "//!" lines that contain
+  \a identifier, leaving out any other "//!" lines. Returns a null
+  string if no such line exists.
+ */
+QString IncludeFile::segment(const QString &identifier)
+{
+    auto it = segments_.constFind(identifier);
+    if (it != segments_.constEnd())
+        return *it;
+
+    QString result;
+    int m = 0;
+    while (m < markers_.size() && !lines_.at(markers_.at(m)).contains(identifier))
+        ++m;
+    if (m < markers_.size()) {
+        result = QLatin1String("");
+        int next = m + 1;
+        for (int i = markers_.at(m) + 1; i < lines_.size(); ++i) {
+            if (next < markers_.size() && markers_.at(next) == i) {
+                if (lines_.at(i).contains(identifier))
+                    break;
+                ++next;
+            } else {
+                result += lines_.at(i) + QLatin1Char('\n');
+            }
+        }
+    }
+    segments_.insert(identifier, result);
+    return result;
+}
+
 class DocParser
 {
     Q_DECLARE_TR_FUNCTIONS(QDoc::DocParser)
@@ -440,6 +489,7 @@ public:
     static QStringList sourceFiles;
     static QStringList sourceDirs;
     static bool quoting;
+    static QHash<QString, IncludeFile> includeFiles;
 
 private:
     Location &location();
@@ -536,6 +586,7 @@ QStringList DocParser::exampleDirs;
 QStringList DocParser::sourceFiles;
 QStringList DocParser::sourceDirs;
 bool DocParser::quoting = false;
+QHash<QString, IncludeFile> DocParser::includeFiles;
 
 /*!
   Parse the \a source string to build a Text data structure
@@ -1691,67 +1742,52 @@ void DocParser::include(const QString &fileName, const QString &identifier)
         location().warning(tr("Cannot find qdoc include file '%1'").arg(fileName));
     }
     else {
-        QFile inFile(filePath);
-        if (!inFile.open(QFile::ReadOnly)) {
-            location().warning(tr("Cannot open qdoc include file '%1'")
-                               .arg(userFriendlyFilePath));
-        }
-        else {
-            location().push(userFriendlyFilePath);
-
+        auto file = includeFiles.find(filePath);
+        if (file == includeFiles.end()) {
+            QFile inFile(filePath);
+            if (!inFile.open(QFile::ReadOnly)) {
+                location().warning(tr("Cannot open qdoc include file '%1'")
+                                   .arg(userFriendlyFilePath));
+                return;
+            }
             QTextStream inStream(&inFile);
-            QString includedStuff = inStream.readAll();
+            IncludeFile includeFile;
+            includeFile.text_ = inStream.readAll();
             inFile.close();
+            includeFile.lines_ = includeFile.text_.split(QLatin1Char('\n'));
+            for (int i = 0; i < includeFile.lines_.size(); ++i) {
+                if (includeFile.lines_.at(i).startsWith(QLatin1String("//!")))
+                    includeFile.markers_.append(i);
+            }
+            file = includeFiles.insert(filePath, includeFile);
+        }
 
-            if (identifier.isEmpty()) {
-                input_.insert(pos, includedStuff);
-                len = input_.length();
-                openedInputs.push(pos + includedStuff.length());
+        location().push(userFriendlyFilePath);
+
+        if (identifier.isEmpty()) {
+            const QString &includedStuff = file->text_;
+            input_.insert(pos, includedStuff);
+            len = input_.length();
+            openedInputs.push(pos + includedStuff.length());
+        }
+        else {
+            QString result = file->segment(identifier);
+            if (result.isNull()) {
+                location().warning(tr("Cannot find '%1' in '%2'")
+                                   .arg(identifier)
+                                   .arg(userFriendlyFilePath));
+                return;
+
+            }
+            if (result.isEmpty()) {
+                location().warning(tr("Empty qdoc snippet '%1' in '%2'")
+                                   .arg(identifier)
+                                   .arg(userFriendlyFilePath));
             }
             else {
-                QStringList lineBuffer = includedStuff.split(QLatin1Char('\n'));
-                int i = 0;
-                int startLine = -1;
-                while (i < lineBuffer.size()) {
-                    if (lineBuffer[i].startsWith("//!")) {
-                        if (lineBuffer[i].contains(identifier)) {
-                            startLine = i+1;
-                            break;
-                        }
-                    }
-                    ++i;
-                }
-                if (startLine < 0) {
-                    location().warning(tr("Cannot find '%1' in '%2'")
-                                       .arg(identifier)
-                                       .arg(userFriendlyFilePath));
-                    return;
-
-                }
-                QString result;
-                i = startLine;
-                do {
-                    if (lineBuffer[i].startsWith("//!")) {
-                        if (i<lineBuffer.size()) {
-                            if (lineBuffer[i].contains(identifier)) {
-                                break;
-                            }
-                        }
-                    }
-                    else
-                        result += lineBuffer[i] + QLatin1Char('\n');
-                    ++i;
-                } while (i < lineBuffer.size());
-                if (result.isEmpty()) {
-                    location().warning(tr("Empty qdoc snippet '%1' in '%2'")
-                                       .arg(identifier)
-                                       .arg(userFriendlyFilePath));
-                }
-                else {
-                    input_.insert(pos, result);
-                    len = input_.length();
-                    openedInputs.push(pos + result.length());
-                }
+                input_.insert(pos, result);
+                len = input_.length();
+                openedInputs.push(pos + result.length());
             }
         }
     }
@@ -3250,6 +3286,8 @@ void Doc::terminate()
     DocParser::exampleDirs.clear();
     DocParser::sourceFiles.clear();
     DocParser::sourceDirs.clear();
+    DocParser::includeFiles.clear();
+    Quoter::clearCache();
     aliasMap()->clear();
     cmdHash()->clear();
     macroHash()->clear();
@@ -3329,6 +3367,11 @@ CodeMarker *Doc::quoteFromFile(const Location &location,
 
     QString userFriendlyFilePath;
     const QString filePath = resolveFile(location, fileName, &userFriendlyFilePath);
+    CodeMarker *marker = CodeMarker::markerForFileName(fileName);
+    if (!filePath.isEmpty() && quoter.quoteFromCachedFile(filePath, userFriendlyFilePath, marker))
+        return marker;
+
+    bool loaded = false;
     if (filePath.isEmpty()) {
         QString details = QLatin1String("Example directories: ") + DocParser::exampleDirs.join(QLatin1Char(' '));
         if (!DocParser::exampleFiles.isEmpty())
@@ -3343,12 +3386,13 @@ CodeMarker *Doc::quoteFromFile(const Location &location,
         else {
             QTextStream inStream(&inFile);
             code = DocParser::untabifyEtc(inStream.readAll());
+            loaded = true;
         }
     }
 
-    QString dirPath = QFileInfo(filePath).path();
-    CodeMarker *marker = CodeMarker::markerForFileName(fileName);
     quoter.quoteFromFile(userFriendlyFilePath, code, marker->markedUpCode(code, nullptr, location));
+    if (loaded)
+        quoter.cacheFile(filePath, userFriendlyFilePath, marker);
     return marker;
 }
 
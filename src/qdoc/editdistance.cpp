@@ -32,6 +32,10 @@
 
 #include "editdistance.h"
 
+#include <QtCore/qvarlengtharray.h>
+
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 int editDistance(const QString &s, const QString &t)
@@ -96,4 +100,126 @@ QString nearestName(const QString &actual, const QSet<QString> &candidates)
     return QString();
 }
 
+/*!
+  \class NearestNameIndex
+  \internal
+
+  A BK-tree of names, which finds the names that are within a
+  small edit distance of a misspelled name without comparing it
+  to every name in the index. Each entry keeps its children by
+  their distance to it, and by the triangle inequality, only the
+  children whose distance differs from the distance to the query
+  by at most the tolerance can hold a match.
+
+  Names are compared in lower case, so a name that only differs
+  in case is found at distance 0.
+ */
+
+/*!
+  Returns the Levenshtein distance between \a s and \a t. Unlike
+  editDistance(), this keeps only two rows of the matrix, on the
+  stack for names of ordinary length.
+ */
+static int rowDistance(const QString &s, const QString &t)
+{
+    const int m = s.length();
+    const int n = t.length();
+    if (m == 0)
+        return n;
+    if (n == 0)
+        return m;
+    QVarLengthArray<int, 256> rows(2 * (n + 1));
+    int *previous = rows.data();
+    int *current = previous + n + 1;
+    for (int j = 0; j <= n; ++j)
+        previous[j] = j;
+    const QChar *sd = s.constData();
+    const QChar *td = t.constData();
+    for (int i = 1; i <= m; ++i) {
+        current[0] = i;
+        for (int j = 1; j <= n; ++j) {
+            if (sd[i - 1] == td[j - 1])
+                current[j] = previous[j - 1];
+            else
+                current[j] = 1 + qMin(qMin(previous[j], previous[j - 1]), current[j - 1]);
+        }
+        std::swap(previous, current);
+    }
+    return previous[n];
+}
+
+/*!
+  Adds \a name to the index, unless a name that only differs
+  from it in case is already there.
+ */
+void NearestNameIndex::insert(const QString &name)
+{
+    const QString key = name.toLower();
+    if (key.isEmpty() || keys_.contains(key))
+        return;
+    keys_.insert(key);
+
+    const int index = entries_.size();
+    if (index > 0) {
+        int i = 0;
+        for (;;) {
+            const int distance = rowDistance(key, entries_.at(i).key_);
+            int next = -1;
+            for (const auto &child : entries_.at(i).children_) {
+                if (child.first == distance) {
+                    next = child.second;
+                    break;
+                }
+            }
+            if (next == -1) {
+                entries_[i].children_.append(qMakePair(distance, index));
+                break;
+            }
+            i = next;
+        }
+    }
+    entries_.append(Entry { key, name, QVector<QPair<int, int> >() });
+}
+
+/*!
+  Returns up to \a maxCount names from the index that are close
+  to \a actual, closest first. The tolerance grows with the length
+  of \a actual: one edit for short names, two for names of up to
+  eleven characters and three for longer ones. \a actual itself
+  is never returned.
+ */
+QStringList NearestNameIndex::nearest(const QString &actual, int maxCount) const
+{
+    QStringList names;
+    const QString key = actual.toLower();
+    if (key.isEmpty() || entries_.isEmpty())
+        return names;
+    const int tolerance = key.length() < 5 ? 1 : (key.length() < 12 ? 2 : 3);
+
+    QVector<QPair<int, int> > matches; // distance, index of the entry
+    QVarLengthArray<int, 64> stack;
+    stack.append(0);
+    while (!stack.isEmpty()) {
+        const Entry &entry = entries_.at(stack.last());
+        stack.removeLast();
+        const int distance = rowDistance(key, entry.key_);
+        if (distance <= tolerance && entry.name_ != actual)
+            matches.append(qMakePair(distance, int(&entry - entries_.constData())));
+        for (const auto &child : entry.children_) {
+            if (child.first >= distance - tolerance && child.first <= distance + tolerance)
+                stack.append(child.second);
+        }
+    }
+
+    std::sort(matches.begin(), matches.end(),
+              [this](const QPair<int, int> &a, const QPair<int, int> &b) {
+        if (a.first != b.first)
+            return a.first < b.first;
+        return entries_.at(a.second).name_ < entries_.at(b.second).name_;
+    });
+    for (int i = 0; i < matches.size() && i < maxCount; ++i)
+        names.append(entries_.at(matches.at(i).second).name_);
+    return names;
+}
+
 QT_END_NAMESPACE
@@ -33,14 +33,37 @@
 #ifndef EDITDISTANCE_H
 #define EDITDISTANCE_H
 
+#include <QtCore/qpair.h>
 #include <QtCore/qset.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 
 int editDistance(const QString &s, const QString &t);
 QString nearestName(const QString &actual, const QSet<QString> &candidates);
 
+class NearestNameIndex
+{
+public:
+    void insert(const QString &name);
+    QStringList nearest(const QString &actual, int maxCount = 3) const;
+    bool isEmpty() const { return entries_.isEmpty(); }
+    int size() const { return entries_.size(); }
+    void clear() { entries_.clear(); keys_.clear(); }
+
+private:
+    struct Entry
+    {
+        QString key_;
+        QString name_;
+        QVector<QPair<int, int> > children_; // distance, index of the child entry
+    };
+    QVector<Entry> entries_;
+    QSet<QString> keys_;
+};
+
 QT_END_NAMESPACE
 
 #endif
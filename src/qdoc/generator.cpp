@@ -40,10 +40,18 @@
 #include "qdocdatabase.h"
 #include "quoter.h"
 #include "separator.h"
+#include "timings.h"
 #include "tokenizer.h"
 
+#include <QtCore/qbuffer.h>
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
+#if QT_CONFIG(thread)
+#  include <QtCore/qmutex.h>
+#  include <QtCore/qthreadpool.h>
+#  include <QtCore/qwaitcondition.h>
+#endif
 
 #ifndef QT_BOOTSTRAPPED
 #  include "QtCore/qurl.h"
@@ -79,6 +87,9 @@ bool Generator::qdocSingleExec_ = false;
 bool Generator::qdocWriteQaPages_ = false;
 bool Generator::useOutputSubdirs_ = true;
 bool Generator::useTimestamps_ = false;
+bool Generator::incremental_ = false;
+QHash<QString, QByteArray> Generator::pagesWritten_;
+QHash<QString, QByteArray> Generator::previousPages_;
 QmlTypeNode *Generator::qmlTypeContext_ = nullptr;
 
 static QRegExp tag("</?@[^>]*>");
@@ -114,6 +125,10 @@ Generator::Generator()
 Generator::~Generator()
 {
     generators.removeAll(this);
+    for (QTextStream *out : qAsConst(spareStreams_)) {
+        delete out->device();
+        delete out;
+    }
 }
 
 void Generator::appendFullName(Text &text,
@@ -251,12 +266,18 @@ void Generator::writeOutFileNames()
 }
 
 /*!
-  Creates the file named \a fileName in the output directory.
-  Attaches a QTextStream to the created file, which is written
-  to all over the place using out(). This function does not
-  store the \a fileName in the \a node as the output file name.
+  Begins the page for the file named \a fileName in the output
+  directory. Attaches a QTextStream to an in-memory buffer for
+  the page, which is written to all over the place using out().
+  The page is written to the file when it is ended. This function
+  does not store the \a fileName in the \a node as the output
+  file name.
+
+  The streams and buffers of ended pages are kept and reused, so
+  a page is encoded into memory that is already large enough for
+  most pages instead of a buffer that grows from nothing.
 
-  \sa beginSubPage()
+  \sa beginSubPage(), endSubPage()
  */
 void Generator::beginFilePage(const Node *node, const QString &fileName)
 {
@@ -266,20 +287,41 @@ void Generator::beginFilePage(const Node *node, const QString &fileName)
         path += node->outputSubdirectory() + QLatin1Char('/');
     path += fileName;
 
-    QFile* outFile = new QFile(redirectDocumentationToDevNull_ ? QStringLiteral("/dev/null") : path);
-    if (!redirectDocumentationToDevNull_ && outFile->exists())
-        node->location().error(tr("Output file already exists; overwriting %1").arg(outFile->fileName()));
-    if (!outFile->open(QFile::WriteOnly))
-        node->location().fatal(tr("Cannot open output file '%1'").arg(outFile->fileName()));
+    if (redirectDocumentationToDevNull_) {
+        path = QStringLiteral("/dev/null");
+    } else {
+        /*
+          A page that was already begun for this format is a conflict,
+          even if the background writer has not written it yet. So is
+          a file that another module or run left in the output
+          directory, except in incremental mode, where the directory
+          still holds the pages of the previous run. The pages of the
+          previous formats are on disk by now.
+         */
+        bool exists = pagesWritten_.contains(path) || (!incremental_ && QFile::exists(path));
+        if (exists)
+            node->location().error(tr("Output file already exists; overwriting %1").arg(path));
+        pagesWritten_.insert(path, QByteArray());
+    }
     qCDebug(lcQdoc, "Writing: %s", qPrintable(path));
     outFileNames_ << fileName;
-    QTextStream* out = new QTextStream(outFile);
 
+    QTextStream *out = spareStreams_.isEmpty() ? new QTextStream(new QBuffer)
+                                               : spareStreams_.takeLast();
 #ifndef QT_NO_TEXTCODEC
     if (outputCodec)
         out->setCodec(outputCodec);
 #endif
+    QBuffer *buffer = static_cast<QBuffer *>(out->device());
+    QByteArray &data = buffer->buffer();
+    data.resize(0);
+    if (data.capacity() < PageBufferSize)
+        data.reserve(PageBufferSize);
+    buffer->open(QIODevice::WriteOnly);
     outStreamStack.push(out);
+    outPageStack_.push(OutputPage { path, node->location(), QElapsedTimer() });
+    if (Timings::enabled())
+        outPageStack_.top().timer_.start();
 }
 
  /*!
@@ -300,15 +342,240 @@ void Generator::beginSubPage(const Node *node, const QString &fileName)
 }
 
 /*!
-  Flush the text stream associated with the subpage, and
-  then pop it off the text stream stack and delete it.
-  This terminates output of the subpage.
+  Flush the text stream associated with the subpage, write the
+  page to its output file, and then pop the text stream off the
+  text stream stack and keep it for the next page. This terminates
+  output of the subpage.
  */
 void Generator::endSubPage()
 {
-    outStreamStack.top()->flush();
-    delete outStreamStack.top()->device();
-    delete outStreamStack.pop();
+    QTextStream *out = outStreamStack.pop();
+    out->flush();
+    QBuffer *buffer = static_cast<QBuffer *>(out->device());
+    const OutputPage page = outPageStack_.pop();
+    if (Timings::enabled()) {
+        Timings::recordPage(page.path_, page.timer_.nsecsElapsed());
+        Timings::increment(Timings::PagesGenerated);
+    }
+    writeOutputFile(page, buffer->buffer());
+    buffer->close();
+    spareStreams_.append(out);
+}
+
+/*!
+  Writes \a data to the file \a path and returns \c false if the
+  file cannot be opened.
+ */
+static bool writePageFile(const QString &path, const QByteArray &data)
+{
+    QFile file(path);
+    if (!file.open(QFile::WriteOnly))
+        return false;
+    file.write(data);
+    return true;
+}
+
+#if QT_CONFIG(thread)
+/*!
+  \class PageWriter
+  \internal
+
+  Writes finished pages to disk on a background thread, so the
+  generator can go on rendering the next page while the previous
+  one is written. A single writer thread handles the pages in the
+  order they were finished, so the output is the same as when the
+  pages are written directly.
+
+  Pages are rendered on the generator's thread. The pages that
+  wait to be written take up at most MaxPendingBytes; when the
+  writer falls behind, write() blocks until it catches up.
+
+  write() takes the page's buffer and gives the generator back one
+  whose page was written, so the buffers keep their capacity from
+  page to page as they do when the pages are written directly.
+ */
+class PageWriter
+{
+public:
+    struct Failure
+    {
+        QString path_;
+        Location location_;
+    };
+
+    enum { MaxPendingBytes = 32 * 1024 * 1024 };
+
+    PageWriter() { pool_.setMaxThreadCount(1); }
+
+    void write(const QString &path, const Location &location, QByteArray &data)
+    {
+        {
+            QMutexLocker locker(&mutex_);
+            while (pendingBytes_ > 0 && pendingBytes_ + data.size() > MaxPendingBytes)
+                written_.wait(&mutex_);
+            pendingBytes_ += data.size();
+            queue_.append(Page { path, location, QByteArray() });
+            queue_.last().data_.swap(data);
+            if (!spareBuffers_.isEmpty())
+                data = spareBuffers_.takeLast();
+        }
+        pool_.start([this]() { writeNext(); });
+    }
+
+    QVector<Failure> waitForDone()
+    {
+        pool_.waitForDone();
+        QMutexLocker locker(&mutex_);
+        QVector<Failure> failures;
+        failures.swap(failures_);
+        return failures;
+    }
+
+private:
+    struct Page
+    {
+        QString path_;
+        Location location_;
+        QByteArray data_;
+    };
+
+    void writeNext()
+    {
+        Page page;
+        {
+            QMutexLocker locker(&mutex_);
+            page = queue_.takeFirst();
+        }
+        const bool ok = writePageFile(page.path_, page.data_);
+        QMutexLocker locker(&mutex_);
+        if (!ok)
+            failures_.append(Failure { page.path_, page.location_ });
+        pendingBytes_ -= page.data_.size();
+        page.data_.resize(0);
+        spareBuffers_.append(QByteArray());
+        spareBuffers_.last().swap(page.data_);
+        written_.wakeAll();
+    }
+
+    QThreadPool pool_;
+    QMutex mutex_;
+    QWaitCondition written_;
+    qint64 pendingBytes_ = 0;
+    QVector<Page> queue_;
+    QVector<QByteArray> spareBuffers_;
+    QVector<Failure> failures_;
+};
+
+static PageWriter *pageWriter_ = nullptr;
+#endif
+
+/*!
+  Writes \a data to the output file of \a page. In incremental
+  mode, a page whose contents hash to the value recorded by the
+  previous run is left alone, so its modification time tells later
+  build steps that it has not changed. The file is not read back
+  for this.
+
+  If qdoc runs with more than one job, the page is handed to a
+  background writer and written later; waitForOutputFiles() must
+  be called before the output is used. \a data is then swapped
+  for a buffer whose page was already written.
+ */
+void Generator::writeOutputFile(const OutputPage &page, QByteArray &data)
+{
+    if (incremental_ && !redirectDocumentationToDevNull_) {
+        const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+        pagesWritten_.insert(page.path_, hash);
+        const QFileInfo fi(page.path_);
+        if (previousPages_.value(page.path_) == hash && fi.exists() && fi.size() == data.size()) {
+            Timings::increment(Timings::PagesUnchanged);
+            return;
+        }
+    }
+#if QT_CONFIG(thread)
+    if (Config::jobs > 1) {
+        if (!pageWriter_)
+            pageWriter_ = new PageWriter;
+        pageWriter_->write(page.path_, page.location_, data);
+        return;
+    }
+#endif
+    if (!writePageFile(page.path_, data))
+        page.location_.fatal(tr("Cannot open output file '%1'").arg(page.path_));
+}
+
+/*!
+  Waits until all pages handed to the background writer have
+  been written to disk.
+ */
+void Generator::waitForOutputFiles()
+{
+#if QT_CONFIG(thread)
+    if (!pageWriter_)
+        return;
+    const auto failures = pageWriter_->waitForDone();
+    for (const auto &failure : failures)
+        failure.location_.fatal(tr("Cannot open output file '%1'").arg(failure.path_));
+#endif
+}
+
+/*!
+  Returns the path of the file in the output directory that lists
+  the pages written by this generator in incremental mode, each
+  with a hash of its contents.
+ */
+QString Generator::pageManifestPath()
+{
+    return outDir_ + QLatin1String("/.qdoc-") + format().toLower() + QLatin1String("-pages");
+}
+
+/*!
+  In incremental mode, reads the pages written by the previous run
+  of this generator and the hashes of their contents.
+ */
+void Generator::readPageManifest()
+{
+    previousPages_.clear();
+    if (!incremental_ || redirectDocumentationToDevNull_ || preparing())
+        return;
+
+    QFile manifest(pageManifestPath());
+    if (!manifest.open(QFile::ReadOnly | QFile::Text))
+        return;
+    while (!manifest.atEnd()) {
+        const QByteArray line = manifest.readLine().trimmed();
+        const int space = line.indexOf(' ');
+        if (space > 0)
+            previousPages_.insert(QString::fromUtf8(line.mid(space + 1)),
+                                  QByteArray::fromHex(line.left(space)));
+    }
+}
+
+/*!
+  Waits for the pending page writes. Then, in incremental mode,
+  removes the pages that the previous run of this generator wrote
+  to the output directory but this run did not, and records the
+  pages written by this run for the next one.
+ */
+void Generator::removeStalePages()
+{
+    waitForOutputFiles();
+    if (!incremental_ || redirectDocumentationToDevNull_ || preparing())
+        return;
+
+    for (auto it = previousPages_.cbegin(); it != previousPages_.cend(); ++it) {
+        if (!pagesWritten_.contains(it.key()) && QFile::remove(it.key()))
+            qCDebug(lcQdoc, "Removed stale page: %s", qPrintable(it.key()));
+    }
+    previousPages_.clear();
+
+    QFile manifest(pageManifestPath());
+    if (manifest.open(QFile::WriteOnly | QFile::Text)) {
+        QStringList pages = pagesWritten_.keys();
+        pages.sort();
+        for (const auto &path : qAsConst(pages))
+            manifest.write(pagesWritten_.value(path).toHex() + ' ' + path.toUtf8() + '\n');
+    }
 }
 
 /*
@@ -1149,7 +1416,7 @@ void Generator::generateDocumentation(Node *node)
     /*
       Obtain a code marker for the source file.
      */
-    CodeMarker *marker = CodeMarker::markerForFileName(node->location().filePath());
+    CodeMarker *marker = CodeMarker::markerForFileName(node->locationFilePath());
 
     if (node->parent() != nullptr) {
         if (node->isCollectionNode()) {
@@ -1903,6 +2170,7 @@ void Generator::copyTemplateFiles(const Config &config, const QString &configVar
 void Generator::initializeFormat(const Config &config)
 {
     outFileNames_.clear();
+    pagesWritten_.clear();
     useOutputSubdirs_ = true;
     if (config.getBool(format() + Config::dot + "nosubdirs"))
         resetUseOutputSubdirs();
@@ -1920,7 +2188,7 @@ void Generator::initializeFormat(const Config &config)
 
     QDir dirInfo;
     if (dirInfo.exists(outDir_)) {
-        if (!generating() && Generator::useOutputSubdirs()) {
+        if (!generating() && Generator::useOutputSubdirs() && !incremental_) {
             if (!Config::removeDirContents(outDir_))
                 config.lastLocation().error(tr("Cannot empty output directory '%1'").arg(outDir_));
         }
@@ -1932,6 +2200,8 @@ void Generator::initializeFormat(const Config &config)
     if (preparing())
         return;
 
+    readPageManifest();
+
     if (!dirInfo.exists(outDir_ + "/images") && !dirInfo.mkdir(outDir_ + "/images"))
         config.lastLocation().fatal(tr("Cannot create images directory '%1'").arg(outDir_ + "/images"));
 
@@ -1988,7 +2258,7 @@ QTextStream &Generator::out()
 
 QString Generator::outFileName()
 {
-    return QFileInfo(static_cast<QFile *>(out().device())->fileName()).fileName();
+    return QFileInfo(outPageStack_.top().path_).fileName();
 }
 
 QString Generator::outputPrefix(const Node *node)
@@ -2224,6 +2494,12 @@ void Generator::terminate()
     imageFiles.clear();
     imageDirs.clear();
     outDir_.clear();
+
+    waitForOutputFiles();
+#if QT_CONFIG(thread)
+    delete pageWriter_;
+    pageWriter_ = nullptr;
+#endif
 }
 
 void Generator::terminateGenerator()
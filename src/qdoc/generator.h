@@ -29,14 +29,17 @@
 #ifndef GENERATOR_H
 #define GENERATOR_H
 
+#include "location.h"
 #include "node.h"
 #include "text.h"
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmap.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qtextstream.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -65,6 +68,7 @@ public:
     virtual void initializeGenerator(const Config &config);
     virtual void initializeFormat(const Config &config);
     virtual void terminateGenerator();
+    void removeStalePages();
 
     QString fullDocumentLocation(const Node *node, bool useSubdir = false);
     const Config *config() { return config_; }
@@ -81,11 +85,14 @@ public:
     static void terminate();
     static const QStringList &outputFileNames() { return outFileNames_; }
     static void writeOutFileNames();
+    static void waitForOutputFiles();
     static void augmentImageDirs(QSet<QString> &moreImageDirs);
     static bool noLinkErrors() { return noLinkErrors_; }
     static bool autolinkErrors() { return autolinkErrors_; }
     static void setQDocPass(QDocPass t) { qdocPass_ = t; }
     static void setUseTimestamps() { useTimestamps_ = true; }
+    static void setIncremental() { incremental_ = true; }
+    static bool incremental() { return incremental_; }
     static bool preparing() { return (qdocPass_ == Prepare); }
     static bool generating() { return (qdocPass_ == Generate); }
     static bool singleExec() { return qdocSingleExec_; }
@@ -202,6 +209,19 @@ protected:
     void signatureList(const NodeList &nodes, const Node *relative, CodeMarker *marker);
 
 private:
+    struct OutputPage
+    {
+        QString path_;
+        Location location_;
+        QElapsedTimer timer_;
+    };
+    QStack<OutputPage> outPageStack_;
+    QVector<QTextStream *> spareStreams_;
+    enum { PageBufferSize = 64 * 1024 };
+    void writeOutputFile(const OutputPage &page, QByteArray &data);
+    QString pageManifestPath();
+    void readPageManifest();
+
     static Generator *currentGenerator_;
     static QStringList exampleDirs;
     static QStringList exampleImgExts;
@@ -230,6 +250,9 @@ private:
     static bool qdocWriteQaPages_;
     static bool useOutputSubdirs_;
     static bool useTimestamps_;
+    static bool incremental_;
+    static QHash<QString, QByteArray> pagesWritten_; // path->content hash
+    static QHash<QString, QByteArray> previousPages_;
     static QmlTypeNode *qmlTypeContext_;
 
     void generateReimplementsClause(const FunctionNode *fn, CodeMarker *marker);
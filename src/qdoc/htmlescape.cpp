@@ -0,0 +1,131 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "htmlescape.h"
+
+QT_BEGIN_NAMESPACE
+
+/*!
+  \namespace HtmlEscape
+  \internal
+
+  Escapes text for the HTML generator. The text is scanned once;
+  runs of characters that need no escaping are copied as a whole,
+  and a string that needs no escaping at all is returned without
+  being copied.
+ */
+
+/*!
+  Returns \c true if the character at \a i in \a data must be
+  written as an entity. Besides the HTML special characters, this
+  is the last dot in 'e.g.' and 'i.e.', which the Javadoc generator
+  needs escaped, and, if \a escapeNonAscii is \c true, every
+  character outside of ASCII.
+ */
+static inline bool needsEscape(const QChar *data, int i, bool escapeNonAscii)
+{
+    switch (data[i].unicode()) {
+    case '&':
+    case '<':
+    case '>':
+    case '"':
+        return true;
+    case '.':
+        return i > 2 && data[i - 2] == QLatin1Char('.');
+    default:
+        return escapeNonAscii && data[i].unicode() > 0x007F;
+    }
+}
+
+/*!
+  Appends the entity for \a ch to \a html.
+ */
+static inline void appendEntity(QString *html, QChar ch)
+{
+    switch (ch.unicode()) {
+    case '&':
+        *html += QLatin1String("&amp;");
+        break;
+    case '<':
+        *html += QLatin1String("&lt;");
+        break;
+    case '>':
+        *html += QLatin1String("&gt;");
+        break;
+    case '"':
+        *html += QLatin1String("&quot;");
+        break;
+    default: {
+        static const char hexDigits[] = "0123456789abcdef";
+        char entity[8] = { '&', '#', 'x' };
+        int length = 3;
+        ushort code = ch.unicode();
+        int shift = 12;
+        while (shift > 0 && (code >> shift) == 0)
+            shift -= 4;
+        for (; shift >= 0; shift -= 4)
+            entity[length++] = hexDigits[(code >> shift) & 0xf];
+        entity[length++] = ';';
+        *html += QLatin1String(entity, length);
+        break;
+    }
+    }
+}
+
+/*!
+  Returns \a string with the characters that HTML or the Javadoc
+  generator cannot take as they are replaced by entities. If
+  \a escapeNonAscii is \c true, the characters outside of ASCII
+  are replaced as well. If nothing needs to be replaced, \a string
+  itself is returned.
+ */
+QString HtmlEscape::protect(const QString &string, bool escapeNonAscii)
+{
+    const QChar *data = string.constData();
+    const int n = string.size();
+    int i = 0;
+    while (i < n && !needsEscape(data, i, escapeNonAscii))
+        ++i;
+    if (i == n)
+        return string;
+
+    QString html;
+    html.reserve(n + n / 4 + 16);
+    int start = 0;
+    for (; i < n; ++i) {
+        if (!needsEscape(data, i, escapeNonAscii))
+            continue;
+        html.append(data + start, i - start);
+        appendEntity(&html, data[i]);
+        start = i + 1;
+    }
+    html.append(data + start, n - start);
+    return html;
+}
+
+QT_END_NAMESPACE
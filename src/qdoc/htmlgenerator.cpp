@@ -35,8 +35,10 @@
 #include "codemarker.h"
 #include "codeparser.h"
 #include "helpprojectwriter.h"
+#include "htmlescape.h"
 #include "node.h"
 #include "qdocdatabase.h"
+#include "scanners.h"
 #include "separator.h"
 #include "tree.h"
 #include "quoter.h"
@@ -352,7 +354,7 @@ void HtmlGenerator::generateQAPage()
 {
     NamespaceNode *node = qdb_->primaryTreeRoot();
     beginSubPage(node, "aaa-" + defaultModuleName().toLower() + "-qa-page.html");
-    CodeMarker *marker = CodeMarker::markerForFileName(node->location().filePath());
+    CodeMarker *marker = CodeMarker::markerForFileName(node->locationFilePath());
     QString title = "Quality Assurance Page for " + defaultModuleName();
     QString t = "Quality assurance information for checking the " + defaultModuleName() + " documentation.";
     generateHeader(title, node, marker);
@@ -953,7 +955,8 @@ int HtmlGenerator::generateAtom(const Atom *atom, const Node *relative, CodeMark
         const Node *node = nullptr;
         QString link = getLink(atom, relative, &node);
         if (link.isEmpty() && (node != relative) && !noLinkErrors()) {
-            relative->doc().location().warning(tr("Can't link to '%1'").arg(atom->string()));
+            relative->doc().location().warning(tr("Can't link to '%1'").arg(atom->string()),
+                                               linkSuggestions(atom->string()));
             if (Generator::writeQaPages() && (atom->type() != Atom::NavAutoLink)) {
                 QString text = atom->next()->next()->string();
                 QString target = qdb_->getNewLinkTarget(relative, node, outFileName(), text, true);
@@ -2168,7 +2171,8 @@ void HtmlGenerator::generateHeader(const QString &title,
             linkPair = node->links()[Node::PreviousLink];
             linkNode = qdb_->findNodeForTarget(linkPair.first, node);
             if (linkNode == nullptr)
-                node->doc().location().warning(tr("Cannot link to '%1'").arg(linkPair.first));
+                node->doc().location().warning(tr("Cannot link to '%1'").arg(linkPair.first),
+                                               linkSuggestions(linkPair.first));
             if (linkNode == nullptr || linkNode == node)
                 anchorPair = linkPair;
             else
@@ -2189,7 +2193,8 @@ void HtmlGenerator::generateHeader(const QString &title,
             linkPair = node->links()[Node::NextLink];
             linkNode = qdb_->findNodeForTarget(linkPair.first, node);
             if (linkNode == nullptr)
-                node->doc().location().warning(tr("Cannot link to '%1'").arg(linkPair.first));
+                node->doc().location().warning(tr("Cannot link to '%1'").arg(linkPair.first),
+                                               linkSuggestions(linkPair.first));
             if (linkNode == nullptr || linkNode == node)
                 anchorPair = linkPair;
             else
@@ -2212,7 +2217,8 @@ void HtmlGenerator::generateHeader(const QString &title,
             linkPair = node->links()[Node::StartLink];
             linkNode = qdb_->findNodeForTarget(linkPair.first, node);
             if (linkNode == nullptr)
-                node->doc().location().warning(tr("Cannot link to '%1'").arg(linkPair.first));
+                node->doc().location().warning(tr("Cannot link to '%1'").arg(linkPair.first),
+                                               linkSuggestions(linkPair.first));
             if (linkNode == nullptr || linkNode == node)
                 anchorPair = linkPair;
             else
@@ -3262,16 +3268,14 @@ void HtmlGenerator::generateQmlItem(const Node *node,
                                     CodeMarker *marker,
                                     bool summary)
 {
-    QString marked = marker->markedUpQmlItem(node,summary);
-    QRegExp templateTag("(<[^@>]*>)");
-    if (marked.indexOf(templateTag) != -1) {
-        QString contents = protectEnc(marked.mid(templateTag.pos(1),
-                                                 templateTag.cap(1).length()));
-        marked.replace(templateTag.pos(1), templateTag.cap(1).length(),
-                       contents);
-    }
-    marked.replace(QRegExp("<@param>([a-z]+)_([1-9n])</@param>"),
-                   "<i>\\1<sub>\\2</sub></i>");
+    QString marked = marker->qmlItem(node, summary);
+    int templateTagLength = 0;
+    int templateTag = Scanners::indexOfTemplateTag(marked, &templateTagLength);
+    if (templateTag != -1) {
+        QString contents = protectEnc(marked.mid(templateTag, templateTagLength));
+        marked.replace(templateTag, templateTagLength, contents);
+    }
+    Scanners::markSubscriptParameters(marked);
     marked.replace("<@param>", "<i>");
     marked.replace("</@param>", "</i>");
 
@@ -3526,19 +3530,17 @@ void HtmlGenerator::generateSynopsis(const Node *node,
                                      bool alignNames,
                                      const QString *prefix)
 {
-    QString marked = marker->markedUpSynopsis(node, relative, style);
+    QString marked = marker->synopsis(node, relative, style);
 
     if (prefix)
         marked.prepend(*prefix);
-    QRegExp templateTag("(<[^@>]*>)");
-    if (marked.indexOf(templateTag) != -1) {
-        QString contents = protectEnc(marked.mid(templateTag.pos(1),
-                                                 templateTag.cap(1).length()));
-        marked.replace(templateTag.pos(1), templateTag.cap(1).length(),
-                       contents);
-    }
-    marked.replace(QRegExp("<@param>([a-z]+)_([1-9n])</@param>"),
-                   "<i>\\1<sub>\\2</sub></i>");
+    int templateTagLength = 0;
+    int templateTag = Scanners::indexOfTemplateTag(marked, &templateTagLength);
+    if (templateTag != -1) {
+        QString contents = protectEnc(marked.mid(templateTag, templateTagLength));
+        marked.replace(templateTag, templateTagLength, contents);
+    }
+    Scanners::markSubscriptParameters(marked);
     marked.replace("<@param>", "<i>");
     marked.replace("</@param>", "</i>");
 
@@ -3548,9 +3550,7 @@ void HtmlGenerator::generateSynopsis(const Node *node,
     }
 
     if (style == Section::AllMembers) {
-        QRegExp extraRegExp("<@extra>.*</@extra>");
-        extraRegExp.setMinimal(true);
-        marked.remove(extraRegExp);
+        Scanners::removeExtras(marked);
     } else {
         marked.replace("<@extra>", "<code>");
         marked.replace("</@extra>", "</code>");
@@ -3638,7 +3638,11 @@ QString HtmlGenerator::highlightedCode(const QString &markedCode,
             }
         }
         else {
-            html += src.at(i++);
+            int next = src.indexOf(charLangle, i + 1);
+            if (next == -1)
+                next = srcSize;
+            html += QStringRef(&src, i, next - i);
+            i = next;
         }
     }
 
@@ -3715,8 +3719,11 @@ QString HtmlGenerator::highlightedCode(const QString &markedCode,
                 continue;
             }
         }
-        html += src.at(i);
-        ++i;
+        int next = src.indexOf(QLatin1Char('<'), i + 1);
+        if (next == -1)
+            next = n;
+        html += QStringRef(&src, i, next - i);
+        i = next;
     }
     return html;
 }
@@ -3759,6 +3766,24 @@ QString HtmlGenerator::registerRef(const QString &ref)
     return clean;
 }
 
+/*!
+  Returns the details for the warning about a link to \a target
+  that could not be resolved: the link targets with the closest
+  names, or an empty string if no name is close enough.
+ */
+QString HtmlGenerator::linkSuggestions(const QString &target)
+{
+    const QStringList names = qdb_->nearestLinkTargets(target);
+    if (names.isEmpty())
+        return QString();
+    QString list = QLatin1Char('\'') + names.first() + QLatin1Char('\'');
+    for (int i = 1; i < names.size(); ++i) {
+        list += (i + 1 < names.size()) ? QLatin1String(", '") : QLatin1String(" or '");
+        list += names.at(i) + QLatin1Char('\'');
+    }
+    return tr("Maybe you meant %1?").arg(list);
+}
+
 QString HtmlGenerator::protectEnc(const QString &string)
 {
 #ifndef QT_NO_TEXTCODEC
@@ -3770,45 +3795,7 @@ QString HtmlGenerator::protectEnc(const QString &string)
 
 QString HtmlGenerator::protect(const QString &string, const QString &outputEncoding)
 {
-#define APPEND(x) \
-    if (html.isEmpty()) { \
-    html = string; \
-    html.truncate(i); \
-} \
-    html += (x);
-
-    QString html;
-    int n = string.length();
-
-    for (int i = 0; i < n; ++i) {
-        QChar ch = string.at(i);
-
-        if (ch == QLatin1Char('&')) {
-            APPEND("&amp;");
-        } else if (ch == QLatin1Char('<')) {
-            APPEND("&lt;");
-        } else if (ch == QLatin1Char('>')) {
-            APPEND("&gt;");
-        } else if (ch == QLatin1Char('"')) {
-            APPEND("&quot;");
-        } else if ((outputEncoding == QLatin1String("ISO-8859-1") && ch.unicode() > 0x007F)
-                   || (ch == QLatin1Char('*') && i + 1 < n && string.at(i) == QLatin1Char('/'))
-                   || (ch == QLatin1Char('.') && i > 2 && string.at(i - 2) == QLatin1Char('.'))) {
-            // we escape '*/' and the last dot in 'e.g.' and 'i.e.' for the Javadoc generator
-            APPEND("&#x");
-            html += QString::number(ch.unicode(), 16);
-            html += QLatin1Char(';');
-        } else {
-            if (!html.isEmpty())
-                html += ch;
-        }
-    }
-
-    if (!html.isEmpty())
-        return html;
-    return string;
-
-#undef APPEND
+    return HtmlEscape::protect(string, outputEncoding == QLatin1String("ISO-8859-1"));
 }
 
 QString HtmlGenerator::fileBase(const Node *node) const
@@ -187,6 +187,7 @@ private:
 
     inline bool hasBrief(const Node *node);
     QString registerRef(const QString &ref);
+    QString linkSuggestions(const QString &target);
     QString fileBase(const Node *node) const override;
     QString fileName(const Node *node);
     static int hOffset(const Node *node);
@@ -30,6 +30,7 @@
 
 #include "config.h"
 #include "generator.h"
+#include "timings.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qdir.h>
@@ -51,6 +52,7 @@ QString Location::programName;
 QString Location::project;
 QRegExp *Location::spuriousRegExp = nullptr;
 bool Location::logProgress_ = false;
+bool Location::fatalErrorsRecoverable_ = false;
 
 /*!
   \class Location
@@ -303,6 +305,10 @@ int Location::exitCode()
   Writes \a message and \a detals to stderr as a formatted
   error message and then exits the program. qdoc prints fatal
   errors in either phase (Prepare or Generate).
+
+  If fatal errors are recoverable, which they are when qdoc
+  processes batches of modules, FatalError is thrown instead, so
+  that only the module being processed is abandoned.
  */
 void Location::fatal(const QString &message, const QString &details) const
 {
@@ -310,6 +316,8 @@ void Location::fatal(const QString &message, const QString &details) const
     information(message);
     information(details);
     information("Aborting");
+    if (fatalErrorsRecoverable_)
+        throw FatalError();
     exit(EXIT_FAILURE);
 }
 
@@ -492,4 +500,96 @@ QString Location::top() const
     return str;
 }
 
+
+/*!
+  \class CompactLocation
+  \internal
+  \brief The CompactLocation class stores a Location as a file
+  id, a line number, and a column number.
+
+  Nodes keep their declaration and definition locations in this
+  form. Each file path is stored once in a table shared by all
+  compact locations. A location that has more than one entry on
+  its file position stack, or that is marked \e etc, is kept in
+  full in a separate table, so toLocation() always returns a
+  location equal to the one the compact location was made from.
+
+  The difference in size to the location it replaces is counted
+  in the timings, less the size of the full copy of a stacked
+  location.
+
+  Compact locations must be created on the main thread.
+ */
+
+QVector<QString> CompactLocation::filePaths_;
+QHash<QString, int> CompactLocation::fileIds_;
+QVector<Location> CompactLocation::stackedLocations_;
+
+/*!
+  Constructs a compact location equal to \a location.
+ */
+CompactLocation::CompactLocation(const Location &location)
+    : fileId_(-1), lineNo_(0), columnNo_(0)
+{
+    if (location.isEmpty())
+        return;
+    if (location.depth() > 1 || location.etc()) {
+        fileId_ = -2 - stackedLocations_.size();
+        stackedLocations_.append(location);
+        Timings::add(Timings::LocationBytesSaved, -qint64(sizeof(CompactLocation)));
+        return;
+    }
+    auto it = fileIds_.constFind(location.filePath());
+    if (it == fileIds_.constEnd()) {
+        it = fileIds_.insert(location.filePath(), filePaths_.size());
+        filePaths_.append(location.filePath());
+    }
+    fileId_ = it.value();
+    lineNo_ = location.lineNo();
+    columnNo_ = location.columnNo();
+    Timings::add(Timings::LocationBytesSaved,
+                 qint64(sizeof(Location)) - qint64(sizeof(CompactLocation)));
+}
+
+/*!
+  Returns the file path of the location this compact location
+  was made from, without constructing that location.
+ */
+const QString &CompactLocation::filePath() const
+{
+    static const QString noFilePath;
+    if (fileId_ == -1)
+        return noFilePath;
+    if (fileId_ < -1)
+        return stackedLocations_.at(-2 - fileId_).filePath();
+    return filePaths_.at(fileId_);
+}
+
+/*!
+  Forgets the file paths and stacked locations of all compact
+  locations. This must only be done when no compact location
+  made before remains, that is, when the nodes are destroyed.
+ */
+void CompactLocation::reset()
+{
+    filePaths_.clear();
+    fileIds_.clear();
+    stackedLocations_.clear();
+}
+
+/*!
+  Returns the location this compact location was made from.
+ */
+Location CompactLocation::toLocation() const
+{
+    if (fileId_ == -1)
+        return Location();
+    if (fileId_ < -1)
+        return stackedLocations_.at(-2 - fileId_);
+    Location location(filePaths_.at(fileId_));
+    location.setLineNo(lineNo_);
+    location.setColumnNo(columnNo_);
+    return location;
+}
+
 QT_END_NAMESPACE
@@ -34,7 +34,9 @@
 #define LOCATION_H
 
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qstack.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -82,6 +84,9 @@ public:
 
     static const Location null;
 
+    // Thrown by fatal() when fatal errors are recoverable
+    struct FatalError { };
+
     static void initialize(const Config &config);
     static void terminate();
     static void information(const QString &message);
@@ -92,6 +97,8 @@ public:
     static void stopLoggingProgress() { logProgress_ = false; }
     static QString canonicalRelativePath(const QString &path);
     static int exitCode();
+    static void setFatalErrorsRecoverable(bool recoverable) { fatalErrorsRecoverable_ = recoverable; }
+    static bool fatalErrorsRecoverable() { return fatalErrorsRecoverable_; }
 
 private:
     enum MessageType { Warning, Error, Report };
@@ -124,10 +131,34 @@ private:
     static QString project;
     static QRegExp *spuriousRegExp;
     static bool logProgress_;
+    static bool fatalErrorsRecoverable_;
 };
 Q_DECLARE_TYPEINFO(Location::StackEntry, Q_MOVABLE_TYPE);
 Q_DECLARE_TYPEINFO(Location, Q_COMPLEX_TYPE); // stkTop = &stkBottom
 
+class CompactLocation
+{
+public:
+    CompactLocation() : fileId_(-1), lineNo_(0), columnNo_(0) { }
+    CompactLocation(const Location &location);
+
+    bool isEmpty() const { return fileId_ == -1; }
+    const QString &filePath() const;
+    Location toLocation() const;
+
+    static void reset();
+
+private:
+    int fileId_;
+    int lineNo_;
+    int columnNo_;
+
+    static QVector<QString> filePaths_;
+    static QHash<QString, int> fileIds_;
+    static QVector<Location> stackedLocations_;
+};
+Q_DECLARE_TYPEINFO(CompactLocation, Q_PRIMITIVE_TYPE);
+
 QT_END_NAMESPACE
 
 #endif
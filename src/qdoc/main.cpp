@@ -39,10 +39,14 @@
 #include "loggingcategory.h"
 #include "puredocparser.h"
 #include "qdocdatabase.h"
+#include "qdocindexreader.h"
 #include "qmlcodemarker.h"
 #include "qmlcodeparser.h"
+#include "quoter.h"
+#include "sections.h"
 #include "utilities.h"
 #include "qtranslator.h"
+#include "timings.h"
 #include "tokenizer.h"
 #include "tree.h"
 #include "webxmlgenerator.h"
@@ -51,9 +55,11 @@
 #include <QtCore/qcommandlineparser.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qglobal.h>
 #include <QtCore/qglobalstatic.h>
 #include <QtCore/qhashfunctions.h>
+#include <QtCore/qtextstream.h>
 
 #ifndef QT_BOOTSTRAPPED
 #  include <QtCore/qcoreapplication.h>
@@ -205,6 +211,12 @@ static void processQdocconfFile(const QString &fileName, Config &config)
 {
     config.setPreviousCurrentDir(QDir::currentPath());
 
+    /*
+      Directory listings and file name indexes are only valid for
+      one qdocconf file; the files may change between runs.
+     */
+    Config::clearDirectoryCache();
+
     /*
       With the default configuration values in place, load
       the qdoc configuration file. Note that the configuration
@@ -219,6 +231,8 @@ static void processQdocconfFile(const QString &fileName, Config &config)
     QString project = config.getString(CONFIG_PROJECT);
     if (project.isEmpty()) {
         Location::logToStdErrAlways(QLatin1String("qdoc can't run; no project set in qdocconf file"));
+        if (Location::fatalErrorsRecoverable())
+            throw Location::FatalError();
         exit(1);
     }
     Location::terminate();
@@ -320,6 +334,7 @@ static void processQdocconfFile(const QString &fileName, Config &config)
     if (!Generator::singleExec()) {
         if (!Generator::preparing()) {
             qCDebug(lcQdoc, "  loading index files");
+            Timings::Phase timing(QLatin1String("index loading"));
             loadIndexFiles(config, outputFormats);
             qCDebug(lcQdoc, "  done loading index files");
         }
@@ -419,19 +434,27 @@ static void processQdocconfFile(const QString &fileName, Config &config)
         */
 
         qCDebug(lcQdoc, "Parsing header files");
+        Timings::startPhase(QLatin1String("header parsing"));
         int parsed = 0;
+        QElapsedTimer fileTimer;
         QMap<QString,QString>::ConstIterator h = headers.constBegin();
         while (h != headers.constEnd()) {
             CodeParser *codeParser = CodeParser::parserForHeaderFile(h.key());
             if (codeParser) {
                 ++parsed;
                 qCDebug(lcQdoc, "Parsing %s", qPrintable(h.key()));
+                fileTimer.start();
                 codeParser->parseHeaderFile(config.location(), h.key());
+                Timings::recordFile(h.key(), fileTimer.nsecsElapsed());
+                Timings::increment(Timings::FilesParsed);
             }
             ++h;
         }
+        Timings::endPhase();
 
+        Timings::startPhase(QLatin1String("PCH build"));
         clangParser_->precompileHeaders();
+        Timings::endPhase();
 
         /*
           Parse each source text file in the set using the appropriate parser and
@@ -439,16 +462,27 @@ static void processQdocconfFile(const QString &fileName, Config &config)
         */
         parsed = 0;
         Location::logToStdErrAlways("Parse source files for " + project);
+        Timings::startPhase(QLatin1String("source parsing"));
+        QStringList clangSources;
+        for (auto it = sources.constBegin(); it != sources.constEnd(); ++it) {
+            if (CodeParser::parserForSourceFile(it.key()) == clangParser_)
+                clangSources << it.key();
+        }
+        clangParser_->prefetchSourceFiles(clangSources);
         QMap<QString,QString>::ConstIterator s = sources.constBegin();
         while (s != sources.constEnd()) {
             CodeParser *codeParser = CodeParser::parserForSourceFile(s.key());
             if (codeParser) {
                 ++parsed;
                 qCDebug(lcQdoc, "Parsing %s", qPrintable(s.key()));
+                fileTimer.start();
                 codeParser->parseSourceFile(config.location(), s.key());
+                Timings::recordFile(s.key(), fileTimer.nsecsElapsed());
+                Timings::increment(Timings::FilesParsed);
             }
             ++s;
         }
+        Timings::endPhase();
         Location::logToStdErrAlways("Source files parsed for " + project);
     }
     /*
@@ -457,26 +491,36 @@ static void processQdocconfFile(const QString &fileName, Config &config)
       targets, URLs, links, and other stuff that needs resolving.
     */
     qCDebug(lcQdoc, "Resolving stuff prior to generating docs");
+    Timings::startPhase(QLatin1String("resolveStuff"));
     qdb->resolveStuff();
+    Timings::endPhase();
 
     /*
       The primary tree is built and all the stuff that needed
       resolving has been resolved. Now traverse the tree and
       generate the documentation output. More than one output
       format can be requested. The tree is traversed for each
-      one.
+      one, so then the sections built for each aggregate page are
+      kept for the next format.
      */
     qCDebug(lcQdoc, "Generating docs");
+    Sections::setCachingEnabled(outputFormats.size() > 1);
     QSet<QString>::ConstIterator of = outputFormats.constBegin();
     while (of != outputFormats.constEnd()) {
         Generator *generator = Generator::generatorForFormat(*of);
         if (generator == nullptr)
             outputFormatsLocation.fatal(QCoreApplication::translate("QDoc",
                                                "Unknown output format '%1'").arg(*of));
+        Timings::startPhase(QLatin1String("generate ") + *of);
         generator->initializeFormat(config);
         generator->generateDocs();
+        generator->removeStalePages();
+        Timings::endPhase();
         ++of;
     }
+    Sections::clearCache();
+    Timings::finishRun(project, Generator::preparing() ? QLatin1String("prepare")
+                                                       : QLatin1String("generate"));
     qdb->clearLinkCounts();
 
     qCDebug(lcQdoc, "Terminating qdoc classes");
@@ -497,6 +541,132 @@ static void processQdocconfFile(const QString &fileName, Config &config)
     qCDebug(lcQdoc, "qdoc classes terminated");
 }
 
+/*!
+    Returns the qdoc config files in \a files ordered so that each
+    module comes after the modules in its \c depends variable, as
+    far as those are in \a files too. Modules that depend on each
+    other in a cycle keep the order they have in \a files. \a config
+    is used to read the project and dependencies of each file.
+ */
+static QStringList sortByDependencies(const QStringList &files, Config &config)
+{
+    const QString currentDir = QDir::currentPath();
+    QStringList projects;
+    QVector<QStringList> depends;
+    for (const auto &file : files) {
+        Location::initialize(config);
+        try {
+            config.load(file);
+            projects << config.getString(CONFIG_PROJECT).toLower();
+            depends << config.getStringList(CONFIG_DEPENDS);
+        } catch (const Location::FatalError &) {
+            // Reported as failed when processQdocconfFile() reads it again.
+            projects << QString();
+            depends << QStringList();
+        }
+        Location::terminate();
+        QDir::setCurrent(currentDir);
+    }
+
+    QStringList ordered;
+    QVector<bool> done(files.size(), false);
+    while (ordered.size() < files.size()) {
+        bool progress = false;
+        for (int i = 0; i < files.size(); ++i) {
+            if (done.at(i))
+                continue;
+            bool ready = true;
+            for (const auto &module : depends.at(i)) {
+                int j = projects.indexOf(module.toLower());
+                if (j != -1 && j != i && !done.at(j)) {
+                    ready = false;
+                    break;
+                }
+            }
+            if (ready) {
+                done[i] = true;
+                ordered << files.at(i);
+                progress = true;
+            }
+        }
+        if (!progress) {
+            for (int i = 0; i < files.size(); ++i) {
+                if (!done.at(i)) {
+                    done[i] = true;
+                    ordered << files.at(i);
+                }
+            }
+        }
+    }
+    return ordered;
+}
+
+/*!
+    Terminates the qdoc classes after a fatal error in the qdoc config
+    file \a fileName, wherever processQdocconfFile() was interrupted.
+    Fatal errors while doing so are ignored.
+ */
+static void abandonQdocconfFile(const QString &fileName, Config &config)
+{
+    try {
+        Sections::clearCache();
+        Timings::finishRun(QFileInfo(fileName).completeBaseName(), QLatin1String("failed"));
+        if (Utilities::debugging())
+            Utilities::stopDebugging(QFileInfo(fileName).completeBaseName());
+        QDocDatabase::qdocDB()->setVersion(QString());
+        Generator::terminate();
+        CodeParser::terminate();
+        CodeMarker::terminate();
+        Doc::terminate();
+        Tokenizer::terminate();
+        Location::terminate();
+    } catch (const Location::FatalError &) {
+    }
+    if (!config.previousCurrentDir().isEmpty())
+        QDir::setCurrent(config.previousCurrentDir());
+}
+
+/*!
+    Processes the qdoc config files in \a files in the order of their
+    dependencies, each one as if it were processed by a qdoc process
+    of its own, and writes a line to the standard output when they
+    are done. The database is destroyed after each module, but the
+    index files that were loaded stay in memory for the next modules.
+
+    A fatal error ends only the module in which it occurs. The module
+    is reported as failed on the standard output, and the remaining
+    modules are processed. Returns the number of failed modules.
+ */
+static int processBatch(const QStringList &files, Config &config)
+{
+    if (files.isEmpty())
+        return 0;
+    const QStringList ordered = sortByDependencies(files, config);
+    int failed = 0;
+    for (const auto &file : ordered) {
+        config.dependModules().clear();
+        try {
+            processQdocconfFile(file, config);
+        } catch (const Location::FatalError &) {
+            abandonQdocconfFile(file, config);
+            QTextStream(stdout) << "qdoc: " << file << " failed" << Qt::endl;
+            ++failed;
+        }
+        QmlTypeNode::terminate();
+        QDocDatabase::destroyQdocDB();
+
+        // Nothing read for this module may be used by the next one.
+        CompactLocation::reset();
+        Config::clearDirectoryCache();
+        Quoter::clearCache();
+    }
+    QTextStream(stdout) << "qdoc: batch of " << ordered.size() << " done";
+    if (failed)
+        QTextStream(stdout) << ", " << failed << " failed";
+    QTextStream(stdout) << Qt::endl;
+    return failed;
+}
+
 QT_END_NAMESPACE
 
 int main(int argc, char **argv)
@@ -542,12 +712,14 @@ int main(int argc, char **argv)
 
     // Get the list of files to act on:
     QStringList qdocFiles = config.qdocFiles();
-    if (qdocFiles.isEmpty())
+    if (qdocFiles.isEmpty() && !config.batch())
         config.showHelp();
 
     if (config.singleExec())
         qdocFiles = Config::loadMaster(qdocFiles.at(0));
 
+    int batchFailures = 0;
+
     if (Generator::singleExec()) {
         // single qdoc process for prepare and generate phases
         Generator::setQDocPass(Generator::Prepare);
@@ -561,6 +733,25 @@ int main(int argc, char **argv)
             config.dependModules().clear();
             processQdocconfFile(file, config);
         }
+    } else if (config.batch()) {
+        // one qdoc process for batches of modules read from stdin
+        BinaryIndexReader::setCachingEnabled(true);
+        Location::setFatalErrorsRecoverable(true);
+        batchFailures += processBatch(qdocFiles, config);
+        QTextStream in(stdin);
+        QStringList batch;
+        for (QString line = in.readLine(); !line.isNull(); line = in.readLine()) {
+            line = line.trimmed();
+            if (!line.isEmpty()) {
+                batch << line;
+            } else {
+                batchFailures += processBatch(batch, config);
+                batch.clear();
+            }
+        }
+        batchFailures += processBatch(batch, config);
+        Location::setFatalErrorsRecoverable(false);
+        BinaryIndexReader::clearCache();
     } else {
         // separate qdoc processes for prepare and generate phases
         for (const auto &file : qAsConst(qdocFiles)) {
@@ -587,6 +778,9 @@ int main(int argc, char **argv)
 #ifdef DEBUG_SHUTDOWN_CRASH
     qDebug() << "main(): qdoc database deleted";
 #endif
+    Timings::writeReport();
 
+    if (batchFailures)
+        return EXIT_FAILURE;
     return Location::exitCode();
 }
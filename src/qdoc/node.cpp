@@ -33,6 +33,7 @@
 #include "generator.h"
 #include "puredocparser.h"
 #include "qdocdatabase.h"
+#include "timings.h"
 #include "tokenizer.h"
 #include "tree.h"
 
@@ -182,9 +183,9 @@ bool Node::nodeNameLessThan(const Node *n1, const Node *n2)
             return false;
     }
 
-    if (n1->location().filePath() < n2->location().filePath())
+    if (n1->locationFilePath() < n2->locationFilePath())
         return true;
-    else if (n1->location().filePath() > n2->location().filePath())
+    else if (n1->locationFilePath() > n2->locationFilePath())
         return false;
 
     if (n1->nodeType() < n2->nodeType())
@@ -723,11 +724,13 @@ Node::Node(NodeType type, Aggregate *parent, const QString &name)
       hadDoc_(false),
       parent_(parent),
       sharedCommentNode_(nullptr),
-      name_(name)
+      name_(QDocDatabase::intern(name))
 {
     if (parent_)
         parent_->addChild(this);
-    outSubDir_ = Generator::outputSubdir();
+    QDocDatabase::countNode();
+    Timings::increment(Timings::NodesCreated);
+    outSubDir_ = QDocDatabase::intern(Generator::outputSubdir());
     if (operators_.isEmpty()) {
         operators_.insert("++", "inc");
         operators_.insert("--", "dec");
@@ -1075,7 +1078,31 @@ void Node::setLink(LinkType linkType, const QString &link, const QString &desc)
  */
 void Node::setSince(const QString &since)
 {
-    since_ = since.simplified();
+    since_ = QDocDatabase::intern(since.simplified());
+}
+
+/*!
+  Sets the physical module name of this node to \a name.
+ */
+void Node::setPhysicalModuleName(const QString &name)
+{
+    physicalModuleName_ = QDocDatabase::intern(name);
+}
+
+/*!
+  Sets the template declaration of this node to \a t.
+ */
+void Node::setTemplateStuff(const QString &t)
+{
+    templateStuff_ = QDocDatabase::intern(t);
+}
+
+/*!
+  Sets the output subdirectory of this node to \a t.
+ */
+void Node::setOutputSubdirectory(const QString &t)
+{
+    outSubDir_ = QDocDatabase::intern(t);
 }
 
 /*!
@@ -1440,7 +1467,7 @@ QString Node::physicalModuleName() const
     if (!physicalModuleName_.isEmpty())
         return physicalModuleName_;
 
-    QString path = location().filePath();
+    const QString &path = locationFilePath();
     QString pattern = QString("src") + QDir::separator();
     int start = path.lastIndexOf(pattern);
 
@@ -3963,6 +3990,14 @@ QString FunctionNode::virtualness() const
     return QLatin1String("non");
 }
 
+/*!
+  Sets the function's return type to \a t.
+ */
+void FunctionNode::setReturnType(const QString &t)
+{
+    returnType_ = QDocDatabase::intern(t);
+}
+
 /*!
   Sets the function node's virtualness value based on the value
   of string \a t, which is the value of the function's \e{virtual}
@@ -253,9 +253,9 @@ public:
     }
     void setThreadSafeness(ThreadSafeness t) { safeness_ = t; }
     void setSince(const QString &since);
-    void setPhysicalModuleName(const QString &name) { physicalModuleName_ = name; }
+    void setPhysicalModuleName(const QString &name);
     void setUrl(const QString &url) { url_ = url; }
-    void setTemplateStuff(const QString &t) { templateStuff_ = t; }
+    void setTemplateStuff(const QString &t);
     void setReconstitutedBrief(const QString &t) { reconstitutedBrief_ = t; }
     void setParent(Aggregate *n) { parent_ = n; }
     void setIndexNodeFlag(bool isIndexNode = true) { indexNodeFlag_ = isIndexNode; }
@@ -305,9 +305,14 @@ public:
 
     Access access() const { return access_; }
     QString accessString() const;
-    const Location &declLocation() const { return declLocation_; }
-    const Location &defLocation() const { return defLocation_; }
-    const Location &location() const { return (defLocation_.isEmpty() ? declLocation_ : defLocation_); }
+    Location declLocation() const { return declLocation_.toLocation(); }
+    Location defLocation() const { return defLocation_.toLocation(); }
+    Location location() const {
+        return (defLocation_.isEmpty() ? declLocation_ : defLocation_).toLocation();
+    }
+    const QString &locationFilePath() const {
+        return (defLocation_.isEmpty() ? declLocation_ : defLocation_).filePath();
+    }
     const Doc &doc() const { return doc_; }
     bool isInAPI() const { return !isPrivate() && !isInternal() && hasDoc(); }
     bool hasDoc() const { return (hadDoc_ || !doc_.isEmpty()); }
@@ -342,7 +347,7 @@ public:
     QmlTypeNode *qmlTypeNode();
     ClassNode *declarativeCppNode();
     const QString &outputSubdirectory() const { return outSubDir_; }
-    virtual void setOutputSubdirectory(const QString &t) { outSubDir_ = t; }
+    virtual void setOutputSubdirectory(const QString &t);
     QString fullDocumentName() const;
     QString qualifyCppName();
     QString qualifyQmlName();
@@ -376,8 +381,8 @@ private:
     Aggregate *parent_;
     SharedCommentNode *sharedCommentNode_;
     QString name_;
-    Location declLocation_;
-    Location defLocation_;
+    CompactLocation declLocation_;
+    CompactLocation defLocation_;
     Doc doc_;
     QMap<LinkType, QPair<QString, QString> > linkMap_;
     QString fileNameBase_;
@@ -483,6 +488,8 @@ public:
     void setOutputSubdirectory(const QString &t) override;
 
     FunctionMap &functionMap() { return functionMap_; }
+    const FunctionMap &functionMap() const { return functionMap_; }
+    const NodeMap &nonfunctionMap() const { return nonfunctionMap_; }
     void findAllFunctions(NodeMapMap &functionIndex);
     void findAllNamespaces(NodeMultiMap &namespaces);
     void findAllAttributions(NodeMultiMap &attributions);
@@ -965,7 +972,7 @@ public:
     static Metaness getMetanessFromTopic(const QString &t);
     static Genus getGenus(Metaness t);
 
-    void setReturnType(const QString &t) { returnType_ = t; }
+    void setReturnType(const QString &t);
     void setParentPath(const QStringList &p) { parentPath_ = p; }
     void setVirtualness(const QString &t);
     void setVirtualness(Virtualness v) { virtualness_ = v; }
@@ -13,6 +13,9 @@ qtHaveModule(qmldevtools-private) {
 
 DEFINES += QT_NO_FOREACH
 
+# Fatal errors end only the failing module in -batch mode; see Location::fatal().
+CONFIG += exceptions
+
 include($$OUT_PWD/../global/qttools-config.pri)
 
 LIBS += $$CLANG_LIBS
@@ -42,6 +45,7 @@ HEADERS += atom.h \
            editdistance.h \
            generator.h \
            helpprojectwriter.h \
+           htmlescape.h \
            htmlgenerator.h \
            location.h \
            loggingcategory.h \
@@ -52,10 +56,13 @@ HEADERS += atom.h \
            qdocdatabase.h \
            qdoctagfiles.h \
            qdocindexfiles.h \
+           qdocindexreader.h \
            quoter.h \
+           scanners.h \
            sections.h \
            separator.h \
            text.h \
+           timings.h \
            tokenizer.h \
            tree.h \
            webxmlgenerator.h \
@@ -74,6 +81,7 @@ SOURCES += atom.cpp \
            editdistance.cpp \
            generator.cpp \
            helpprojectwriter.cpp \
+           htmlescape.cpp \
            htmlgenerator.cpp \
            location.cpp \
            main.cpp \
@@ -84,10 +92,13 @@ SOURCES += atom.cpp \
            qdocdatabase.cpp \
            qdoctagfiles.cpp \
            qdocindexfiles.cpp \
+           qdocindexreader.cpp \
            quoter.cpp \
+           scanners.cpp \
            sections.cpp \
            separator.cpp \
            text.cpp \
+           timings.cpp \
            tokenizer.cpp \
            tree.cpp \
            yyindent.cpp \
@@ -59,7 +59,13 @@ QDocCommandLineParser::QDocCommandLineParser()
       includePathOption("I", "Add dir to the include path for header files.", "path"),
       includePathSystemOption("isystem", "Add dir to the system include path for header files.", "path"),
       frameworkOption("F", "Add macOS framework to the include path for header files.", "framework"),
-      timestampsOption(QStringList() << QStringLiteral("timestamps"))
+      timestampsOption(QStringList() << QStringLiteral("timestamps")),
+      jobsOption(QStringList() << QStringLiteral("jobs")),
+      incrementalOption(QStringList() << QStringLiteral("incremental")),
+      timingsOption(QStringList() << QStringLiteral("timings")),
+      snapshotOption(QStringList() << QStringLiteral("snapshot")),
+      batchOption(QStringList() << QStringLiteral("batch")),
+      pchCacheOption(QStringList() << QStringLiteral("pch-cache"))
 {
     setApplicationDescription(QCoreApplication::translate("qdoc", "Qt documentation generator"));
     addHelpOption();
@@ -142,6 +148,28 @@ QDocCommandLineParser::QDocCommandLineParser()
 
     timestampsOption.setDescription(QCoreApplication::translate("qdoc", "Timestamp each qdoc log line."));
     addOption(timestampsOption);
+
+    jobsOption.setDescription(QCoreApplication::translate("qdoc", "Use up to n worker threads for parsing source files, and write the generated pages on a background thread."));
+    jobsOption.setValueName(QStringLiteral("n"));
+    addOption(jobsOption);
+
+    incrementalOption.setDescription(QCoreApplication::translate("qdoc", "Keep the previous output, parse again only the C++ source files that changed since the previous run, and only rewrite the pages that changed."));
+    addOption(incrementalOption);
+
+    timingsOption.setDescription(QCoreApplication::translate("qdoc", "Write the time spent in each phase, per-file parse times, the slowest pages, and internal counters to <file> as JSON."));
+    timingsOption.setValueName(QStringLiteral("file"));
+    addOption(timingsOption);
+
+    snapshotOption.setDescription(QCoreApplication::translate("qdoc", "In the prepare phase, record the documentation comments of the parsed source files in <file>. In the generate phase, read them from <file> instead of parsing unchanged source files again."));
+    snapshotOption.setValueName(QStringLiteral("file"));
+    addOption(snapshotOption);
+
+    batchOption.setDescription(QCoreApplication::translate("qdoc", "Also read qdoc conf files from standard input, one per line, and process them in this qdoc process. An empty line ends a batch of files, which are processed in the order of their dependencies."));
+    addOption(batchOption);
+
+    pchCacheOption.setDescription(QCoreApplication::translate("qdoc", "Keep the precompiled module headers in <dir> and reuse them in later runs. Overrides the pchcache variable in the qdocconf file."));
+    pchCacheOption.setValueName(QStringLiteral("dir"));
+    addOption(pchCacheOption);
 }
 
 /*!
@@ -185,4 +213,6 @@ void QDocCommandLineParser::process(const QStringList &arguments)
 
     if (isSet(singleExecOption) && isSet(indexDirOption))
         qDebug("WARNING: -indexdir option ignored: Index files are not used in single-exec mode.");
+    if (isSet(singleExecOption) && isSet(batchOption))
+        qDebug("WARNING: -batch option ignored: It cannot be combined with single-exec mode.");
 }
@@ -46,7 +46,9 @@ struct QDocCommandLineParser : public QCommandLineParser
     QCommandLineOption prepareOption, generateOption, logProgressOption;
     QCommandLineOption singleExecOption, writeQaPagesOption;
     QCommandLineOption includePathOption, includePathSystemOption, frameworkOption;
-    QCommandLineOption timestampsOption;
+    QCommandLineOption timestampsOption, jobsOption, incrementalOption;
+    QCommandLineOption timingsOption, snapshotOption, batchOption;
+    QCommandLineOption pchCacheOption;
 };
 
 QT_END_NAMESPACE
@@ -32,6 +32,7 @@
 #include "generator.h"
 #include "qdocindexfiles.h"
 #include "qdoctagfiles.h"
+#include "timings.h"
 #include "tree.h"
 
 #include <QtCore/qdebug.h>
@@ -90,6 +91,8 @@ QDocForest::~QDocForest()
 {
     for (int i=0; i<searchOrder_.size(); ++i)
         delete searchOrder_.at(i);
+    qDeleteAll(pendingIndexes_);
+    pendingIndexes_.clear();
     forest_.clear();
     searchOrder_.clear();
     indexSearchOrder_.clear();
@@ -104,6 +107,7 @@ QDocForest::~QDocForest()
  */
 NamespaceNode *QDocForest::firstRoot()
 {
+    loadAllIndexes();
     currentIndex_ = 0;
     return (!searchOrder().isEmpty() ? searchOrder()[0]->root() : nullptr);
 }
@@ -122,10 +126,13 @@ NamespaceNode *QDocForest::nextRoot()
 /*!
   Initializes the forest prior to a traversal and
   returns a pointer to the primary tree. If the
-  forest is empty, it returns 0.
+  forest is empty, it returns 0. A traversal visits
+  every tree, so the index trees that have not been
+  read yet are read first.
  */
 Tree *QDocForest::firstTree()
 {
+    loadAllIndexes();
     currentIndex_ = 0;
     return (!searchOrder().isEmpty() ? searchOrder()[0] : nullptr);
 }
@@ -302,6 +309,146 @@ void QDocForest::newPrimaryTree(const QString &module)
     primaryTree_ = new Tree(module, qdb_);
 }
 
+/*!
+  \fn void QDocForest::loadIndexesFor(const QString &name)
+
+  Reads the index trees that have not been read yet and that
+  may contain a node, target, or collection called \a name.
+  Every search of the forest calls this function first, or
+  loadIndexesForPath() with the path it searches for, so that
+  an index is read only when it can contribute to a search.
+ */
+
+/*!
+  Does the work of loadIndexesFor() for \a name, after it has
+  checked that some index trees are pending.
+ */
+void QDocForest::loadPendingIndexes(const QString &name)
+{
+    const QStringList keys = IndexNameTable::lookupKeys(name);
+    if (keys.isEmpty())
+        return;
+    QVector<Tree *> trees;
+    for (auto it = pendingIndexes_.cbegin(); it != pendingIndexes_.cend(); ++it) {
+        if (it.value()->containsAny(keys))
+            trees.append(it.key());
+    }
+    for (auto *tree : qAsConst(trees))
+        loadIndex(tree);
+}
+
+/*!
+  Reads the index trees that have not been read yet and that
+  contain a proxy node for an aggregate of the primary tree.
+  QDocDatabase::resolveProxies() needs them.
+ */
+void QDocForest::loadIndexesForProxies()
+{
+    QVector<Tree *> trees;
+    for (auto it = pendingIndexes_.cbegin(); it != pendingIndexes_.cend(); ++it) {
+        for (const auto &name : qAsConst(it.value()->proxies)) {
+            if (primaryTree_->findAggregate(name)) {
+                trees.append(it.key());
+                break;
+            }
+        }
+    }
+    for (auto *tree : qAsConst(trees))
+        loadIndex(tree);
+}
+
+/*!
+  Reads the index trees that have not been read yet and that
+  contain a class derived from a class of the primary tree, so
+  that the classes derived from it in other modules are the same
+  whichever indexes earlier searches happened to read.
+  QDocDatabase::resolveBaseClasses() needs them.
+ */
+void QDocForest::loadIndexesForBaseClasses()
+{
+    QVector<Tree *> trees;
+    for (auto it = pendingIndexes_.cbegin(); it != pendingIndexes_.cend(); ++it) {
+        for (const auto &name : qAsConst(it.value()->baseClasses)) {
+            if (primaryTree_->findClassNode(name.split(QLatin1String("::")))) {
+                trees.append(it.key());
+                break;
+            }
+        }
+    }
+    for (auto *tree : qAsConst(trees))
+        loadIndex(tree);
+}
+
+/*!
+  Reads the index trees that have not been read yet and that
+  contain a namespace with the same name as one of the keys of
+  \a namespaces. Returns \c true if any tree was read, in which
+  case the caller must look for namespaces again.
+ */
+bool QDocForest::loadIndexesForNamespaces(const NodeMultiMap &namespaces)
+{
+    QVector<Tree *> trees;
+    for (auto it = pendingIndexes_.cbegin(); it != pendingIndexes_.cend(); ++it) {
+        for (const auto &name : qAsConst(it.value()->namespaces)) {
+            if (namespaces.contains(name)) {
+                trees.append(it.key());
+                break;
+            }
+        }
+    }
+    for (auto *tree : qAsConst(trees))
+        loadIndex(tree);
+    return !trees.isEmpty();
+}
+
+/*!
+  Reads all the index trees that have not been read yet.
+ */
+void QDocForest::loadAllIndexes()
+{
+    while (!pendingIndexes_.isEmpty())
+        loadIndex(pendingIndexes_.cbegin().key());
+}
+
+/*!
+  Reads the index file for \a tree, if it has not been read yet.
+  The tree is made the primary tree while it is read, because
+  reading an index adds targets and collection members to the
+  primary tree, just as when the index files are read before
+  the primary tree is created.
+ */
+void QDocForest::loadIndex(Tree *tree)
+{
+    IndexNameTable *table = pendingIndexes_.take(tree);
+    if (table == nullptr)
+        return;
+    Tree *primaryTree = primaryTree_;
+    primaryTree_ = tree;
+    QDocIndexFiles::qdocIndexFiles()->loadIndexTree(*table, tree);
+    primaryTree_ = primaryTree;
+    delete table;
+
+    tree->clearPathIndex();
+    tree->resolveBaseClasses(tree->root());
+    qdb_->clearLinkCache();
+    ++loadCount_;
+    Timings::increment(Timings::IndexesLoadedOnDemand);
+}
+
+/*!
+  Returns the trees of the search order whose index files
+  have been read.
+ */
+QVector<Tree *> QDocForest::loadedTrees()
+{
+    QVector<Tree *> trees;
+    for (auto *tree : searchOrder()) {
+        if (!pendingIndexes_.contains(tree))
+            trees.append(tree);
+    }
+    return trees;
+}
+
 /*!
   Searches through the forest for a node named \a targetPath
   and returns a pointer to it if found. The \a relative node
@@ -320,6 +467,7 @@ const Node *QDocForest::findNodeForTarget(QStringList &targetPath,
     int flags = SearchBaseClasses | SearchEnumValues;
 
     QString entity = targetPath.takeFirst();
+    loadIndexesFor(entity);
     QStringList entityPath = entity.split("::");
 
     QString target;
@@ -405,6 +553,7 @@ const FunctionNode *QDocForest::findFunctionNode(const QStringList &path,
                                                  const Node *relative,
                                                  Node::Genus genus)
 {
+    loadIndexesForPath(path);
     for (const auto *tree : searchOrder()) {
         const FunctionNode *fn = tree->findFunctionNode(path, parameters, relative, genus);
         if (fn)
@@ -433,6 +582,8 @@ NodeMultiMap QDocDatabase::examples_;
 NodeMapMap QDocDatabase::newClassMaps_;
 NodeMapMap QDocDatabase::newQmlTypeMaps_;
 NodeMultiMapMap QDocDatabase::newSinceMaps_;
+QSet<QString> QDocDatabase::strings_;
+quint64 QDocDatabase::nodeCount_ = 0;
 
 /*!
   Constructs the singleton qdoc database object. The singleton
@@ -451,7 +602,7 @@ NodeMultiMapMap QDocDatabase::newSinceMaps_;
   is read exactly once.
  */
 QDocDatabase::QDocDatabase()
-    : showInternal_(false), singleExec_(false), forest_(this)
+    : showInternal_(false), singleExec_(false), forest_(this), namespaceLoadCount_(0)
 {
     // nothing
 }
@@ -480,7 +631,10 @@ QDocDatabase *QDocDatabase::qdocDB()
 }
 
 /*!
-  Destroys the singleton.
+  Destroys the singleton. The maps of nodes that are shared by
+  all instances are cleared too, because their nodes are deleted
+  with the trees of the singleton. qdoc can then process another
+  module from scratch in the same process.
  */
 void QDocDatabase::destroyQdocDB()
 {
@@ -488,6 +642,50 @@ void QDocDatabase::destroyQdocDB()
         delete qdocDB_;
         qdocDB_ = nullptr;
     }
+    QDocIndexFiles::destroyQDocIndexFiles();
+    obsoleteClasses_.clear();
+    classesWithObsoleteMembers_.clear();
+    obsoleteQmlTypes_.clear();
+    qmlTypesWithObsoleteMembers_.clear();
+    cppClasses_.clear();
+    qmlBasicTypes_.clear();
+    qmlTypes_.clear();
+    examples_.clear();
+    newClassMaps_.clear();
+    newQmlTypeMaps_.clear();
+    newSinceMaps_.clear();
+    strings_.clear();
+}
+
+/*!
+  \fn quint64 QDocDatabase::nodeCount()
+
+  Returns the number of nodes created so far. The code parsers
+  compare it before and after visiting a file to learn whether
+  the visit created nodes.
+ */
+
+/*!
+  Returns a string equal to \a str that shares its data with
+  every other string interned by this function. Nodes intern
+  the strings that repeat across many of them, such as names,
+  module names, and \c since values, so that each distinct value
+  is stored once. The pool lives as long as the database.
+
+  When \a str holds the only reference to its data, that data is
+  freed once the caller keeps the interned string instead, and its
+  size is counted as saved in the timings.
+ */
+QString QDocDatabase::intern(const QString &str)
+{
+    if (str.isEmpty())
+        return str;
+    auto it = strings_.constFind(str);
+    if (it == strings_.constEnd())
+        return *strings_.insert(str);
+    if (it->constData() != str.constData() && str.isDetached())
+        Timings::add(Timings::InternedBytesSaved, str.capacity() * qint64(sizeof(QChar)));
+    return *it;
 }
 
 /*!
@@ -1142,15 +1340,15 @@ void QDocDatabase::resolveStuff() {
     }
     if (Generator::dualExec())
         QDocIndexFiles::destroyQDocIndexFiles();
+    clearCaches();
 }
 
 void QDocDatabase::resolveBaseClasses()
 {
-    Tree *t = forest_.firstTree();
-    while (t) {
+    forest_.loadIndexesForBaseClasses();
+    const QVector<Tree *> trees = forest_.loadedTrees();
+    for (auto *t : trees)
         t->resolveBaseClasses(t->root());
-        t = forest_.nextTree();
-    }
 }
 
 /*!
@@ -1159,6 +1357,7 @@ void QDocDatabase::resolveBaseClasses()
  */
 NodeMultiMap &QDocDatabase::getNamespaces()
 {
+    forest_.loadAllIndexes();
     resolveNamespaces();
     return namespaceIndex_;
 }
@@ -1170,19 +1369,31 @@ NodeMultiMap &QDocDatabase::getNamespaces()
   a multimap. Then it combines all the namespace nodes that
   have the same name into a single namespace node of that
   name and inserts that combined namespace node into an index.
+
+  Index trees that have not been read yet are read if they have
+  a namespace with the same name as a namespace that has been
+  found. The namespaces of the trees that are still not read
+  then have names that are not in the index, so when a search
+  reads one of those trees later, its namespaces are combined
+  and added to the index by the next call.
  */
 void QDocDatabase::resolveNamespaces()
 {
-    if (!namespaceIndex_.isEmpty())
+    if (!namespaceIndex_.isEmpty() && namespaceLoadCount_ == forest_.loadCount())
         return;
     NodeMultiMap namespaceMultimap;
-    Tree *t = forest_.firstTree();
-    while (t) {
-        t->root()->findAllNamespaces(namespaceMultimap);
-        t = forest_.nextTree();
-    }
+    do {
+        namespaceMultimap.clear();
+        const QVector<Tree *> trees = forest_.loadedTrees();
+        for (auto *t : trees)
+            t->root()->findAllNamespaces(namespaceMultimap);
+    } while (forest_.loadIndexesForNamespaces(namespaceMultimap));
+    namespaceLoadCount_ = forest_.loadCount();
+
     const QList<QString> keys = namespaceMultimap.uniqueKeys();
     for (const QString &key : keys) {
+        if (namespaceIndex_.contains(key))
+            continue;
         NamespaceNode *ns = nullptr;
         NamespaceNode *somewhere = nullptr;
         const NodeList namespaces = namespaceMultimap.values(key);
@@ -1257,14 +1468,18 @@ void QDocDatabase::resolveNamespaces()
   documented in the module represented by the Tree containing
   the proxy node but that are related to the node we found in
   the primary tree.
+
+  Only the index trees that have been read, or that have proxy
+  nodes for aggregates of the primary tree, are traversed.
  */
 void QDocDatabase::resolveProxies()
 {
-    // The first tree is the primary tree.
-    // Skip the primary tree.
-    Tree *t = forest_.firstTree();
-    t = forest_.nextTree();
-    while (t) {
+    forest_.loadIndexesForProxies();
+    const QVector<Tree *> trees = forest_.loadedTrees();
+    for (auto *t : trees) {
+        // Skip the primary tree.
+        if (t == primaryTree())
+            continue;
         const NodeList &proxies = t->proxies();
         if (!proxies.isEmpty()) {
             for (auto *node : proxies) {
@@ -1276,7 +1491,6 @@ void QDocDatabase::resolveProxies()
                 }
             }
         }
-        t = forest_.nextTree();
     }
 }
 
@@ -1349,6 +1563,7 @@ const Node *QDocDatabase::findNodeForTarget(const QString &target, const Node *r
     else {
         QStringList path = target.split("::");
         int flags = SearchBaseClasses | SearchEnumValues;
+        forest_.loadIndexesForPath(path);
         for (const auto *tree : searchOrder()) {
             const Node *n = tree->findNode(path, relative, flags, Node::DontCare);
             if (n)
@@ -1360,6 +1575,35 @@ const Node *QDocDatabase::findNodeForTarget(const QString &target, const Node *r
     return node;
 }
 
+/*!
+  Returns the names of up to three link targets that are close
+  to the \a target of a link that could not be resolved, for
+  suggesting them in the warning.
+
+  The names are kept in a BK-tree, which is filled on the first
+  call and takes in the trees that have been loaded since on the
+  later calls, so an index that is never searched is not loaded
+  just to suggest names from it.
+ */
+QStringList QDocDatabase::nearestLinkTargets(const QString &target)
+{
+    QString name = target;
+    const int hash = name.indexOf(QLatin1Char('#'));
+    if (hash != -1)
+        name.truncate(hash);
+    if (name.isEmpty())
+        return QStringList();
+
+    const auto trees = forest_.loadedTrees();
+    for (const auto *tree : trees) {
+        if (!namedTrees_.contains(tree)) {
+            namedTrees_.insert(tree);
+            tree->addLinkTargetNames(&linkTargetNames_, showInternal_);
+        }
+    }
+    return linkTargetNames_.nearest(name);
+}
+
 /*!
   Generates a tag file and writes it to \a name.
  */
@@ -1396,6 +1640,7 @@ void QDocDatabase::generateIndex(const QString &fileName, const QString &url, co
 {
     QString t = fileName.mid(fileName.lastIndexOf(QChar('/'))+1);
     primaryTree()->setIndexFileName(t);
+    Timings::Phase timing(QLatin1String("index writing"));
     QDocIndexFiles::qdocIndexFiles()->generateIndex(fileName, url, title, g);
     QDocIndexFiles::destroyQDocIndexFiles();
 }
@@ -1437,11 +1682,32 @@ Node *QDocDatabase::findNodeInOpenNamespace(QStringList &path, bool (Node::*isMa
   Finds all the collection nodes of the specified \a type
   and merges them into the collection node map \a cnm. Nodes
   that match the \a relative node are not included.
+
+  The result depends only on the trees, so it is computed once
+  for each \a type and \a relative and then shared by all the
+  generators.
  */
 void QDocDatabase::mergeCollections(Node::NodeType type, CNMap &cnm, const Node *relative)
+{
+    const auto key = qMakePair(int(type), relative);
+    auto it = mergedCollectionMaps_.constFind(key);
+    if (it == mergedCollectionMaps_.constEnd()) {
+        CNMap merged;
+        collectMergedCollections(type, merged, relative);
+        it = mergedCollectionMaps_.insert(key, merged);
+    }
+    cnm = it.value();
+}
+
+/*!
+  Does the work of mergeCollections() for \a type, \a cnm,
+  and \a relative.
+ */
+void QDocDatabase::collectMergedCollections(Node::NodeType type, CNMap &cnm, const Node *relative)
 {
     cnm.clear();
     CNMultiMap cnmm;
+    forest_.loadAllIndexes();
     for (auto *tree : searchOrder()) {
         CNMap *m = tree->getCollectionMap(type);
         if (m && !m->isEmpty()) {
@@ -1501,9 +1767,16 @@ void QDocDatabase::mergeCollections(Node::NodeType type, CNMap &cnm, const Node
   For QML and JS modules, only nodes with matching
   module identifiers are merged to avoid merging
   modules with different (major) versions.
+
+  Each collection is merged only once, however many pages
+  and generators ask for it.
  */
 void QDocDatabase::mergeCollections(CollectionNode *c)
 {
+    if (mergedCollections_.contains(c))
+        return;
+    mergedCollections_.insert(c);
+    forest_.loadIndexesFor(c->name());
     for (auto *tree : searchOrder()) {
         CollectionNode *cn = tree->getCollection(c->name(), c->nodeType());
         if (cn && cn != c) {
@@ -1524,8 +1797,54 @@ void QDocDatabase::mergeCollections(CollectionNode *c)
   after the node is found. The node is returned as well as the
   \a ref. If the returned node pointer is null, \a ref is not
   valid.
+
+  The result is remembered for the atom's string and \a relative,
+  so resolving the same link again from the same node is a hash
+  lookup.
  */
 const Node *QDocDatabase::findNodeForAtom(const Atom *a, const Node *relative, QString &ref)
+{
+    LinkCacheKey key { a->string(), relative, nullptr, Node::DontCare };
+    if (a->isLinkAtom()) {
+        Atom *atom = const_cast<Atom *>(a);
+        key.domain_ = atom->domain();
+        key.genus_ = atom->genus();
+    }
+    Timings::increment(Timings::LinkLookups);
+    auto it = linkCache_.constFind(key);
+    if (it != linkCache_.constEnd()) {
+        Timings::increment(Timings::LinkCacheHits);
+    } else {
+        LinkCacheRec rec;
+        rec.node_ = resolveAtom(a, relative, rec.ref_);
+        it = linkCache_.insert(key, rec);
+    }
+    ref = it->ref_;
+    return it->node_;
+}
+
+/*!
+  Discards the links resolved by findNodeForAtom(), the merged
+  collections, and the path indexes of the trees. This must be
+  called whenever the trees or the search order change after
+  the database has been queried.
+ */
+void QDocDatabase::clearCaches()
+{
+    linkCache_.clear();
+    mergedCollections_.clear();
+    mergedCollectionMaps_.clear();
+    for (auto *tree : qAsConst(forest_.forest_))
+        tree->clearPathIndex();
+    if (forest_.primaryTree())
+        forest_.primaryTree()->clearPathIndex();
+}
+
+/*!
+  Does the work of findNodeForAtom() for \a a, \a relative,
+  and \a ref, without consulting the cache of resolved links.
+ */
+const Node *QDocDatabase::resolveAtom(const Atom *a, const Node *relative, QString &ref)
 {
     const Node *node = nullptr;
 
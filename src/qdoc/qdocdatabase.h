@@ -30,11 +30,14 @@
 #define QDOCDATABASE_H
 
 #include "config.h"
+#include "editdistance.h"
 #include "text.h"
 #include "tree.h"
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmap.h>
+#include <QtCore/qset.h>
 #include <QtCore/qstring.h>
 
 QT_BEGIN_NAMESPACE
@@ -44,6 +47,7 @@ typedef QMap<Text, const Node *> TextToNodeMap;
 class Atom;
 class Generator;
 class QDocDatabase;
+struct IndexNameTable;
 
 enum FindFlag {
     SearchBaseClasses = 0x1,
@@ -52,12 +56,38 @@ enum FindFlag {
     IgnoreModules = 0x8
 };
 
+struct LinkCacheKey
+{
+    QString target_;
+    const Node *relative_;
+    const Tree *domain_;
+    Node::Genus genus_;
+};
+
+inline bool operator==(const LinkCacheKey &a, const LinkCacheKey &b)
+{
+    return a.relative_ == b.relative_ && a.domain_ == b.domain_
+        && a.genus_ == b.genus_ && a.target_ == b.target_;
+}
+
+inline uint qHash(const LinkCacheKey &key, uint seed = 0)
+{
+    return qHash(key.target_, seed) ^ qHash(key.relative_, seed)
+        ^ qHash(key.domain_, seed) ^ uint(key.genus_);
+}
+
+struct LinkCacheRec
+{
+    const Node *node_;
+    QString ref_;
+};
+
 class QDocForest
 {
   private:
     friend class QDocDatabase;
     QDocForest(QDocDatabase *qdb)
-        : qdb_(qdb), primaryTree_(nullptr), currentIndex_(0) { }
+        : qdb_(qdb), primaryTree_(nullptr), currentIndex_(0), loadCount_(0) { }
     ~QDocForest();
 
     NamespaceNode *firstRoot();
@@ -65,7 +95,12 @@ class QDocForest
     Tree *firstTree();
     Tree *nextTree();
     Tree *primaryTree() { return primaryTree_; }
-    Tree *findTree(const QString &t) { return forest_.value(t); }
+    Tree *findTree(const QString &t) {
+        Tree *tree = forest_.value(t);
+        if (tree && !pendingIndexes_.isEmpty())
+            loadIndex(tree);
+        return tree;
+    }
     QStringList keys() {
         return forest_.keys();
     }
@@ -87,6 +122,7 @@ class QDocForest
                          const Node *relative,
                          int findFlags,
                          Node::Genus genus) {
+        loadIndexesForPath(path);
         for (const auto *tree : searchOrder()) {
             const Node *n = tree->findNode(path, relative, findFlags, genus);
             if (n)
@@ -97,6 +133,7 @@ class QDocForest
     }
 
     Node *findNodeByNameAndType(const QStringList &path, bool (Node::*isMatch) () const) {
+        loadIndexesForPath(path);
         for (const auto *tree : searchOrder()) {
             Node *n = tree->findNodeByNameAndType(path, isMatch);
             if (n)
@@ -106,6 +143,7 @@ class QDocForest
     }
 
     ClassNode *findClassNode(const QStringList &path) {
+        loadIndexesForPath(path);
         for (const auto *tree : searchOrder()) {
             ClassNode *n = tree->findClassNode(path);
             if (n)
@@ -115,6 +153,7 @@ class QDocForest
     }
 
     Node *findNodeForInclude(const QStringList &path) {
+        loadIndexesForPath(path);
         for (const auto *tree : searchOrder()) {
             Node *n = tree->findNodeForInclude(path);
             if (n)
@@ -137,6 +176,7 @@ class QDocForest
         int flags = SearchBaseClasses | SearchEnumValues | TypesOnly;
         if (relative && genus == Node::DontCare && relative->genus() != Node::DOC)
             genus = relative->genus();
+        loadIndexesForPath(path);
         for (const auto *tree : searchOrder()) {
             const Node *n = tree->findNode(path, relative, flags, genus);
             if (n)
@@ -148,6 +188,7 @@ class QDocForest
 
     const PageNode *findPageNodeByTitle(const QString &title)
     {
+        loadIndexesFor(title);
         for (const auto *tree : searchOrder()) {
             const PageNode *n = tree->findPageNodeByTitle(title);
             if (n)
@@ -158,6 +199,7 @@ class QDocForest
 
     const CollectionNode *getCollectionNode(const QString &name, Node::NodeType type)
     {
+        loadIndexesFor(name);
         for (auto *tree : searchOrder()) {
             const CollectionNode *cn = tree->getCollection(name, type);
             if (cn)
@@ -168,6 +210,7 @@ class QDocForest
 
     QmlTypeNode *lookupQmlType(const QString &name)
     {
+        loadIndexesFor(name);
         for (const auto *tree : searchOrder()) {
             QmlTypeNode *qcn = tree->lookupQmlType(name);
             if (qcn)
@@ -178,6 +221,7 @@ class QDocForest
 
     Aggregate *lookupQmlBasicType(const QString &name)
     {
+        loadIndexesFor(name);
         for (const auto *tree : searchOrder()) {
             Aggregate *a = tree->lookupQmlBasicType(name);
             if (a)
@@ -197,14 +241,34 @@ class QDocForest
     void setPrimaryTree(const QString &t);
     NamespaceNode *newIndexTree(const QString &module);
 
+    void addPendingIndex(Tree *tree, IndexNameTable *table) { pendingIndexes_.insert(tree, table); }
+    void loadIndexesFor(const QString &name) {
+        if (!pendingIndexes_.isEmpty())
+            loadPendingIndexes(name);
+    }
+    void loadIndexesForPath(const QStringList &path) {
+        if (!pendingIndexes_.isEmpty() && !path.isEmpty())
+            loadPendingIndexes(path.last());
+    }
+    void loadPendingIndexes(const QString &name);
+    void loadIndexesForProxies();
+    void loadIndexesForBaseClasses();
+    bool loadIndexesForNamespaces(const NodeMultiMap &namespaces);
+    void loadAllIndexes();
+    void loadIndex(Tree *tree);
+    QVector<Tree *> loadedTrees();
+    int loadCount() const { return loadCount_; }
+
   private:
     QDocDatabase *qdb_;
     Tree *primaryTree_;
     int currentIndex_;
+    int loadCount_;
     QMap<QString, Tree *> forest_;
     QVector<Tree *> searchOrder_;
     QVector<Tree *> indexSearchOrder_;
     QVector<QString> moduleNames_;
+    QHash<Tree *, IndexNameTable *> pendingIndexes_;
 };
 
 class QDocDatabase
@@ -214,6 +278,9 @@ class QDocDatabase
   public:
     static QDocDatabase *qdocDB();
     static void destroyQdocDB();
+    static QString intern(const QString &str);
+    static void countNode() { ++nodeCount_; }
+    static quint64 nodeCount() { return nodeCount_; }
     ~QDocDatabase();
 
     Tree *findTree(const QString &t) { return forest_.findTree(t); }
@@ -375,15 +442,34 @@ class QDocDatabase
     void newPrimaryTree(const QString &module) { forest_.newPrimaryTree(module); }
     void setPrimaryTree(const QString &t) { forest_.setPrimaryTree(t); }
     NamespaceNode *newIndexTree(const QString &module) { return forest_.newIndexTree(module); }
+    void addPendingIndex(Tree *tree, IndexNameTable *table) { forest_.addPendingIndex(tree, table); }
     const QVector<Tree *> &searchOrder() { return forest_.searchOrder(); }
-    void setLocalSearch() { forest_.searchOrder_ = QVector<Tree *>(1, primaryTree()); }
-    void setSearchOrder(const QVector<Tree *> &searchOrder) { forest_.searchOrder_ = searchOrder; }
-    void setSearchOrder(QStringList &t) { forest_.setSearchOrder(t); }
+    void setLocalSearch() {
+        forest_.searchOrder_ = QVector<Tree *>(1, primaryTree());
+        clearCaches();
+    }
+    void setSearchOrder(const QVector<Tree *> &searchOrder) {
+        forest_.searchOrder_ = searchOrder;
+        clearCaches();
+    }
+    void setSearchOrder(QStringList &t) {
+        forest_.setSearchOrder(t);
+        clearCaches();
+    }
     void mergeCollections(Node::NodeType type, CNMap &cnm, const Node *relative);
     void mergeCollections(CollectionNode *c);
-    void clearSearchOrder() { forest_.clearSearchOrder(); }
+    void clearSearchOrder() {
+        forest_.clearSearchOrder();
+        clearCaches();
+    }
     void incrementLinkCount(const Node *t) { t->tree()->incrementLinkCount(); }
-    void clearLinkCounts() { forest_.clearLinkCounts(); }
+    void clearLinkCounts() {
+        forest_.clearLinkCounts();
+        clearCaches();
+    }
+    void clearCaches();
+    void clearLinkCache() { linkCache_.clear(); }
+    QStringList nearestLinkTargets(const QString &target);
     void printLinkCounts(const QString &t) { forest_.printLinkCounts(t); }
     QString getLinkCounts(QStringList &strings, QVector<int> &counts) {
         return forest_.getLinkCounts(strings, counts);
@@ -411,13 +497,15 @@ class QDocDatabase
                          Node::Genus genus) {
         return forest_.findNode(path, relative, findFlags, genus);
     }
+    const Node *resolveAtom(const Atom *atom, const Node *relative, QString &ref);
+    void collectMergedCollections(Node::NodeType type, CNMap &cnm, const Node *relative);
     void processForest(void (QDocDatabase::*) (Aggregate*));
     bool isLoaded(const QString &t) { return forest_.isLoaded(t); }
     static void initializeDB();
 
  private:
     QDocDatabase();
-    QDocDatabase(QDocDatabase const &) : showInternal_(false), forest_(this) { }
+    QDocDatabase(QDocDatabase const &) : showInternal_(false), forest_(this), namespaceLoadCount_(0) { }
     QDocDatabase& operator=(QDocDatabase const &);
 
  public:
@@ -438,6 +526,8 @@ class QDocDatabase
     static NodeMapMap newClassMaps_;
     static NodeMapMap newQmlTypeMaps_;
     static NodeMultiMapMap newSinceMaps_;
+    static QSet<QString> strings_;
+    static quint64 nodeCount_;
 
     bool showInternal_;
     bool singleExec_;
@@ -445,10 +535,16 @@ class QDocDatabase
     QDocForest forest_;
 
     NodeMultiMap namespaceIndex_;
+    int namespaceLoadCount_;
     NodeMultiMap attributions_;
     NodeMapMap functionIndex_;
     TextToNodeMap legaleseTexts_;
     QSet<QString> openNamespaces_;
+    QHash<LinkCacheKey, LinkCacheRec> linkCache_;
+    NearestNameIndex linkTargetNames_;
+    QSet<const Tree *> namedTrees_;
+    QSet<const CollectionNode *> mergedCollections_;
+    QHash<QPair<int, const Node *>, CNMap> mergedCollectionMaps_;
 };
 
 QT_END_NAMESPACE
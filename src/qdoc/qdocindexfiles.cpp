@@ -30,10 +30,13 @@
 
 #include "atom.h"
 #include "config.h"
+#include "doc.h"
 #include "generator.h"
 #include "location.h"
 #include "qdocdatabase.h"
+#include "qdocindexreader.h"
 #include "qdoctagfiles.h"
+#include "timings.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qxmlstream.h>
@@ -105,53 +108,84 @@ void QDocIndexFiles::destroyQDocIndexFiles()
 
 /*!
   Reads and parses the list of index files in \a indexFiles.
+
+  An index that can be read in the binary format is only scanned
+  for the names it defines. Its tree stays empty until a search
+  asks for one of those names, see QDocForest::loadIndexesFor().
  */
 void QDocIndexFiles::readIndexes(const QStringList &indexFiles)
 {
     for (const QString &file : indexFiles) {
         QString msg = "Loading index file: " + file;
         Location::logToStdErr(msg);
-        readIndexFile(file);
+        if (!scanIndexFile(file))
+            readIndexFile(file);
     }
 }
 
 static bool readingRoot = true;
 
 /*!
-  Reads and parses the index file at \a path.
+  Returns the URL of the documentation of the index at \a path,
+  whose INDEX element has the attributes \a attrs.
  */
-void QDocIndexFiles::readIndexFile(const QString &path)
+static QString indexUrlFor(const QXmlStreamAttributes &attrs, const QString &path)
 {
-    QFile file(path);
-    if (!file.open(QFile::ReadOnly)) {
+    // Generate a relative URL between the install dir and the index file
+    // when the -installdir command line option is set.
+    if (Config::installDir.isEmpty())
+        return attrs.value(QLatin1String("url")).toString();
+
+    // Use a fake directory, since we will copy the output to a sub directory of
+    // installDir when using "make install". This is just for a proper relative path.
+    //QDir installDir(path.section('/', 0, -3) + "/outputdir");
+    QDir installDir(path.section('/', 0, -3) + '/' + Generator::outputSubdir());
+    return installDir.relativeFilePath(path).section('/', 0, -2);
+}
+
+/*!
+  Opens the index file at \a path and returns a reader for it, or
+  \c nullptr if it cannot be read. If an up to date binary index
+  was written next to it, that is read instead. When index caching
+  is enabled, the index is read from memory if an earlier module
+  already loaded it. Otherwise the XML index is read through
+  \a file.
+ */
+IndexReader *QDocIndexFiles::openIndexFile(const QString &path, QFile *file)
+{
+    QScopedPointer<BinaryIndexReader> binaryReader(new BinaryIndexReader);
+    const bool opened = BinaryIndexReader::cachingEnabled()
+            ? binaryReader->openCached(path)
+            : binaryReader->open(BinaryIndexReader::binaryPath(path), path);
+    if (opened)
+        return binaryReader.take();
+
+    file->setFileName(path);
+    if (!file->open(QFile::ReadOnly)) {
         qWarning() << "Could not read index file" << path;
-        return;
+        return nullptr;
     }
+    return new XmlIndexReader(file);
+}
 
-    QXmlStreamReader reader(&file);
-    reader.setNamespaceProcessing(false);
-
-    if (!reader.readNextStartElement())
+/*!
+  Reads and parses the index file at \a path.
+ */
+void QDocIndexFiles::readIndexFile(const QString &path)
+{
+    QFile file;
+    QScopedPointer<IndexReader> reader(openIndexFile(path, &file));
+    if (!reader)
         return;
 
-    if (reader.name() != QLatin1String("INDEX"))
+    if (!reader->readNextStartElement())
         return;
 
-    QXmlStreamAttributes attrs = reader.attributes();
+    if (reader->name() != QLatin1String("INDEX"))
+        return;
 
-    // Generate a relative URL between the install dir and the index file
-    // when the -installdir command line option is set.
-    QString indexUrl;
-    if (Config::installDir.isEmpty()) {
-        indexUrl = attrs.value(QLatin1String("url")).toString();
-    }
-    else {
-        // Use a fake directory, since we will copy the output to a sub directory of
-        // installDir when using "make install". This is just for a proper relative path.
-        //QDir installDir(path.section('/', 0, -3) + "/outputdir");
-        QDir installDir(path.section('/', 0, -3) + '/' + Generator::outputSubdir());
-        indexUrl = installDir.relativeFilePath(path).section('/', 0, -2);
-    }
+    QXmlStreamAttributes attrs = reader->attributes();
+    QString indexUrl = indexUrlFor(attrs, path);
     project_ = attrs.value(QLatin1String("project")).toString();
     QString indexTitle = attrs.value(QLatin1String("indexTitle")).toString();
     basesList_.clear();
@@ -161,9 +195,9 @@ void QDocIndexFiles::readIndexFile(const QString &path)
 
     // Scan all elements in the XML file, constructing a map that contains
     // base classes for each class found.
-    while (reader.readNextStartElement()) {
+    while (reader->readNextStartElement()) {
         readingRoot = true;
-        readIndexSection(reader, root, indexUrl);
+        readIndexSection(*reader, root, indexUrl);
     }
 
     // Now that all the base classes have been found for this index,
@@ -171,11 +205,181 @@ void QDocIndexFiles::readIndexFile(const QString &path)
     resolveIndex();
 }
 
+/*!
+  Creates an empty tree for the index file at \a path and records
+  the names that its nodes, targets and collections can be found
+  by, without creating any nodes. The tree is filled by
+  loadIndexTree() when one of the names is searched for.
+
+  Only binary indexes are scanned, because scanning an XML index
+  costs about as much as reading it. Returns \c false if there is
+  no usable binary index, in which case the index must be read
+  with readIndexFile().
+ */
+bool QDocIndexFiles::scanIndexFile(const QString &path)
+{
+    BinaryIndexReader reader;
+    const bool opened = BinaryIndexReader::cachingEnabled()
+            ? reader.openCached(path)
+            : reader.open(BinaryIndexReader::binaryPath(path), path);
+    if (!opened || !reader.readNextStartElement() || reader.name() != QLatin1String("INDEX"))
+        return false;
+
+    const QXmlStreamAttributes attrs = reader.attributes();
+    IndexNameTable *table = new IndexNameTable;
+    table->path = path;
+    table->indexUrl = indexUrlFor(attrs, path);
+
+    static const QLatin1String nameAttributes[] = {
+        QLatin1String("name"), QLatin1String("title"), QLatin1String("fulltitle"),
+        QLatin1String("href"), QLatin1String("module")
+    };
+    while (reader.readNext()) {
+        if (reader.isEndElement())
+            continue;
+        const QXmlStreamAttributes attributes = reader.attributes();
+        for (const auto &attribute : nameAttributes)
+            table->addName(attributes.value(attribute).toString());
+        const QStringRef groups = attributes.value(QLatin1String("groups"));
+        if (!groups.isEmpty()) {
+            const auto groupNames = groups.split(QLatin1Char(','));
+            for (const auto &group : groupNames)
+                table->addName(group.toString());
+        }
+        const QStringRef elementName = reader.name();
+        if (elementName == QLatin1String("namespace"))
+            table->namespaces.insert(attributes.value(QLatin1String("name")).toString());
+        else if (elementName == QLatin1String("proxy"))
+            table->proxies.insert(attributes.value(QLatin1String("name")).toString());
+
+        // A base class named without its namespace is in the namespace
+        // of the derived class; see Tree::resolveBaseClasses().
+        const QStringRef bases = attributes.value(QLatin1String("bases"));
+        if (!bases.isEmpty()) {
+            const QStringRef fullName = attributes.value(QLatin1String("fullname"));
+            const int i = fullName.lastIndexOf(QLatin1String("::"));
+            const QString scope = (i > 0) ? fullName.left(i + 2).toString() : QString();
+            const auto baseNames = bases.split(QLatin1Char(','));
+            for (const auto &base : baseNames) {
+                table->baseClasses.insert(base.toString());
+                if (!scope.isEmpty())
+                    table->baseClasses.insert(scope + base);
+            }
+        }
+    }
+
+    NamespaceNode *root = qdb_->newIndexTree(attrs.value(QLatin1String("project")).toString());
+    root->tree()->setIndexTitle(attrs.value(QLatin1String("indexTitle")).toString());
+    qdb_->addPendingIndex(root->tree(), table);
+    Timings::increment(Timings::IndexesDeferred);
+    return true;
+}
+
+/*!
+  Reads the index file that \a table was scanned from into \a tree,
+  which scanIndexFile() created for it.
+
+  Resolving the base classes of the index can look up a name
+  in another index that has not been read yet, so this function
+  can be reentered. The state of the outer read is kept aside
+  meanwhile.
+ */
+void QDocIndexFiles::loadIndexTree(const IndexNameTable &table, Tree *tree)
+{
+    QString project;
+    QVector<QPair<ClassNode *, QString> > bases;
+    project.swap(project_);
+    bases.swap(basesList_);
+
+    Location::logToStdErr("Loading index file on demand: " + table.path);
+    QFile file;
+    QScopedPointer<IndexReader> reader(openIndexFile(table.path, &file));
+    if (reader && reader->readNextStartElement() && reader->name() == QLatin1String("INDEX")) {
+        project_ = reader->attributes().value(QLatin1String("project")).toString();
+        while (reader->readNextStartElement()) {
+            readingRoot = true;
+            readIndexSection(*reader, tree->root(), table.indexUrl);
+        }
+        resolveIndex();
+    }
+
+    project_.swap(project);
+    basesList_.swap(bases);
+}
+
+/*!
+  \class IndexNameTable
+  \internal
+
+  The names that an index tree can be searched by, recorded
+  when the index is scanned. Names are stored in lower case and
+  in the canonical form of titles, so that a lookup key matches
+  whichever way the search compares it. A false match only
+  reads an index too early.
+ */
+
+/*!
+  Adds \a name to the table.
+ */
+void IndexNameTable::addName(const QString &name)
+{
+    if (name.isEmpty())
+        return;
+    names.insert(name.toLower());
+    names.insert(Doc::canonicalTitle(name));
+}
+
+/*!
+  Returns \c true if one of \a keys, which were returned by
+  lookupKeys(), is in the table.
+ */
+bool IndexNameTable::containsAny(const QStringList &keys) const
+{
+    for (const auto &key : keys) {
+        if (names.contains(key))
+            return true;
+    }
+    return false;
+}
+
+/*!
+  Returns the keys under which a node searched for as \a name
+  could have been added to a table: \a name itself in both forms,
+  and its last component without parameters or template
+  arguments. Returns an empty list if \a name is empty, which
+  matches no table.
+ */
+QStringList IndexNameTable::lookupKeys(const QString &name)
+{
+    QStringList keys;
+    if (name.isEmpty())
+        return keys;
+    keys << name.toLower() << Doc::canonicalTitle(name);
+
+    QString last = name;
+    int i = last.indexOf(QLatin1Char('('));
+    if (i >= 0)
+        last.truncate(i);
+    i = last.indexOf(QLatin1Char('<'));
+    if (i >= 0)
+        last.truncate(i);
+    i = last.lastIndexOf(QLatin1String("::"));
+    if (i >= 0)
+        last.remove(0, i + 2);
+    last = last.trimmed().toLower();
+    if (!last.isEmpty())
+        keys << last;
+    i = last.lastIndexOf(QLatin1Char('.'));
+    if (i >= 0 && i + 1 < last.size())
+        keys << last.mid(i + 1);
+    return keys;
+}
+
 /*!
   Read a <section> element from the index file and create the
   appropriate node(s).
  */
-void QDocIndexFiles::readIndexSection(QXmlStreamReader& reader,
+void QDocIndexFiles::readIndexSection(IndexReader &reader,
                                       Node *current,
                                       const QString &indexUrl)
 {
@@ -644,7 +848,7 @@ void QDocIndexFiles::readIndexSection(QXmlStreamReader& reader,
 
   done:
     while (!reader.isEndElement()) {
-        if (reader.readNext() == QXmlStreamReader::Invalid) {
+        if (!reader.readNext()) {
             break;
         }
     }
@@ -1576,6 +1780,9 @@ void QDocIndexFiles::generateIndex(const QString &fileName,
     writer.writeEndElement(); // QDOCINDEX
     writer.writeEndDocument();
     file.close();
+
+    if (!BinaryIndexReader::write(fileName))
+        Location::logToStdErr("Could not write binary index file for: " + fileName);
 }
 
 QT_END_NAMESPACE
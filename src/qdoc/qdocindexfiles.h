@@ -32,14 +32,17 @@
 #include "node.h"
 #include "tree.h"
 
+#include <QtCore/qset.h>
+
 QT_BEGIN_NAMESPACE
 
 class Atom;
 class Generator;
+class IndexReader;
 class QStringList;
 class QDocDatabase;
+class QFile;
 class WebXMLGenerator;
-class QXmlStreamReader;
 class QXmlStreamWriter;
 class QXmlStreamAttributes;
 
@@ -51,9 +54,25 @@ public:
     virtual void append(QXmlStreamWriter &writer, Node *node) = 0;
 };
 
+// The names that may be looked up in an index tree that has not been read yet
+struct IndexNameTable
+{
+    void addName(const QString &name);
+    bool containsAny(const QStringList &keys) const;
+    static QStringList lookupKeys(const QString &name);
+
+    QString path;
+    QString indexUrl;
+    QSet<QString> names;
+    QSet<QString> namespaces;
+    QSet<QString> proxies;
+    QSet<QString> baseClasses;
+};
+
 class QDocIndexFiles
 {
     friend class QDocDatabase;
+    friend class QDocForest; // for reading index trees on demand
     friend class WebXMLGenerator; // for using generateIndexSections()
 
  private:
@@ -65,7 +84,10 @@ class QDocIndexFiles
 
     void readIndexes(const QStringList &indexFiles);
     void readIndexFile(const QString &path);
-    void readIndexSection(QXmlStreamReader &reader, Node *current, const QString &indexUrl);
+    bool scanIndexFile(const QString &path);
+    void loadIndexTree(const IndexNameTable &table, Tree *tree);
+    IndexReader *openIndexFile(const QString &path, QFile *file);
+    void readIndexSection(IndexReader &reader, Node *current, const QString &indexUrl);
     void insertTarget(TargetRec::TargetType type, const QXmlStreamAttributes &attributes, Node *node);
     void resolveIndex();
 
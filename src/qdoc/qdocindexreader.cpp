@@ -0,0 +1,468 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qdocindexreader.h"
+
+#include <QtCore/qdatetime.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+
+#include <limits>
+
+#include <string.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+  The binary index format is a compact transcription of the
+  element and attribute stream of an XML index file. All numbers
+  are 32-bit little-endian words.
+
+  The header holds the magic bytes "QDIX", the format version,
+  the size of the XML index it was transcribed from as a 64-bit
+  number, the number of strings, the number of words in the token
+  stream, and two reserved words.
+
+  The string table follows. Each distinct element name, attribute
+  name and attribute value is stored once, as a length followed
+  by that many UTF-16 code units, padded to a multiple of four
+  bytes.
+
+  The token stream comes last. A start element is the string id
+  of its name shifted left by one, followed by the number of
+  attributes and a pair of string ids (name, value) for each of
+  them. An end element is the word 1.
+ */
+static const char binaryIndexMagic[] = { 'Q', 'D', 'I', 'X' };
+static const quint32 binaryIndexVersion = 1;
+static const int binaryIndexHeaderSize = 32;
+
+// The decoded index images kept by BinaryIndexReader::openCached()
+struct CachedIndex
+{
+    QDateTime lastModified;
+    quint64 xmlSize = 0;
+    QByteArray image;
+    QVector<QString> strings;
+    quint32 tokenOffset = 0;
+    quint32 tokenCount = 0;
+};
+
+static QHash<QString, CachedIndex> indexCache;
+
+bool BinaryIndexReader::cachingEnabled_ = false;
+
+/*!
+  \class IndexReader
+  \internal
+
+  The interface through which QDocIndexFiles reads the elements
+  and attributes of an index file. It is the subset of the
+  QXmlStreamReader API that the index reader uses, so that the
+  XML index and the binary index are read by the same code.
+ */
+
+/*!
+  \class XmlIndexReader
+  \internal
+
+  Reads an XML index file from \a device with QXmlStreamReader.
+ */
+XmlIndexReader::XmlIndexReader(QIODevice *device)
+    : reader_(device)
+{
+    reader_.setNamespaceProcessing(false);
+}
+
+/*!
+  \class BinaryIndexReader
+  \internal
+
+  Reads a binary index file. The file is memory-mapped, and its
+  strings are converted to QString once each when the file is
+  opened, so repeated names and values are shared by all the
+  nodes created from them.
+ */
+
+BinaryIndexReader::~BinaryIndexReader()
+{
+    if (data_ && file_.isOpen())
+        file_.unmap(const_cast<uchar *>(data_));
+}
+
+static inline quint32 wordAt(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+/*!
+  Returns the path of the binary index that belongs to the XML
+  index file at \a xmlPath.
+ */
+QString BinaryIndexReader::binaryPath(const QString &xmlPath)
+{
+    return xmlPath + QLatin1String(".bin");
+}
+
+/*!
+  Opens the binary index file at \a path, which is expected to be
+  a transcription of the XML index at \a xmlPath. Returns \c false
+  if the file does not exist, is malformed, or is older than the
+  XML index, in which case the XML index must be read instead.
+ */
+bool BinaryIndexReader::open(const QString &path, const QString &xmlPath)
+{
+    const QFileInfo binaryInfo(path);
+    const QFileInfo xmlInfo(xmlPath);
+    if (!binaryInfo.exists() || binaryInfo.lastModified() < xmlInfo.lastModified())
+        return false;
+
+    file_.setFileName(path);
+    if (!file_.open(QFile::ReadOnly))
+        return false;
+    size_ = file_.size();
+    if (size_ < binaryIndexHeaderSize || size_ > std::numeric_limits<quint32>::max())
+        return false;
+    data_ = file_.map(0, size_);
+    if (!data_)
+        return false;
+    return parse(quint64(xmlInfo.size()));
+}
+
+/*!
+  Opens the index at \a xmlPath from the in-memory cache of index
+  images, adding it to the cache first if it is not there or if
+  the XML index has changed since. The image added is the binary
+  index next to the XML index if that one is current, or else a
+  transcription of the XML index made in memory. Returns \c false
+  if neither can be read.
+
+  The cache is only used when caching is enabled, which qdoc does
+  when it processes many modules in one run, so that an index
+  that several modules depend on is read and decoded only once.
+ */
+bool BinaryIndexReader::openCached(const QString &xmlPath)
+{
+    const QFileInfo xmlInfo(xmlPath);
+    const QString key = xmlInfo.absoluteFilePath();
+    const quint64 xmlSize = quint64(xmlInfo.size());
+    auto it = indexCache.constFind(key);
+    if (it != indexCache.constEnd() && it->lastModified == xmlInfo.lastModified()
+            && it->xmlSize == xmlSize) {
+        image_ = it->image;
+        data_ = reinterpret_cast<const uchar *>(image_.constData());
+        size_ = image_.size();
+        strings_ = it->strings;
+        tokens_ = data_ + it->tokenOffset;
+        tokenCount_ = it->tokenCount;
+        return true;
+    }
+
+    QByteArray image;
+    const QFileInfo binaryInfo(binaryPath(xmlPath));
+    if (binaryInfo.exists() && binaryInfo.lastModified() >= xmlInfo.lastModified()) {
+        QFile file(binaryInfo.filePath());
+        if (file.open(QFile::ReadOnly))
+            image = file.readAll();
+    }
+    if (!openImage(image, xmlSize) && !openImage(transcribe(xmlPath), xmlSize)) {
+        indexCache.remove(key);
+        return false;
+    }
+
+    CachedIndex cached;
+    cached.lastModified = xmlInfo.lastModified();
+    cached.xmlSize = xmlSize;
+    cached.image = image_;
+    cached.strings = strings_;
+    cached.tokenOffset = quint32(tokens_ - data_);
+    cached.tokenCount = tokenCount_;
+    indexCache.insert(key, cached);
+    return true;
+}
+
+/*!
+  Discards the index images that openCached() has kept in memory.
+ */
+void BinaryIndexReader::clearCache()
+{
+    indexCache.clear();
+}
+
+/*!
+  Reads the binary index held in \a image, which is expected to
+  be a transcription of an XML index of \a xmlSize bytes. Returns
+  \c false if \a image is malformed.
+ */
+bool BinaryIndexReader::openImage(const QByteArray &image, quint64 xmlSize)
+{
+    image_ = image;
+    data_ = reinterpret_cast<const uchar *>(image_.constData());
+    size_ = image_.size();
+    if (size_ < binaryIndexHeaderSize)
+        return false;
+    return parse(xmlSize);
+}
+
+/*!
+  Reads the header and the string table of the binary index at
+  data_, and positions the reader at the start of its token
+  stream. Returns \c false if the index is malformed, or if it
+  was not transcribed from an XML index of \a xmlSize bytes.
+ */
+bool BinaryIndexReader::parse(quint64 xmlSize)
+{
+    strings_.clear();
+    if (memcmp(data_, binaryIndexMagic, sizeof(binaryIndexMagic)) != 0
+            || wordAt(data_ + 4) != binaryIndexVersion)
+        return false;
+    if ((wordAt(data_ + 8) | (quint64(wordAt(data_ + 12)) << 32)) != xmlSize)
+        return false;
+
+    const quint32 stringCount = wordAt(data_ + 16);
+    tokenCount_ = wordAt(data_ + 20);
+    quint32 offset = binaryIndexHeaderSize;
+    if (stringCount > (size_ - offset) / 4)
+        return false;
+    strings_.reserve(int(stringCount));
+    for (quint32 i = 0; i < stringCount; ++i) {
+        if (size_ - offset < 4)
+            return false;
+        const quint32 length = wordAt(data_ + offset);
+        offset += 4;
+        const quint32 bytes = (length * 2 + 3) & ~3u;
+        if (length > (size_ - offset) / 2 || bytes > size_ - offset)
+            return false;
+        QString string(int(length), Qt::Uninitialized);
+        qFromLittleEndian<quint16>(data_ + offset, length, string.data());
+        strings_.append(string);
+        offset += bytes;
+    }
+    if (tokenCount_ != (size_ - offset) / 4)
+        return false;
+    tokens_ = data_ + offset;
+    return true;
+}
+
+/*!
+  Reads the next token. Returns \c false at the end of the token
+  stream, or if the stream is malformed.
+ */
+bool BinaryIndexReader::readNext()
+{
+    if (next_ >= tokenCount_) {
+        type_ = Invalid;
+        return false;
+    }
+    const quint32 word = wordAt(tokens_ + 4 * next_++);
+    if (word & 1) {
+        type_ = EndElement;
+        return true;
+    }
+    nameId_ = word >> 1;
+    if (next_ >= tokenCount_ || nameId_ >= quint32(strings_.size())) {
+        type_ = Invalid;
+        return false;
+    }
+    attributeCount_ = wordAt(tokens_ + 4 * next_++);
+    if (attributeCount_ > (tokenCount_ - next_) / 2) {
+        type_ = Invalid;
+        return false;
+    }
+    attributeStart_ = next_;
+    next_ += 2 * attributeCount_;
+    for (quint32 i = attributeStart_; i < next_; ++i) {
+        if (wordAt(tokens_ + 4 * i) >= quint32(strings_.size())) {
+            type_ = Invalid;
+            return false;
+        }
+    }
+    type_ = StartElement;
+    return true;
+}
+
+/*!
+  Reads until the next start element within the current element,
+  and returns \c true if one was found. Returns \c false when the
+  end of the current element is reached.
+ */
+bool BinaryIndexReader::readNextStartElement()
+{
+    while (readNext()) {
+        if (type_ == StartElement)
+            return true;
+        if (type_ == EndElement)
+            return false;
+    }
+    return false;
+}
+
+/*!
+  Returns the name of the current element.
+ */
+QStringRef BinaryIndexReader::name() const
+{
+    if (type_ != StartElement)
+        return QStringRef();
+    return QStringRef(&strings_.at(int(nameId_)));
+}
+
+/*!
+  Returns the attributes of the current start element.
+ */
+QXmlStreamAttributes BinaryIndexReader::attributes() const
+{
+    QXmlStreamAttributes attributes;
+    if (type_ != StartElement)
+        return attributes;
+    attributes.reserve(int(attributeCount_));
+    for (quint32 i = 0; i < attributeCount_; ++i) {
+        const quint32 nameId = wordAt(tokens_ + 4 * (attributeStart_ + 2 * i));
+        const quint32 valueId = wordAt(tokens_ + 4 * (attributeStart_ + 2 * i + 1));
+        attributes.append(QXmlStreamAttribute(strings_.at(int(nameId)), strings_.at(int(valueId))));
+    }
+    return attributes;
+}
+
+/*!
+  Skips to the end of the current element, including all of its
+  child elements.
+ */
+void BinaryIndexReader::skipCurrentElement()
+{
+    int depth = 1;
+    while (depth && readNext()) {
+        if (type_ == StartElement)
+            ++depth;
+        else if (type_ == EndElement)
+            --depth;
+    }
+}
+
+static void appendWord(QByteArray &data, quint32 word)
+{
+    char bytes[4];
+    qToLittleEndian(word, bytes);
+    data.append(bytes, 4);
+}
+
+/*!
+  Returns the binary transcription of the XML index file at
+  \a xmlPath, or an empty byte array if the XML index cannot be
+  read.
+ */
+QByteArray BinaryIndexReader::transcribe(const QString &xmlPath)
+{
+    QFile xmlFile(xmlPath);
+    if (!xmlFile.open(QFile::ReadOnly))
+        return QByteArray();
+
+    QXmlStreamReader reader(&xmlFile);
+    reader.setNamespaceProcessing(false);
+    QHash<QString, quint32> ids;
+    QVector<QString> strings;
+    QVector<quint32> tokens;
+    const auto intern = [&ids, &strings](const QStringRef &ref) {
+        const QString string = ref.toString();
+        auto it = ids.constFind(string);
+        if (it != ids.constEnd())
+            return it.value();
+        const quint32 id = quint32(strings.size());
+        ids.insert(string, id);
+        strings.append(string);
+        return id;
+    };
+    while (!reader.atEnd()) {
+        switch (reader.readNext()) {
+        case QXmlStreamReader::StartElement: {
+            tokens.append(intern(reader.name()) << 1);
+            const QXmlStreamAttributes attributes = reader.attributes();
+            tokens.append(quint32(attributes.size()));
+            for (const auto &attribute : attributes) {
+                tokens.append(intern(attribute.qualifiedName()));
+                tokens.append(intern(attribute.value()));
+            }
+            break;
+        }
+        case QXmlStreamReader::EndElement:
+            tokens.append(1);
+            break;
+        default:
+            break;
+        }
+    }
+    if (reader.hasError())
+        return QByteArray();
+
+    QByteArray data;
+    data.append(binaryIndexMagic, sizeof(binaryIndexMagic));
+    appendWord(data, binaryIndexVersion);
+    const quint64 xmlSize = quint64(xmlFile.size());
+    appendWord(data, quint32(xmlSize));
+    appendWord(data, quint32(xmlSize >> 32));
+    appendWord(data, quint32(strings.size()));
+    appendWord(data, quint32(tokens.size()));
+    appendWord(data, 0);
+    appendWord(data, 0);
+    for (const auto &string : qAsConst(strings)) {
+        appendWord(data, quint32(string.size()));
+        const int start = data.size();
+        data.resize(start + ((string.size() * 2 + 3) & ~3));
+        memset(data.data() + start, 0, size_t(data.size() - start));
+        qToLittleEndian<quint16>(string.constData(), string.size(), data.data() + start);
+    }
+    for (quint32 word : qAsConst(tokens))
+        appendWord(data, word);
+    return data;
+}
+
+/*!
+  Transcribes the XML index file at \a xmlPath into a binary index
+  file next to it. Returns \c false if the XML index cannot be
+  read or the binary index cannot be written.
+ */
+bool BinaryIndexReader::write(const QString &xmlPath)
+{
+    const QByteArray data = transcribe(xmlPath);
+    if (data.isEmpty())
+        return false;
+
+    const QString path = binaryPath(xmlPath);
+    const QString tmpPath = path + QLatin1String(".tmp");
+    QFile file(tmpPath);
+    if (!file.open(QFile::WriteOnly) || file.write(data) != data.size()) {
+        file.remove();
+        return false;
+    }
+    file.close();
+    QFile::remove(path);
+    return QFile::rename(tmpPath, path);
+}
+
+QT_END_NAMESPACE
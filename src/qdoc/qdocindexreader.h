@@ -0,0 +1,115 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QDOCINDEXREADER_H
+#define QDOCINDEXREADER_H
+
+#include <QtCore/qfile.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvector.h>
+#include <QtCore/qxmlstream.h>
+
+QT_BEGIN_NAMESPACE
+
+// The element and attribute stream of an index file, in either format
+class IndexReader
+{
+public:
+    virtual ~IndexReader() {}
+    virtual bool readNextStartElement() = 0;
+    virtual bool readNext() = 0;
+    virtual bool isEndElement() const = 0;
+    virtual QStringRef name() const = 0;
+    virtual QXmlStreamAttributes attributes() const = 0;
+    virtual void skipCurrentElement() = 0;
+};
+
+class XmlIndexReader : public IndexReader
+{
+public:
+    explicit XmlIndexReader(QIODevice *device);
+
+    bool readNextStartElement() override { return reader_.readNextStartElement(); }
+    bool readNext() override { return reader_.readNext() != QXmlStreamReader::Invalid; }
+    bool isEndElement() const override { return reader_.isEndElement(); }
+    QStringRef name() const override { return reader_.name(); }
+    QXmlStreamAttributes attributes() const override { return reader_.attributes(); }
+    void skipCurrentElement() override { reader_.skipCurrentElement(); }
+
+private:
+    QXmlStreamReader reader_;
+};
+
+class BinaryIndexReader : public IndexReader
+{
+public:
+    BinaryIndexReader() = default;
+    ~BinaryIndexReader() override;
+
+    bool open(const QString &path, const QString &xmlPath);
+    bool openCached(const QString &xmlPath);
+
+    bool readNextStartElement() override;
+    bool readNext() override;
+    bool isEndElement() const override { return type_ == EndElement; }
+    QStringRef name() const override;
+    QXmlStreamAttributes attributes() const override;
+    void skipCurrentElement() override;
+
+    static QString binaryPath(const QString &xmlPath);
+    static bool write(const QString &xmlPath);
+    static void setCachingEnabled(bool enabled) { cachingEnabled_ = enabled; }
+    static bool cachingEnabled() { return cachingEnabled_; }
+    static void clearCache();
+
+private:
+    enum TokenType { NoToken, StartElement, EndElement, Invalid };
+
+    bool openImage(const QByteArray &image, quint64 xmlSize);
+    bool parse(quint64 xmlSize);
+    static QByteArray transcribe(const QString &xmlPath);
+
+    static bool cachingEnabled_;
+
+    QFile file_;
+    QByteArray image_;
+    const uchar *data_ = nullptr;
+    qint64 size_ = 0;
+    QVector<QString> strings_;
+    const uchar *tokens_ = nullptr;
+    quint32 tokenCount_ = 0;
+    quint32 next_ = 0;
+    TokenType type_ = NoToken;
+    quint32 nameId_ = 0;
+    quint32 attributeCount_ = 0;
+    quint32 attributeStart_ = 0;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -86,7 +86,9 @@ void QmlCodeParser::terminateParser()
 {
 #ifndef QT_NO_DECLARATIVE
     delete lexer;
+    lexer = nullptr;
     delete parser;
+    parser = nullptr;
 #endif
 }
 
@@ -31,10 +31,32 @@
 #include <QtCore/qdebug.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qregexp.h>
+#include <QtCore/qvector.h>
+
+#include <algorithm>
 
 QT_BEGIN_NAMESPACE
 
+/*
+  The split and marked-up lines of a quoted file. Instances are
+  immutable once created, apart from the snippet delimiter index,
+  which is built the first time a snippet is looked up, so a file
+  that is quoted from many times is read, marked up and split only
+  once.
+ */
+struct QuotedFile
+{
+    QStringList plainLines_;
+    QStringList markedLines_;
+    QVector<int> lineOffsets_;
+    QString indexedComment_;
+    QHash<QString, QVector<int> > delimiters_;
+
+    QVector<int> delimiterLines(const QString &comment, const QString &delimiter);
+};
+
 QHash<QString,QString> Quoter::commentHash;
+QHash<QString, QSharedPointer<QuotedFile> > Quoter::fileCache_;
 
 static void replaceMultipleNewlines(QString &s)
 {
@@ -106,8 +128,46 @@ static void trimWhiteSpace(QString &str)
     str.resize(++j);
 }
 
+/*
+  Returns the numbers of the lines that match the snippet
+  \a delimiter, which must already have been passed through
+  trimWhiteSpace(). The index maps every "<comment>[...]" tag found
+  in the white space trimmed lines to the lines containing it, which
+  gives the same result as calling match() on each line as long as
+  the snippet identifier does not itself contain a ']'.
+ */
+QVector<int> QuotedFile::delimiterLines(const QString &comment, const QString &delimiter)
+{
+    if (indexedComment_ != comment) {
+        delimiters_.clear();
+        indexedComment_ = comment;
+        QString tag = comment;
+        trimWhiteSpace(tag);
+        tag += QLatin1Char('[');
+        for (int i = 0; i < plainLines_.size(); ++i) {
+            if (!plainLines_.at(i).contains(QLatin1Char('[')))
+                continue;
+            QString str = plainLines_.at(i);
+            while (str.endsWith(QLatin1Char('\n')))
+                str.truncate(str.length() - 1);
+            trimWhiteSpace(str);
+            int from = str.indexOf(tag);
+            while (from != -1) {
+                int end = str.indexOf(QLatin1Char(']'), from + tag.length());
+                if (end == -1)
+                    break;
+                QVector<int> &lines = delimiters_[str.mid(from, end - from + 1)];
+                if (lines.isEmpty() || lines.last() != i)
+                    lines.append(i);
+                from = str.indexOf(tag, from + 1);
+            }
+        }
+    }
+    return delimiters_.value(delimiter);
+}
+
 Quoter::Quoter()
-    : silent(false)
+    : silent(false), line_(0)
 {
     /* We're going to hard code these delimiters:
         * C++, Qt, Qt Script, Java:
@@ -133,8 +193,8 @@ Quoter::Quoter()
 void Quoter::reset()
 {
     silent = false;
-    plainLines.clear();
-    markedLines.clear();
+    file_.reset();
+    line_ = 0;
     codeLocation = Location::null;
 }
 
@@ -167,6 +227,10 @@ void Quoter::quoteFromFile(const QString &userFriendlyFilePath,
     */
     codeLocation = Location(userFriendlyFilePath);
 
+    file_.reset(new QuotedFile);
+    line_ = 0;
+    QStringList &plainLines = file_->plainLines_;
+    QStringList &markedLines = file_->markedLines_;
     plainLines = splitLines(plainCode);
     markedLines = splitLines(markedCode);
     if (markedLines.count() != plainLines.count()) {
@@ -175,20 +239,72 @@ void Quoter::quoteFromFile(const QString &userFriendlyFilePath,
     }
 
     /*
-      Squeeze blanks (cat -s).
+      Squeeze blanks (cat -s), and record how far each line
+      moves codeLocation so that skipTo() can jump ahead.
     */
+    QVector<int> &offsets = file_->lineOffsets_;
+    offsets.reserve(markedLines.size() + 1);
+    offsets.append(0);
     QStringList::Iterator m = markedLines.begin();
     while (m != markedLines.end()) {
         replaceMultipleNewlines(*m);
+        offsets.append(offsets.last() + m->count(QLatin1Char('\n')) + 1);
         ++m;
     }
     codeLocation.start();
 }
 
+/*
+  Starts quoting from the file at \a filePath if it has been quoted
+  from before with the same \a userFriendlyFilePath and \a marker.
+  Returns \c false if the file is not in the cache, in which case
+  the caller loads it and passes it to quoteFromFile() and
+  cacheFile().
+ */
+bool Quoter::quoteFromCachedFile(const QString &filePath,
+                                 const QString &userFriendlyFilePath,
+                                 const CodeMarker *marker)
+{
+    const QString key = filePath + QLatin1Char('\n') + userFriendlyFilePath
+            + QLatin1Char('\n') + QString::number(quintptr(marker));
+    QSharedPointer<QuotedFile> file = fileCache_.value(key);
+    if (file.isNull())
+        return false;
+
+    silent = false;
+    codeLocation = Location(userFriendlyFilePath);
+    file_ = file;
+    line_ = 0;
+    codeLocation.start();
+    return true;
+}
+
+/*
+  Stores the file most recently passed to quoteFromFile() in the
+  cache so that later quotes from it can use quoteFromCachedFile().
+ */
+void Quoter::cacheFile(const QString &filePath, const QString &userFriendlyFilePath,
+                       const CodeMarker *marker)
+{
+    if (file_.isNull())
+        return;
+    const QString key = filePath + QLatin1Char('\n') + userFriendlyFilePath
+            + QLatin1Char('\n') + QString::number(quintptr(marker));
+    fileCache_.insert(key, file_);
+}
+
+/*
+  Releases the files in the cache of quoted files.
+ */
+void Quoter::clearCache()
+{
+    fileCache_.clear();
+}
+
 QString Quoter::quoteLine(const Location &docLocation, const QString &command,
                           const QString &pattern)
 {
-    if (plainLines.isEmpty()) {
+    if (atEnd()) {
         failedAtEnd( docLocation, command );
         return QString();
     }
@@ -198,7 +314,7 @@ QString Quoter::quoteLine(const Location &docLocation, const QString &command,
         return QString();
     }
 
-    if (match(docLocation, pattern, plainLines.first()))
+    if (match(docLocation, pattern, currentLine()))
         return getLine();
 
     if (!silent) {
@@ -217,37 +333,39 @@ QString Quoter::quoteSnippet(const Location &docLocation, const QString &identif
     QString t;
     int indent = 0;
 
-    while (!plainLines.isEmpty()) {
-        if (match(docLocation, delimiter, plainLines.first())) {
-            QString startLine = getLine();
-            while (indent < startLine.length() && startLine[indent] == QLatin1Char(' '))
-                indent++;
-            break;
-        }
-        getLine();
+    // Identifiers containing ']' cannot be looked up in the index.
+    const bool indexed = !identifier.contains(QLatin1Char(']'));
+    int start = findDelimiter(docLocation, delimiter, comment, indexed);
+    if (start != -1) {
+        skipTo(start);
+        QString startLine = getLine();
+        while (indent < startLine.length() && startLine[indent] == QLatin1Char(' '))
+            indent++;
+    } else {
+        skipTo(file_.isNull() ? 0 : file_->plainLines_.size());
     }
-    while (!plainLines.isEmpty()) {
-        QString line = plainLines.first();
-        if (match(docLocation, delimiter, line)) {
-            QString lastLine = getLine(indent);
-            int dIndex = lastLine.indexOf(delimiter);
-            if (dIndex > 0) {
-                // The delimiter might be preceded on the line by other
-                // delimeters, so look for the first comment on the line.
-                QString leading = lastLine.left(dIndex);
-                dIndex = leading.indexOf(comment);
-                if (dIndex != -1)
-                    leading = leading.left(dIndex);
-                if (leading.endsWith(QLatin1String("<@comment>")))
-                    leading.chop(10);
-                if (!leading.trimmed().isEmpty())
-                    t += leading;
-            }
-            return t;
+    int end = atEnd() ? -1 : findDelimiter(docLocation, delimiter, comment, indexed);
+    if (end != -1) {
+        while (line_ < end)
+            t += removeSpecialLines(currentLine(), comment, indent);
+        QString lastLine = getLine(indent);
+        int dIndex = lastLine.indexOf(delimiter);
+        if (dIndex > 0) {
+            // The delimiter might be preceded on the line by other
+            // delimeters, so look for the first comment on the line.
+            QString leading = lastLine.left(dIndex);
+            dIndex = leading.indexOf(comment);
+            if (dIndex != -1)
+                leading = leading.left(dIndex);
+            if (leading.endsWith(QLatin1String("<@comment>")))
+                leading.chop(10);
+            if (!leading.trimmed().isEmpty())
+                t += leading;
         }
-
-        t += removeSpecialLines(line, comment, indent);
+        return t;
     }
+    while (!atEnd())
+        t += removeSpecialLines(currentLine(), comment, indent);
     failedAtEnd(docLocation, QString("snippet (%1)").arg(delimiter));
     return t;
 }
@@ -259,13 +377,11 @@ QString Quoter::quoteTo(const Location &docLocation, const QString &command,
     QString comment = commentForCode();
 
     if (pattern.isEmpty()) {
-        while (!plainLines.isEmpty()) {
-            QString line = plainLines.first();
-            t += removeSpecialLines(line, comment);
-        }
+        while (!atEnd())
+            t += removeSpecialLines(currentLine(), comment);
     } else {
-        while (!plainLines.isEmpty()) {
-            if (match(docLocation, pattern, plainLines.first())) {
+        while (!atEnd()) {
+            if (match(docLocation, pattern, currentLine())) {
                 return t;
             }
             t += getLine();
@@ -283,14 +399,22 @@ QString Quoter::quoteUntil(const Location &docLocation, const QString &command,
     return t;
 }
 
+bool Quoter::atEnd() const
+{
+    return file_.isNull() || line_ >= file_->plainLines_.size();
+}
+
+const QString &Quoter::currentLine() const
+{
+    return file_->plainLines_.at(line_);
+}
+
 QString Quoter::getLine(int unindent)
 {
-    if (plainLines.isEmpty())
+    if (atEnd())
         return QString();
 
-    plainLines.removeFirst();
-
-    QString t = markedLines.takeFirst();
+    QString t = file_->markedLines_.at(line_++);
     int i = 0;
     while (i < unindent && i < t.length() && t[i] == QLatin1Char(' '))
         i++;
@@ -301,6 +425,43 @@ QString Quoter::getLine(int unindent)
     return t;
 }
 
+/*
+  Moves the cursor forward to \a line without quoting the lines
+  in between.
+ */
+void Quoter::skipTo(int line)
+{
+    if (file_.isNull() || line <= line_)
+        return;
+    codeLocation.advanceLines(file_->lineOffsets_.at(line) - file_->lineOffsets_.at(line_));
+    line_ = line;
+}
+
+/*
+  Returns the number of the first line at or after the cursor that
+  matches the snippet \a delimiter, or -1 if there is none. Uses the
+  file's delimiter index when \a indexed is true, and otherwise
+  falls back to matching each line in turn.
+ */
+int Quoter::findDelimiter(const Location &docLocation, const QString &delimiter,
+                          const QString &comment, bool indexed)
+{
+    if (file_.isNull())
+        return -1;
+    if (indexed) {
+        QString trimmed = delimiter;
+        trimWhiteSpace(trimmed);
+        const QVector<int> lines = file_->delimiterLines(comment, trimmed);
+        auto it = std::lower_bound(lines.constBegin(), lines.constEnd(), line_);
+        return it == lines.constEnd() ? -1 : *it;
+    }
+    for (int i = line_; i < file_->plainLines_.size(); ++i) {
+        if (match(docLocation, delimiter, file_->plainLines_.at(i)))
+            return i;
+    }
+    return -1;
+}
+
 bool Quoter::match(const Location &docLocation, const QString &pattern0,
                    const QString &line)
 {
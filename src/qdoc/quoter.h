@@ -36,10 +36,14 @@
 #include "location.h"
 
 #include <QtCore/qhash.h>
+#include <QtCore/qsharedpointer.h>
 #include <QtCore/qstringlist.h>
 
 QT_BEGIN_NAMESPACE
 
+class CodeMarker;
+struct QuotedFile;
+
 class Quoter
 {
     Q_DECLARE_TR_FUNCTIONS(QDoc::Quoter)
@@ -50,6 +54,10 @@ public:
     void reset();
     void quoteFromFile(const QString &userFriendlyFileName,
                        const QString &plainCode, const QString &markedCode);
+    bool quoteFromCachedFile(const QString &filePath, const QString &userFriendlyFileName,
+                             const CodeMarker *marker);
+    void cacheFile(const QString &filePath, const QString &userFriendlyFileName,
+                   const CodeMarker *marker);
     QString quoteLine(const Location &docLocation, const QString &command,
                       const QString &pattern);
     QString quoteTo(const Location &docLocation, const QString &command,
@@ -59,9 +67,15 @@ public:
     QString quoteSnippet(const Location &docLocation, const QString &identifier);
 
     static QStringList splitLines(const QString &line);
+    static void clearCache();
 
 private:
+    bool atEnd() const;
+    const QString &currentLine() const;
     QString getLine(int unindent = 0);
+    void skipTo(int line);
+    int findDelimiter(const Location &docLocation, const QString &delimiter,
+                      const QString &comment, bool indexed);
     void failedAtEnd(const Location &docLocation, const QString &command);
     bool match(const Location &docLocation, const QString &pattern,
                const QString &line);
@@ -70,10 +84,11 @@ private:
                                int unindent = 0);
 
     bool silent;
-    QStringList plainLines;
-    QStringList markedLines;
+    QSharedPointer<QuotedFile> file_;
+    int line_;
     Location codeLocation;
     static QHash<QString,QString> commentHash;
+    static QHash<QString, QSharedPointer<QuotedFile> > fileCache_;
 };
 
 QT_END_NAMESPACE
@@ -0,0 +1,304 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "scanners.h"
+
+QT_BEGIN_NAMESPACE
+
+static inline bool isAsciiUpper(QChar ch)
+{
+    return ch.unicode() >= 'A' && ch.unicode() <= 'Z';
+}
+
+static inline bool isAsciiLower(QChar ch)
+{
+    return ch.unicode() >= 'a' && ch.unicode() <= 'z';
+}
+
+static inline bool isAsciiLetter(QChar ch)
+{
+    return isAsciiUpper(ch) || isAsciiLower(ch);
+}
+
+static inline bool isIdentifierChar(QChar ch)
+{
+    return isAsciiLetter(ch) || ch == QLatin1Char('_')
+            || (ch.unicode() >= '0' && ch.unicode() <= '9');
+}
+
+static inline bool isBlank(QChar ch)
+{
+    return ch == QLatin1Char(' ') || ch == QLatin1Char('\t');
+}
+
+/*
+  Matches the part of a Qt class name after the leading "Q" or
+  "Qt", that is (?:[A-Z3]+[a-z][A-Za-z]*|t).
+ */
+static bool isQtClassNameTail(const QString &ident, int i)
+{
+    const int n = ident.size();
+    if (n - i == 1 && ident.at(i) == QLatin1Char('t'))
+        return true;
+    const int start = i;
+    while (i < n && (isAsciiUpper(ident.at(i)) || ident.at(i) == QLatin1Char('3')))
+        ++i;
+    if (i == start || i == n || !isAsciiLower(ident.at(i)))
+        return false;
+    for (++i; i < n; ++i) {
+        if (!isAsciiLetter(ident.at(i)))
+            return false;
+    }
+    return true;
+}
+
+/*!
+  Returns \c true if \a ident looks like the name of a Qt class,
+  that is, if it matches \c{Qt?(?:[A-Z3]+[a-z][A-Za-z]*|t)} exactly.
+ */
+bool Scanners::isQtClassName(const QString &ident)
+{
+    if (ident.size() < 2 || ident.at(0) != QLatin1Char('Q'))
+        return false;
+    if (ident.at(1) == QLatin1Char('t') && isQtClassNameTail(ident, 2))
+        return true;
+    return isQtClassNameTail(ident, 1);
+}
+
+/*!
+  Returns \c true if \a ident looks like a Qt global function,
+  that is, if it matches \c{q([A-Z][a-z]+)+} exactly.
+ */
+bool Scanners::isQtFunctionName(const QString &ident)
+{
+    const int n = ident.size();
+    if (n < 3 || ident.at(0) != QLatin1Char('q'))
+        return false;
+    int i = 1;
+    while (i < n) {
+        if (!isAsciiUpper(ident.at(i++)))
+            return false;
+        const int start = i;
+        while (i < n && isAsciiLower(ident.at(i)))
+            ++i;
+        if (i == start)
+            return false;
+    }
+    return true;
+}
+
+/*!
+  Removes C and C++ comments from \a str. This is what removing
+  every shortest match of \c{/(?:\*.*\*\/|/.*\n|/[^\n]*$)} did:
+  an unterminated C comment is left alone, and a C++ comment is
+  removed together with its newline.
+ */
+void Scanners::removeComments(QString &str)
+{
+    int from = str.indexOf(QLatin1Char('/'));
+    if (from == -1)
+        return;
+
+    QString result;
+    int copied = 0;
+    const int n = str.size();
+    while (from != -1 && from + 1 < n) {
+        const QChar next = str.at(from + 1);
+        int end = -1;
+        if (next == QLatin1Char('*')) {
+            end = str.indexOf(QLatin1String("*/"), from + 2);
+            if (end != -1)
+                end += 2;
+        } else if (next == QLatin1Char('/')) {
+            end = str.indexOf(QLatin1Char('\n'), from + 2);
+            end = (end == -1) ? n : end + 1;
+        }
+        if (end == -1) {
+            from = str.indexOf(QLatin1Char('/'), from + 1);
+            continue;
+        }
+        result += str.midRef(copied, from - copied);
+        copied = end;
+        from = str.indexOf(QLatin1Char('/'), end);
+    }
+    if (copied == 0)
+        return;
+    result += str.midRef(copied);
+    str = result;
+}
+
+/*!
+  Matches \a str against \c{defined ?\(?([A-Z_0-9a-z]+) ?\)?} and
+  sets \a name to the macro name if it matches.
+ */
+bool Scanners::matchDefined(const QString &str, QString *name)
+{
+    static const QLatin1String defined("defined");
+    if (!str.startsWith(defined))
+        return false;
+    const int n = str.size();
+    int i = defined.size();
+    if (i < n && str.at(i) == QLatin1Char(' '))
+        ++i;
+    if (i < n && str.at(i) == QLatin1Char('('))
+        ++i;
+    const int start = i;
+    while (i < n && isIdentifierChar(str.at(i)))
+        ++i;
+    if (i == start)
+        return false;
+    const int end = i;
+    if (i < n && str.at(i) == QLatin1Char(' '))
+        ++i;
+    if (i < n && str.at(i) == QLatin1Char(')'))
+        ++i;
+    if (i != n)
+        return false;
+    *name = str.mid(start, end - start);
+    return true;
+}
+
+/*!
+  Matches \a str against
+  \c{[ \t]*(?:<versionSym>)[ \t]+"([^"]*)"[ \t]*} and sets
+  \a version to the quoted string if it matches.
+ */
+bool Scanners::matchVersionDefine(const QString &str, const QString &versionSym,
+                                  QString *version)
+{
+    if (versionSym.isEmpty())
+        return false;
+    const int n = str.size();
+    int i = 0;
+    while (i < n && isBlank(str.at(i)))
+        ++i;
+    if (str.midRef(i, versionSym.size()) != versionSym)
+        return false;
+    i += versionSym.size();
+    const int blanks = i;
+    while (i < n && isBlank(str.at(i)))
+        ++i;
+    if (i == blanks || i == n || str.at(i) != QLatin1Char('"'))
+        return false;
+    const int start = ++i;
+    const int end = str.indexOf(QLatin1Char('"'), start);
+    if (end == -1)
+        return false;
+    for (i = end + 1; i < n; ++i) {
+        if (!isBlank(str.at(i)))
+            return false;
+    }
+    *version = str.mid(start, end - start);
+    return true;
+}
+
+/*!
+  Returns the position of the first match of \c{<[^@>]*>} in
+  \a str and sets \a length to its length, or returns -1.
+ */
+int Scanners::indexOfTemplateTag(const QString &str, int *length)
+{
+    const int n = str.size();
+    int from = str.indexOf(QLatin1Char('<'));
+    while (from != -1) {
+        int i = from + 1;
+        while (i < n && str.at(i) != QLatin1Char('@') && str.at(i) != QLatin1Char('>'))
+            ++i;
+        if (i == n)
+            return -1;
+        if (str.at(i) == QLatin1Char('>')) {
+            *length = i - from + 1;
+            return from;
+        }
+        // Any '<' before the '@' would run into it as well.
+        from = str.indexOf(QLatin1Char('<'), i + 1);
+    }
+    return -1;
+}
+
+/*!
+  Replaces every \c{<@param>([a-z]+)_([1-9n])</@param>} in \a str
+  with \c{<i>\1<sub>\2</sub></i>}.
+ */
+void Scanners::markSubscriptParameters(QString &str)
+{
+    static const QLatin1String paramTag("<@param>");
+    static const QLatin1String paramEndTag("</@param>");
+
+    QString result;
+    int copied = 0;
+    int from = str.indexOf(paramTag);
+    while (from != -1) {
+        const int nameStart = from + paramTag.size();
+        int i = nameStart;
+        while (i < str.size() && isAsciiLower(str.at(i)))
+            ++i;
+        const int nameEnd = i;
+        if (nameEnd > nameStart && i + 2 <= str.size() && str.at(i) == QLatin1Char('_')) {
+            const QChar sub = str.at(i + 1);
+            if (((sub.unicode() >= '1' && sub.unicode() <= '9') || sub == QLatin1Char('n'))
+                    && str.midRef(i + 2, paramEndTag.size()) == paramEndTag) {
+                result += str.midRef(copied, from - copied);
+                result += QLatin1String("<i>");
+                result += str.midRef(nameStart, nameEnd - nameStart);
+                result += QLatin1String("<sub>");
+                result += sub;
+                result += QLatin1String("</sub></i>");
+                copied = i + 2 + paramEndTag.size();
+                from = str.indexOf(paramTag, copied);
+                continue;
+            }
+        }
+        from = str.indexOf(paramTag, from + 1);
+    }
+    if (copied == 0)
+        return;
+    result += str.midRef(copied);
+    str = result;
+}
+
+/*!
+  Removes every shortest match of \c{<@extra>.*</@extra>} from
+  \a str.
+ */
+void Scanners::removeExtras(QString &str)
+{
+    static const QLatin1String extraTag("<@extra>");
+    static const QLatin1String extraEndTag("</@extra>");
+
+    int from = str.indexOf(extraTag);
+    while (from != -1) {
+        const int end = str.indexOf(extraEndTag, from + extraTag.size());
+        if (end == -1)
+            return;
+        str.remove(from, end + extraEndTag.size() - from);
+        from = str.indexOf(extraTag, from);
+    }
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,55 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef SCANNERS_H
+#define SCANNERS_H
+
+#include <QtCore/qstring.h>
+
+QT_BEGIN_NAMESPACE
+
+/*
+  Hand-written equivalents of regular expressions that qdoc used
+  to evaluate on every identifier, preprocessor directive or
+  synopsis. Each function documents the expression it replaces.
+ */
+namespace Scanners
+{
+    bool isQtClassName(const QString &ident);
+    bool isQtFunctionName(const QString &ident);
+    void removeComments(QString &str);
+    bool matchDefined(const QString &str, QString *name);
+    bool matchVersionDefine(const QString &str, const QString &versionSym, QString *version);
+    int indexOfTemplateTag(const QString &str, int *length);
+    void markSubscriptParameters(QString &str);
+    void removeExtras(QString &str);
+};
+
+QT_END_NAMESPACE
+
+#endif // SCANNERS_H
@@ -30,6 +30,7 @@
 
 #include "config.h"
 #include "generator.h"
+#include "timings.h"
 
 #include <QtCore/qdebug.h>
 #include <QtCore/qobjectdefs.h>
@@ -49,6 +50,8 @@ QVector<Section> Sections::sinceSections_(15, Section(Section::Details, Section:
 QVector<Section> Sections::allMembers_(1, Section(Section::AllMembers, Section::Active));
 QVector<Section> Sections::stdQmlTypeSummarySections_(7, Section(Section::Summary, Section::Active));
 QVector<Section> Sections::stdQmlTypeDetailsSections_(7, Section(Section::Details, Section::Active));
+bool Sections::cachingEnabled_ = false;
+QHash<const Aggregate *, Sections::CachedSections> Sections::cache_;
 
 /*!
   \class Section
@@ -66,6 +69,17 @@ Section::Section(Style style, Status status) : style_(style), status_(status), a
     //reimplementedMembers_.reserve(50);
 }
 
+/*!
+  Constructs a copy of the \a other section. The class maps are
+  only used while the section is built, so they are not copied;
+  the class key and node lists that reduce() makes from them are.
+ */
+Section::Section(const Section &other)
+    : style_(Section::Details), status_(Section::Active), aggregate_(nullptr)
+{
+    *this = other;
+}
+
 /*!
   The destructor must delete the members of collections
   when the members are allocated on the heap.
@@ -75,6 +89,36 @@ Section::~Section()
     clear();
 }
 
+/*!
+  Makes this section a copy of the \a other section, which must
+  not have class maps that are not yet reduced.
+ */
+Section &Section::operator=(const Section &other)
+{
+    if (this == &other)
+        return *this;
+    clear();
+    style_ = other.style_;
+    status_ = other.status_;
+    title_ = other.title_;
+    divClass_ = other.divClass_;
+    singular_ = other.singular_;
+    plural_ = other.plural_;
+    aggregate_ = other.aggregate_;
+    keys_ = other.keys_;
+    obsoleteKeys_ = other.obsoleteKeys_;
+    members_ = other.members_;
+    obsoleteMembers_ = other.obsoleteMembers_;
+    reimplementedMembers_ = other.reimplementedMembers_;
+    inheritedMembers_ = other.inheritedMembers_;
+    for (const ClassKeysNodes *ckn : other.classKeysNodesList_)
+        classKeysNodesList_.append(new ClassKeysNodes(*ckn));
+    memberMap_ = other.memberMap_;
+    obsoleteMemberMap_ = other.obsoleteMemberMap_;
+    reimplementedMemberMap_ = other.reimplementedMemberMap_;
+    return *this;
+}
+
 /*!
   A Section is now an element in a static vector, so we
   don't have to repeatedly construct and destroy them. But
@@ -306,10 +350,25 @@ void Section::reduce()
 /*!
   This constructor builds the vectors of sections based on the
   type of the \a aggregate node.
+
+  When caching is enabled, the sections built for an aggregate
+  are kept, and constructing the sections for the same aggregate
+  again, for another output format, copies them instead of walking
+  and sorting the members of the aggregate and its bases again.
  */
 Sections::Sections(Aggregate *aggregate) : aggregate_(aggregate)
 {
     initSections();
+    if (cachingEnabled_) {
+        const auto it = cache_.constFind(aggregate_);
+        if (it != cache_.constEnd()) {
+            summarySections() = it->summary_;
+            detailsSections() = it->details_;
+            allMembersSection() = it->allMembers_;
+            Timings::increment(Timings::SectionsReused);
+            return;
+        }
+    }
     initAggregate(allMembers_, aggregate_);
     switch (aggregate_->nodeType()) {
     case Node::Class:
@@ -336,6 +395,9 @@ Sections::Sections(Aggregate *aggregate) : aggregate_(aggregate)
         buildStdRefPageSections();
         break;
     }
+    if (cachingEnabled_)
+        cache_.insert(aggregate_, CachedSections { summarySections(), detailsSections(),
+                                                   allMembersSection() });
 }
 
 /*!
@@ -464,6 +526,48 @@ Sections::~Sections()
     }
 }
 
+/*!
+  Returns the vector of summary sections for the kind of the
+  aggregate these sections are built for.
+ */
+SectionVector &Sections::summarySections()
+{
+    switch (aggregate_->nodeType()) {
+    case Node::Class:
+    case Node::Struct:
+    case Node::Union:
+        return stdCppClassSummarySections_;
+    case Node::JsType:
+    case Node::JsBasicType:
+    case Node::QmlType:
+    case Node::QmlBasicType:
+        return stdQmlTypeSummarySections_;
+    default:
+        return stdSummarySections_;
+    }
+}
+
+/*!
+  Returns the vector of details sections for the kind of the
+  aggregate these sections are built for.
+ */
+SectionVector &Sections::detailsSections()
+{
+    switch (aggregate_->nodeType()) {
+    case Node::Class:
+    case Node::Struct:
+    case Node::Union:
+        return stdCppClassDetailsSections_;
+    case Node::JsType:
+    case Node::JsBasicType:
+    case Node::QmlType:
+    case Node::QmlBasicType:
+        return stdQmlTypeDetailsSections_;
+    default:
+        return stdDetailsSections_;
+    }
+}
+
 /*!
   Initialize the Aggregate in each Section of vector \a v with \a aggregate.
  */
@@ -31,6 +31,7 @@
 
 #include "node.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qpair.h>
 
 QT_BEGIN_NAMESPACE
@@ -52,8 +53,11 @@ class Section
  public:
     Section() : style_(Details), status_(Active), aggregate_(nullptr) { }
     Section(Style style, Status status);
+    Section(const Section &other);
     ~Section();
 
+    Section &operator=(const Section &other);
+
     void init(const QString &title) {
         title_ = title;
     }
@@ -228,7 +232,20 @@ class Sections
 
     Aggregate *aggregate() const { return aggregate_; }
 
+    static void setCachingEnabled(bool enabled) { cachingEnabled_ = enabled; }
+    static bool cachingEnabled() { return cachingEnabled_; }
+    static void clearCache() { cache_.clear(); }
+
  private:
+    struct CachedSections
+    {
+        SectionVector summary_;
+        SectionVector details_;
+        Section allMembers_;
+    };
+
+    SectionVector &summarySections();
+    SectionVector &detailsSections();
     void stdRefPageSwitch(SectionVector &v, Node *n, Node *t = nullptr);
     void distributeNodeInSummaryVector(SectionVector &sv, Node *n);
     void distributeNodeInDetailsVector(SectionVector &dv, Node *n);
@@ -248,6 +265,8 @@ class Sections
     static SectionVector sinceSections_;
     static SectionVector allMembers_;
 
+    static bool cachingEnabled_;
+    static QHash<const Aggregate *, CachedSections> cache_;
 };
 
 QT_END_NAMESPACE
@@ -43,9 +43,20 @@ public:
     Text();
     explicit Text(const QString &str);
     Text(const Text &text);
+    Text(Text &&text) noexcept : first(text.first), last(text.last)
+    {
+        text.first = nullptr;
+        text.last = nullptr;
+    }
     ~Text();
 
     Text &operator=(const Text &text);
+    Text &operator=(Text &&text) noexcept
+    {
+        qSwap(first, text.first);
+        qSwap(last, text.last);
+        return *this;
+    }
 
     Atom *firstAtom() { return first; }
     Atom *lastAtom() { return last; }
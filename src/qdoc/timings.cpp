@@ -0,0 +1,225 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "timings.h"
+
+#include "location.h"
+
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+/*!
+  \class Timings
+  \internal
+  \brief The Timings class collects the timing report written
+  when qdoc is run with \c{-timings <file>}.
+
+  Each phase of a run records its wall clock and CPU time. The
+  parse time of each source file, the time spent generating each
+  page, and a few counters are recorded as well. finishRun()
+  adds all of that for one qdocconf file to the report, and
+  writeReport() writes the report as JSON when qdoc exits.
+
+  All functions must be called from the main thread.
+ */
+
+/*!
+  The number of pages listed in the \c slowestPages section
+  of the report for each run.
+ */
+static const int slowestPageCount = 25;
+
+QString Timings::reportFile_;
+QVector<Timings::PhaseRec> Timings::phases_;
+QVector<int> Timings::openPhases_;
+QVector<Timings::ItemRec> Timings::files_;
+QVector<Timings::ItemRec> Timings::pages_;
+qint64 Timings::counters_[Timings::CounterCount] = {};
+QJsonArray Timings::runs_;
+
+/*!
+  Starts timing the phase called \a name. Phases can be nested;
+  the report records the depth of each one.
+ */
+void Timings::startPhase(const QString &name)
+{
+    if (!enabled())
+        return;
+    PhaseRec phase;
+    phase.name_ = name;
+    phase.depth_ = openPhases_.size();
+    phase.wallNsecs_ = 0;
+    phase.cpuStart_ = std::clock();
+    phase.cpuMsecs_ = 0;
+    phase.timer_.start();
+    openPhases_.append(phases_.size());
+    phases_.append(phase);
+}
+
+/*!
+  Stops timing the phase that was started last.
+ */
+void Timings::endPhase()
+{
+    if (!enabled() || openPhases_.isEmpty())
+        return;
+    PhaseRec &phase = phases_[openPhases_.takeLast()];
+    phase.wallNsecs_ = phase.timer_.nsecsElapsed();
+    phase.cpuMsecs_ = 1000.0 * (std::clock() - phase.cpuStart_) / CLOCKS_PER_SEC;
+}
+
+/*!
+  Records that parsing the source file \a fileName took
+  \a nsecs nanoseconds.
+ */
+void Timings::recordFile(const QString &fileName, qint64 nsecs)
+{
+    if (enabled())
+        files_.append(ItemRec { fileName, nsecs });
+}
+
+/*!
+  Records that generating the page \a fileName took \a nsecs
+  nanoseconds.
+ */
+void Timings::recordPage(const QString &fileName, qint64 nsecs)
+{
+    if (enabled())
+        pages_.append(ItemRec { fileName, nsecs });
+}
+
+static double msecs(qint64 nsecs)
+{
+    return nsecs / 1000000.0;
+}
+
+/*!
+  Adds the phases, files, pages, and counters recorded since
+  the last call to the report as the run for \a project in the
+  qdoc \a pass, and resets them for the next run.
+ */
+void Timings::finishRun(const QString &project, const QString &pass)
+{
+    if (!enabled())
+        return;
+    while (!openPhases_.isEmpty())
+        endPhase();
+
+    QJsonArray phases;
+    for (const auto &phase : qAsConst(phases_)) {
+        QJsonObject object;
+        object.insert(QLatin1String("name"), phase.name_);
+        object.insert(QLatin1String("depth"), phase.depth_);
+        object.insert(QLatin1String("wallMs"), msecs(phase.wallNsecs_));
+        object.insert(QLatin1String("cpuMs"), phase.cpuMsecs_);
+        phases.append(object);
+    }
+
+    const auto slowestFirst = [](const ItemRec &a, const ItemRec &b) {
+        return a.nsecs_ > b.nsecs_;
+    };
+    std::sort(files_.begin(), files_.end(), slowestFirst);
+    QJsonArray files;
+    for (const auto &file : qAsConst(files_)) {
+        QJsonObject object;
+        object.insert(QLatin1String("file"), file.fileName_);
+        object.insert(QLatin1String("ms"), msecs(file.nsecs_));
+        files.append(object);
+    }
+
+    const int pageCount = qMin(slowestPageCount, pages_.size());
+    std::partial_sort(pages_.begin(), pages_.begin() + pageCount, pages_.end(), slowestFirst);
+    QJsonArray pages;
+    for (int i = 0; i < pageCount; ++i) {
+        QJsonObject object;
+        object.insert(QLatin1String("page"), pages_.at(i).fileName_);
+        object.insert(QLatin1String("ms"), msecs(pages_.at(i).nsecs_));
+        pages.append(object);
+    }
+
+    static const char *const counterNames[CounterCount] = {
+        "linkLookups",
+        "linkCacheHits",
+        "nodesCreated",
+        "filesParsed",
+        "pagesGenerated",
+        "pchCacheHits",
+        "internedBytesSaved",
+        "locationBytesSaved",
+        "indexesDeferred",
+        "indexesLoadedOnDemand",
+        "sectionsReused",
+        "filesReplayed",
+        "pagesUnchanged"
+    };
+    QJsonObject counters;
+    for (int i = 0; i < CounterCount; ++i)
+        counters.insert(QLatin1String(counterNames[i]), counters_[i]);
+
+    QJsonObject run;
+    run.insert(QLatin1String("project"), project);
+    run.insert(QLatin1String("pass"), pass);
+    run.insert(QLatin1String("phases"), phases);
+    run.insert(QLatin1String("files"), files);
+    run.insert(QLatin1String("slowestPages"), pages);
+    run.insert(QLatin1String("counters"), counters);
+    runs_.append(run);
+
+    phases_.clear();
+    files_.clear();
+    pages_.clear();
+    std::fill(counters_, counters_ + CounterCount, 0);
+}
+
+/*!
+  Writes the report for all the runs finished so far to the
+  file given with \c{-timings}.
+ */
+void Timings::writeReport()
+{
+    if (!enabled())
+        return;
+    QFile file(reportFile_);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        Location::null.warning(QCoreApplication::translate("QDoc",
+                                   "Cannot write timing report '%1': %2")
+                               .arg(reportFile_, file.errorString()));
+        return;
+    }
+    QJsonObject report;
+    report.insert(QLatin1String("runs"), runs_);
+    file.write(QJsonDocument(report).toJson());
+}
+
+QT_END_NAMESPACE
@@ -0,0 +1,110 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef TIMINGS_H
+#define TIMINGS_H
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvector.h>
+
+#include <ctime>
+
+QT_BEGIN_NAMESPACE
+
+class Timings
+{
+public:
+    enum Counter {
+        LinkLookups,
+        LinkCacheHits,
+        NodesCreated,
+        FilesParsed,
+        PagesGenerated,
+        PchCacheHits,
+        InternedBytesSaved,
+        LocationBytesSaved,
+        IndexesDeferred,
+        IndexesLoadedOnDemand,
+        SectionsReused,
+        FilesReplayed,
+        PagesUnchanged,
+        CounterCount
+    };
+
+    class Phase
+    {
+    public:
+        Phase(const QString &name) { Timings::startPhase(name); }
+        ~Phase() { Timings::endPhase(); }
+    };
+
+    static void setReportFile(const QString &fileName) { reportFile_ = fileName; }
+    static bool enabled() { return !reportFile_.isEmpty(); }
+
+    static void startPhase(const QString &name);
+    static void endPhase();
+    static void recordFile(const QString &fileName, qint64 nsecs);
+    static void recordPage(const QString &fileName, qint64 nsecs);
+    static void increment(Counter counter) { ++counters_[counter]; }
+    static void add(Counter counter, qint64 value) { counters_[counter] += value; }
+    static qint64 counter(Counter counter) { return counters_[counter]; }
+
+    static void finishRun(const QString &project, const QString &pass);
+    static void writeReport();
+
+private:
+    struct PhaseRec
+    {
+        QString name_;
+        int depth_;
+        qint64 wallNsecs_;
+        std::clock_t cpuStart_;
+        double cpuMsecs_;
+        QElapsedTimer timer_;
+    };
+
+    struct ItemRec
+    {
+        QString fileName_;
+        qint64 nsecs_;
+    };
+
+    static QString reportFile_;
+    static QVector<PhaseRec> phases_;
+    static QVector<int> openPhases_;
+    static QVector<ItemRec> files_;
+    static QVector<ItemRec> pages_;
+    static qint64 counters_[CounterCount];
+    static QJsonArray runs_;
+};
+
+QT_END_NAMESPACE
+
+#endif
@@ -30,6 +30,7 @@
 
 #include "config.h"
 #include "generator.h"
+#include "scanners.h"
 
 #include <QtCore/qfile.h>
 #include <QtCore/qhash.h>
@@ -84,12 +85,26 @@ static int kwordHashTable[KwordHashTableSize];
 
 static QHash<QByteArray, bool> *ignoredTokensAndDirectives = nullptr;
 
-static QRegExp *comment = nullptr;
-static QRegExp *versionX = nullptr;
-static QRegExp *definedX = nullptr;
+static QString *versionSym = nullptr;
 
 static QRegExp *defines = nullptr;
 static QRegExp *falsehoods = nullptr;
+static QHash<QString, bool> *definedNames = nullptr;
+
+/*
+  Returns \c true if \a name matches one of the configured defines.
+  The answers are cached, since the same handful of macros is
+  tested in every header.
+ */
+static bool isDefined(const QString &name)
+{
+    auto it = definedNames->constFind(name);
+    if (it != definedNames->constEnd())
+        return *it;
+    bool defined = defines->exactMatch(name);
+    definedNames->insert(name, defined);
+    return defined;
+}
 
 #ifndef QT_NO_TEXTCODEC
 static QTextCodec *sourceCodec = nullptr;
@@ -487,7 +502,7 @@ int Tokenizer::getToken()
 
 void Tokenizer::initialize(const Config &config)
 {
-    QString versionSym = config.getString(CONFIG_VERSIONSYM);
+    versionSym = new QString(config.getString(CONFIG_VERSIONSYM));
 
     QString sourceEncoding = config.getString(CONFIG_SOURCEENCODING);
     if (sourceEncoding.isEmpty())
@@ -496,17 +511,10 @@ void Tokenizer::initialize(const Config &config)
     sourceCodec = QTextCodec::codecForName(sourceEncoding.toLocal8Bit());
 #endif
 
-    comment = new QRegExp("/(?:\\*.*\\*/|/.*\n|/[^\n]*$)");
-    comment->setMinimal(true);
-    versionX = new QRegExp("$cannot possibly match^");
-    if (!versionSym.isEmpty())
-        versionX->setPattern("[ \t]*(?:" + QRegExp::escape(versionSym)
-                             + ")[ \t]+\"([^\"]*)\"[ \t]*");
-    definedX = new QRegExp("defined ?\\(?([A-Z_0-9a-z]+) ?\\)?");
-
     QStringList d = config.getStringList(CONFIG_DEFINES);
     d += "qdoc";
     defines = new QRegExp(d.join('|'));
+    definedNames = new QHash<QString, bool>;
     falsehoods = new QRegExp(config.getStringList(CONFIG_FALSEHOODS).join('|'));
 
     /*
@@ -542,16 +550,14 @@ void Tokenizer::initialize(const Config &config)
  */
 void Tokenizer::terminate()
 {
-    delete comment;
-    comment = nullptr;
-    delete versionX;
-    versionX = nullptr;
-    delete definedX;
-    definedX = nullptr;
+    delete versionSym;
+    versionSym = nullptr;
     delete defines;
     defines = nullptr;
     delete falsehoods;
     falsehoods = nullptr;
+    delete definedNames;
+    definedNames = nullptr;
     delete ignoredTokensAndDirectives;
     ignoredTokensAndDirectives = nullptr;
 }
@@ -620,7 +626,7 @@ int Tokenizer::getTokenAfterPreprocessor()
             condition += yyCh;
             yyCh = getChar();
         }
-        condition.remove(*comment);
+        Scanners::removeComments(condition);
         condition = condition.simplified();
 
         /*
@@ -644,9 +650,9 @@ int Tokenizer::getTokenAfterPreprocessor()
             if (directive == QString("if"))
                 pushSkipping(!isTrue(condition));
             else if (directive == QString("ifdef"))
-                pushSkipping(!defines->exactMatch(condition));
+                pushSkipping(!isDefined(condition));
             else if (directive == QString("ifndef"))
-                pushSkipping(defines->exactMatch(condition));
+                pushSkipping(isDefined(condition));
         } else if (directive[0] == QChar('e')) {
             if (directive == QString("elif")) {
                 bool old = popSkipping();
@@ -660,8 +666,9 @@ int Tokenizer::getTokenAfterPreprocessor()
                 popSkipping();
             }
         } else if (directive == QString("define")) {
-            if (versionX->exactMatch(condition))
-                yyVersion = versionX->cap(1);
+            QString version;
+            if (Scanners::matchVersionDefine(condition, *versionSym, &version))
+                yyVersion = version;
         }
     }
 
@@ -769,8 +776,9 @@ bool Tokenizer::isTrue(const QString &condition)
     if (t[0] == QChar('(') && t.endsWith(QChar(')')))
         return isTrue(t.mid(1, t.length() - 2));
 
-    if (definedX->exactMatch(t))
-        return defines->exactMatch(definedX->cap(1));
+    QString name;
+    if (Scanners::matchDefined(t, &name))
+        return isDefined(name);
     else
         return !falsehoods->exactMatch(t);
 }
@@ -29,6 +29,7 @@
 #include "tree.h"
 
 #include "doc.h"
+#include "editdistance.h"
 #include "htmlgenerator.h"
 #include "location.h"
 #include "node.h"
@@ -75,7 +76,8 @@ Tree::Tree(const QString &camelCaseModuleName, QDocDatabase *qdb)
       physicalModuleName_(camelCaseModuleName.toLower()),
       qdb_(qdb),
       root_(nullptr, QString()),
-      targetListMap_(nullptr)
+      targetListMap_(nullptr),
+      pathIndexBuilt_(false)
 {
     root_.setPhysicalModuleName(physicalModuleName_);
     root_.setTree(this);
@@ -576,7 +578,10 @@ const Node *Tree::findNodeForTarget(const QStringList &path,
 
     while (current != nullptr) {
         if (current->isAggregate()) { // Should this be isPageNode() ???
-            const Node *node = matchPathAndTarget(path, path_idx, target, current, flags, genus, ref);
+            const Node *node = findIndexedTarget(path, path_idx, target, current, genus, ref);
+            if (node)
+                return node;
+            node = matchPathAndTarget(path, path_idx, target, current, flags, genus, ref);
             if (node)
                 return node;
         }
@@ -668,6 +673,153 @@ const Node *Tree::matchPathAndTarget(const QStringList &path,
     return nullptr;
 }
 
+/*!
+  Looks up the \a path, starting at index \a idx, below the
+  \a scope node in the path index of this tree. This gives the
+  same answer as matchPathAndTarget() for the common case where
+  every leg of the path names exactly one child, without walking
+  the tree. If the path is ambiguous at any leg, if it isn't in
+  the index, or if the node it finds can't be used, nullptr is
+  returned and the caller must fall back to matchPathAndTarget(),
+  which also searches base classes and enum values.
+
+  The \a target and \a genus are interpreted the same way as in
+  matchPathAndTarget(), and \a ref is set the same way.
+ */
+const Node *Tree::findIndexedTarget(const QStringList &path,
+                                    int idx,
+                                    const QString &target,
+                                    const Node *scope,
+                                    Node::Genus genus,
+                                    QString &ref) const
+{
+    if (idx >= path.size())
+        return nullptr;
+    if (!pathIndexBuilt_)
+        buildPathIndex();
+
+    QString key;
+    if (scope != root()) {
+        key = scopeKeys_.value(scope);
+        if (key.isEmpty())
+            return nullptr;
+        const PathIndexRec rec = pathIndex_.value(key);
+        if (rec.count_ != 1 || rec.node_ != scope)
+            return nullptr;
+    }
+
+    const Node *node = nullptr;
+    for (int i = idx; i < path.size(); ++i) {
+        if (!key.isEmpty())
+            key += QLatin1String("::");
+        key += path.at(i);
+        const PathIndexRec rec = pathIndex_.value(key);
+        if (rec.count_ != 1)
+            return nullptr;
+        node = rec.node_;
+        if (genus != Node::DontCare && node->genus() != genus)
+            return nullptr;
+    }
+
+    if (!target.isEmpty()) {
+        ref = getRef(target, node);
+        if (ref.isEmpty())
+            return nullptr;
+    }
+    if (node->isFunction() && node->name() == node->parent()->name())
+        node = node->parent();
+    return node->isPrivate() ? nullptr : node;
+}
+
+/*!
+  Builds the path index for this tree. Each key is a path of
+  child names joined with \c{::}, as matched by findChildren(),
+  and maps to the number of nodes reachable by that path and
+  the first of them. The index is built on the first lookup
+  after the tree has changed.
+
+  \sa clearPathIndex()
+ */
+void Tree::buildPathIndex() const
+{
+    pathIndex_.clear();
+    scopeKeys_.clear();
+    indexPathsBelow(root(), QString());
+    pathIndexBuilt_ = true;
+}
+
+/*!
+  Adds all the children of \a parent to the path index, using
+  \a prefix as the path of \a parent.
+ */
+void Tree::indexPathsBelow(const Aggregate *parent, const QString &prefix) const
+{
+    const NodeMap &nonfunctions = parent->nonfunctionMap();
+    for (auto it = nonfunctions.cbegin(); it != nonfunctions.cend(); ++it)
+        indexPath(prefix, it.key(), it.value());
+
+    const FunctionMap &functions = parent->functionMap();
+    for (auto it = functions.cbegin(); it != functions.cend(); ++it) {
+        for (FunctionNode *fn = it.value(); fn != nullptr; fn = fn->nextOverload())
+            indexPath(prefix, it.key(), fn);
+    }
+}
+
+/*!
+  Records that \a node is found by \a name below the node
+  with path \a prefix, and indexes the children of \a node
+  if it is an aggregate that hasn't been indexed yet.
+ */
+void Tree::indexPath(const QString &prefix, const QString &name, const Node *node) const
+{
+    const QString key = prefix.isEmpty() ? name : prefix + QLatin1String("::") + name;
+    PathIndexRec &rec = pathIndex_[key];
+    if (rec.count_++ == 0)
+        rec.node_ = node;
+    if (node->isAggregate() && !scopeKeys_.contains(node)) {
+        scopeKeys_.insert(node, key);
+        indexPathsBelow(static_cast<const Aggregate *>(node), key);
+    }
+}
+
+/*!
+  Discards the path index. It is rebuilt by the next lookup.
+  This must be called whenever nodes are added to the tree
+  after a lookup has been done.
+ */
+void Tree::clearPathIndex()
+{
+    pathIndexBuilt_ = false;
+    pathIndex_.clear();
+    scopeKeys_.clear();
+}
+
+/*!
+  Adds the names that links can use to reach the nodes of this
+  tree to \a index: the qualified names of all the nodes that
+  are not private, with \c{()} appended for functions, and the
+  titles of the pages and targets. Internal nodes are only added
+  if \a includeInternal is \c true.
+ */
+void Tree::addLinkTargetNames(NearestNameIndex *index, bool includeInternal) const
+{
+    if (!pathIndexBuilt_)
+        buildPathIndex();
+    for (auto it = pathIndex_.cbegin(); it != pathIndex_.cend(); ++it) {
+        const Node *node = it.value().node_;
+        if (node->isPrivate() || (node->isInternal() && !includeInternal))
+            continue;
+        if (node->isFunction())
+            index->insert(it.key() + QLatin1String("()"));
+        else
+            index->insert(it.key());
+    }
+    for (const PageNode *node : pageNodesByTitle_)
+        index->insert(node->title());
+    for (auto it = nodesByTargetTitle_.cbegin(); it != nodesByTargetTitle_.cend(); ++it)
+        index->insert(it.key());
+}
+
 /*!
   Searches the tree for a node that matches the \a path. The
   search begins at \a start but can move up the parent chain
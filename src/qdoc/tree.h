@@ -35,10 +35,12 @@
 
 #include "node.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qstack.h>
 
 QT_BEGIN_NAMESPACE
 
+class NearestNameIndex;
 class QStringList;
 class QDocDatabase;
 
@@ -85,6 +87,13 @@ typedef QMultiMap<QString, TargetRec *> TargetMap;
 typedef QMultiMap<QString, PageNode *> PageNodeMultiMap;
 typedef QMap<QString, QmlTypeNode *> QmlTypeMap;
 typedef QMultiMap<QString, const ExampleNode *> ExampleNodeMap;
+struct PathIndexRec
+{
+    const Node *node_ = nullptr;
+    int count_ = 0;
+};
+
+typedef QHash<QString, PathIndexRec> PathIndex;
 typedef QVector<TargetLoc *> TargetList;
 typedef QMap<QString, TargetList *> TargetListMap;
 
@@ -140,6 +149,17 @@ class Tree
                                    int flags,
                                    Node::Genus genus,
                                    QString &ref) const;
+    const Node *findIndexedTarget(const QStringList &path,
+                                  int idx,
+                                  const QString &target,
+                                  const Node *scope,
+                                  Node::Genus genus,
+                                  QString &ref) const;
+    void buildPathIndex() const;
+    void indexPathsBelow(const Aggregate *parent, const QString &prefix) const;
+    void indexPath(const QString &prefix, const QString &name, const Node *node) const;
+    void clearPathIndex();
+    void addLinkTargetNames(NearestNameIndex *index, bool includeInternal) const;
 
     const Node *findNode(const QStringList &path,
                          const Node *relative,
@@ -244,6 +264,9 @@ private:
     TargetListMap *targetListMap_;
     NodeList proxies_;
     NodeMap dontDocumentMap_;
+    mutable bool pathIndexBuilt_;
+    mutable PathIndex pathIndex_;
+    mutable QHash<const Node *, QString> scopeKeys_;
 };
 
 QT_END_NAMESPACE
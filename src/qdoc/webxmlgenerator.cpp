@@ -165,7 +165,7 @@ void WebXMLGenerator::generateExampleFilePage(const Node *en,
 
 void WebXMLGenerator::generateIndexSections(QXmlStreamWriter &writer, Node *node)
 {
-    marker_ = CodeMarker::markerForFileName(node->location().filePath());
+    marker_ = CodeMarker::markerForFileName(node->locationFilePath());
     QDocIndexFiles::qdocIndexFiles()->generateIndexSections(writer, node, this);
     // generateIndexSections does nothing for groups, so handle them explicitly
     if (node->isGroup())
@@ -34,6 +34,7 @@
 #include <QtCore/QDebug>
 #include <QtCore/QFile>
 #include <QtCore/QByteArray>
+#include <QtCore/QTemporaryDir>
 
 #include <QtTest/QtTest>
 
@@ -46,6 +47,9 @@ public:
 private slots:
     void good_data();
     void good();
+    void cache();
+    void parallel_data();
+    void parallel();
 #if CHECK_SIMTEXTH
     void simtexth();
     void simtexth_data();
@@ -57,6 +61,8 @@ private:
 
     void doCompare(QStringList actual, const QString &expectedFn, bool err);
     void doCompare(const QString &actualFn, const QString &expectedFn, bool err);
+    void runLupdate(const QString &workDir, const QStringList &args, QByteArray *output);
+    void takeTs(const QString &fileName, QByteArray *contents);
 };
 
 
@@ -310,6 +316,159 @@ void tst_lupdate::good()
                   dir + QLatin1Char('/') + ts + QLatin1String(".result"), false);
 }
 
+void tst_lupdate::runLupdate(const QString &workDir, const QStringList &args, QByteArray *output)
+{
+    QProcess proc;
+    proc.setWorkingDirectory(workDir);
+    proc.setProcessChannelMode(QProcess::MergedChannels);
+    const QString command = m_cmdLupdate + QLatin1Char(' ') + args.join(QLatin1Char(' '));
+    proc.start(m_cmdLupdate, args, QIODevice::ReadWrite | QIODevice::Text);
+    QVERIFY2(proc.waitForStarted(), qPrintable(command + QLatin1String(" :") + proc.errorString()));
+    QVERIFY2(proc.waitForFinished(30000), qPrintable(command));
+    *output = proc.readAll();
+    QVERIFY2(proc.exitStatus() == QProcess::NormalExit,
+             "\"" + command.toLatin1() + "\" crashed\n" + *output);
+    QVERIFY2(!proc.exitCode(),
+             "\"" + command.toLatin1() + "\" exited with code " +
+             QByteArray::number(proc.exitCode()) + "\n" + *output);
+}
+
+// Reads the TS file and removes it, so that the next run does not merge into it.
+void tst_lupdate::takeTs(const QString &fileName, QByteArray *contents)
+{
+    QFile file(fileName);
+    QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(fileName));
+    *contents = file.readAll();
+    file.close();
+    QVERIFY(file.remove());
+}
+
+void tst_lupdate::cache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString workDir = dir.path();
+    const QString header = workDir + QLatin1String("/widget.h");
+    const QString ts = workDir + QLatin1String("/project.ts");
+    QVERIFY(QFile::copy(m_basePath + QLatin1String("cache/main.cpp"),
+                        workDir + QLatin1String("/main.cpp")));
+    QVERIFY(QFile::copy(m_basePath + QLatin1String("cache/widget.h"), header));
+    QVERIFY(QFile::setPermissions(header, QFile::ReadOwner | QFile::WriteOwner));
+
+    // The header is listed, so it is parsed before main.cpp, which reuses its results.
+    const QStringList args = QStringList() << QLatin1String("-silent")
+            << QLatin1String("widget.h") << QLatin1String("main.cpp")
+            << QLatin1String("-ts") << QLatin1String("project.ts");
+    const QStringList cacheArgs = QStringList(args)
+            << QLatin1String("-cache") << QLatin1String("lupdate.cache");
+
+    QByteArray output;
+    QByteArray tsContents;
+    runLupdate(workDir, cacheArgs, &output);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(QFile::exists(workDir + QLatin1String("/lupdate.cache")));
+    takeTs(ts, &tsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(tsContents.contains("<name>FirstContext</name>"));
+    QVERIFY2(output.contains("Class 'Plain' lacks Q_OBJECT macro"), output.constData());
+
+    // The run using the cache gives the same messages and warnings.
+    QByteArray cachedOutput;
+    QByteArray cachedTsContents;
+    runLupdate(workDir, cacheArgs, &cachedOutput);
+    if (QTest::currentTestFailed())
+        return;
+    takeTs(ts, &cachedTsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QCOMPARE(cachedTsContents, tsContents);
+    QCOMPARE(cachedOutput, output);
+
+    // Changing the header invalidates the entry of main.cpp.
+    QFile file(header);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray source = file.readAll();
+    file.close();
+    source.replace("FirstContext", "SecondContext");
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    QCOMPARE(file.write(source), qint64(source.size()));
+    file.close();
+
+    runLupdate(workDir, cacheArgs, &cachedOutput);
+    if (QTest::currentTestFailed())
+        return;
+    takeTs(ts, &cachedTsContents);
+    if (QTest::currentTestFailed())
+        return;
+    runLupdate(workDir, args, &output);
+    if (QTest::currentTestFailed())
+        return;
+    takeTs(ts, &tsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(cachedTsContents.contains("<name>SecondContext</name>"));
+    QVERIFY(!cachedTsContents.contains("FirstContext"));
+    QCOMPARE(cachedTsContents, tsContents);
+    QCOMPARE(cachedOutput, output);
+}
+
+void tst_lupdate::parallel_data()
+{
+    QTest::addColumn<QStringList>("fileNames");
+
+    const QString header = QLatin1String("aliases.h");
+    const QStringList sources = QStringList() << QLatin1String("one.cpp")
+            << QLatin1String("two.cpp") << QLatin1String("three.cpp");
+    QTest::newRow("header first") << (QStringList(header) << sources);
+    QTest::newRow("header last") << (QStringList(sources) << header);
+}
+
+void tst_lupdate::parallel()
+{
+    QFETCH(QStringList, fileNames);
+
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString workDir = dir.path();
+    for (const QString &fileName : qAsConst(fileNames)) {
+        QVERIFY(QFile::copy(m_basePath + QLatin1String("parallel/") + fileName,
+                            workDir + QLatin1Char('/') + fileName));
+    }
+    const QString ts = workDir + QLatin1String("/project.ts");
+    const QStringList args = QStringList(fileNames)
+            << QLatin1String("-ts") << QLatin1String("project.ts");
+
+    // The aliases of Other resolve differently in two.cpp, so the files
+    // must take them over from each other in the order they are given.
+    QByteArray serialOutput;
+    QByteArray serialTsContents;
+    runLupdate(workDir, QStringList(args) << QLatin1String("-jobs") << QLatin1String("1"),
+               &serialOutput);
+    if (QTest::currentTestFailed())
+        return;
+    takeTs(ts, &serialTsContents);
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(serialTsContents.contains("<name>Outer::Widget</name>"));
+    QVERIFY(serialTsContents.contains("<name>Outer::Inner::Label</name>"));
+
+    for (const char *jobs : {"2", "4"}) {
+        QByteArray output;
+        QByteArray tsContents;
+        runLupdate(workDir, QStringList(args) << QLatin1String("-jobs") << QLatin1String(jobs),
+                   &output);
+        if (QTest::currentTestFailed())
+            return;
+        takeTs(ts, &tsContents);
+        if (QTest::currentTestFailed())
+            return;
+        QCOMPARE(tsContents, serialTsContents);
+        QCOMPARE(output, serialOutput);
+    }
+}
+
 #if CHECK_SIMTEXTH
 void tst_lupdate::simtexth()
 {
@@ -2,8 +2,13 @@ CONFIG += testcase
 QT = core testlib
 
 TARGET = tst_generatedOutput
+INCLUDEPATH += $$PWD/../../../../src/qdoc
+
+HEADERS += \
+    $$PWD/../../../../src/qdoc/qdocindexreader.h
 
 SOURCES += \
+    $$PWD/../../../../src/qdoc/qdocindexreader.cpp \
     tst_generatedoutput.cpp
 
 QMAKE_DOCS = $$PWD/test.qdocconf
@@ -25,6 +25,11 @@
 ** $QT_END_LICENSE$
 **
 ****************************************************************************/
+#include "qdocindexreader.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QProcess>
 #include <QTemporaryDir>
 #include <QtTest>
@@ -40,6 +45,13 @@ private slots:
     void htmlFromQDocFile();
     void htmlFromCpp();
     void htmlFromQml();
+    void incrementalOutput();
+    void incrementalParsing();
+    void parallelOutput();
+    void snapshotOutput();
+    void batchOutput();
+    void inheritedByFromIndex();
+    void linkSuggestions();
 
 private:
     QScopedPointer<QTemporaryDir> m_outputDir;
@@ -47,6 +59,8 @@ private:
 
     void runQDocProcess(const QStringList &arguments);
     void compareLineByLine(const QStringList &expectedFiles);
+    void copyTestData(const QStringList &files, const QString &targetDir);
+    void compareDirectories(const QString &expectedDir, const QString &actualDir);
     void testAndCompare(const char *input,
                         const char *outNames,
                         const char *extraParams = nullptr);
@@ -121,6 +135,53 @@ void tst_generatedOutput::compareLineByLine(const QStringList &expectedFiles)
     }
 }
 
+void tst_generatedOutput::copyTestData(const QStringList &files, const QString &targetDir)
+{
+    for (const auto &file : files) {
+        const QString source(QFINDTESTDATA(file));
+        QVERIFY2(QFile::copy(source, targetDir + "/" + file), qPrintable(source));
+    }
+}
+
+void tst_generatedOutput::compareDirectories(const QString &expectedDir,
+                                             const QString &actualDir)
+{
+    const auto listFiles = [](const QString &dir) {
+        QStringList files;
+        QDirIterator it(dir, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories);
+        while (it.hasNext())
+            files << QDir(dir).relativeFilePath(it.next());
+        files.sort();
+        return files;
+    };
+    const QStringList expectedFiles = listFiles(expectedDir);
+    QCOMPARE(listFiles(actualDir), expectedFiles);
+    for (const auto &file : expectedFiles) {
+        QFile expected(expectedDir + "/" + file);
+        QFile actual(actualDir + "/" + file);
+        QVERIFY(expected.open(QIODevice::ReadOnly));
+        QVERIFY(actual.open(QIODevice::ReadOnly));
+        QVERIFY2(actual.readAll() == expected.readAll(), qPrintable(file));
+    }
+}
+
+/*
+  Returns the value of the counter \a name in the last run of the
+  -timings report \a reportFile, or -1 if there is none.
+ */
+static qint64 timingsCounter(const QString &reportFile, const char *name)
+{
+    QFile file(reportFile);
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+    const QJsonArray runs =
+        QJsonDocument::fromJson(file.readAll()).object().value("runs").toArray();
+    if (runs.isEmpty())
+        return -1;
+    const QJsonObject counters = runs.last().toObject().value("counters").toObject();
+    return counters.value(QLatin1String(name)).toVariant().toLongLong();
+}
+
 void tst_generatedOutput::testAndCompare(const char *input,
                                          const char *outNames,
                                          const char *extraParams)
@@ -157,6 +218,229 @@ void tst_generatedOutput::htmlFromQml()
                    "uicomponents-qmlmodule.html");
 }
 
+void tst_generatedOutput::incrementalOutput()
+{
+    const char *pages = "qdoctests-qdocfileoutput.html "
+                        "qdoctests-qdocfileoutput-linking.html";
+    testAndCompare("test.qdocconf", pages, "-incremental");
+    if (QTest::currentTestFailed())
+        return;
+
+    // Unchanged pages are not rewritten by a second incremental run.
+    const QString page = m_outputDir->path() + "/qdoctests-qdocfileoutput.html";
+    const QDateTime past = QDateTime::currentDateTime().addDays(-1);
+    QFile pageFile(page);
+    QVERIFY(pageFile.open(QIODevice::ReadWrite));
+    QVERIFY(pageFile.setFileTime(past, QFileDevice::FileModificationTime));
+    pageFile.close();
+
+    testAndCompare("test.qdocconf", pages, "-incremental");
+    QCOMPARE(QFileInfo(page).lastModified().toSecsSinceEpoch(), past.toSecsSinceEpoch());
+}
+
+void tst_generatedOutput::incrementalParsing()
+{
+    QTemporaryDir sourceDir;
+    QVERIFY(sourceDir.isValid());
+    copyTestData({ "testcpp.qdocconf", "testcpp.h", "testcpp.cpp" }, sourceDir.path());
+    if (QTest::currentTestFailed())
+        return;
+
+    const QString report = sourceDir.filePath("timings.json");
+    const QStringList args{ "-outputdir", m_outputDir->path(), "-incremental",
+                            "-timings", report, sourceDir.filePath("testcpp.qdocconf") };
+    const QStringList pages{ "testcpp-module.html", "testqdoc-test.html",
+                             "testqdoc-test-members.html", "testqdoc.html" };
+    runQDocProcess(args);
+    if (QTest::currentTestFailed())
+        return;
+    QCOMPARE(timingsCounter(report, "filesReplayed"), 0);
+
+    // A second run replays the unchanged source file and keeps the pages.
+    runQDocProcess(args);
+    if (QTest::currentTestFailed())
+        return;
+    compareLineByLine(pages);
+    QCOMPARE(timingsCounter(report, "filesReplayed"), 1);
+    QVERIFY(timingsCounter(report, "pagesUnchanged") >= pages.size());
+
+    // An edited source file is parsed again.
+    QFile source(sourceDir.filePath("testcpp.cpp"));
+    QVERIFY(source.open(QIODevice::ReadWrite));
+    QVERIFY(source.setFileTime(QDateTime::currentDateTime().addDays(-1),
+                               QFileDevice::FileModificationTime));
+    source.close();
+    runQDocProcess(args);
+    if (QTest::currentTestFailed())
+        return;
+    compareLineByLine(pages);
+    QCOMPARE(timingsCounter(report, "filesReplayed"), 0);
+}
+
+void tst_generatedOutput::parallelOutput()
+{
+    for (const char *input : { "test.qdocconf", "testcpp.qdocconf" }) {
+        QTemporaryDir serialDir;
+        QTemporaryDir parallelDir;
+        QVERIFY(serialDir.isValid() && parallelDir.isValid());
+        runQDocProcess({ "-outputdir", serialDir.path(), "-jobs", "1", QFINDTESTDATA(input) });
+        if (QTest::currentTestFailed())
+            return;
+        runQDocProcess({ "-outputdir", parallelDir.path(), "-jobs", "4", QFINDTESTDATA(input) });
+        if (QTest::currentTestFailed())
+            return;
+        compareDirectories(serialDir.path(), parallelDir.path());
+        if (QTest::currentTestFailed())
+            return;
+    }
+}
+
+void tst_generatedOutput::snapshotOutput()
+{
+    QTemporaryDir snapshotDir;
+    QTemporaryDir plainDir;
+    QTemporaryDir replayedDir;
+    QVERIFY(snapshotDir.isValid() && plainDir.isValid() && replayedDir.isValid());
+    const QString input = QFINDTESTDATA("testcpp.qdocconf");
+    const QString snapshot = snapshotDir.filePath("testcpp.snapshot");
+    const QString report = snapshotDir.filePath("timings.json");
+
+    for (const char *phase : { "-prepare", "-generate" }) {
+        runQDocProcess({ "-outputdir", plainDir.path(), phase, input });
+        if (QTest::currentTestFailed())
+            return;
+    }
+
+    runQDocProcess({ "-outputdir", replayedDir.path(), "-prepare",
+                     "-snapshot", snapshot, input });
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(QFile::exists(snapshot));
+    runQDocProcess({ "-outputdir", replayedDir.path(), "-generate",
+                     "-snapshot", snapshot, "-timings", report, input });
+    if (QTest::currentTestFailed())
+        return;
+
+    // The generate phase replays the source file instead of parsing it.
+    QCOMPARE(timingsCounter(report, "filesReplayed"), 1);
+    compareDirectories(plainDir.path(), replayedDir.path());
+}
+
+void tst_generatedOutput::batchOutput()
+{
+    QTemporaryDir sourceDir;
+    QVERIFY(sourceDir.isValid());
+    const QString broken = sourceDir.filePath("broken.qdocconf");
+    QFile brokenFile(broken);
+    QVERIFY(brokenFile.open(QIODevice::WriteOnly));
+    brokenFile.write("project = Broken\n}\n");
+    brokenFile.close();
+
+    QProcess qdocProcess;
+    qdocProcess.setProgram(m_qdoc);
+    qdocProcess.setArguments({ "-outputdir", m_outputDir->path(), "-batch",
+                               QFINDTESTDATA("test.qdocconf") });
+    qdocProcess.start();
+    QVERIFY(qdocProcess.waitForStarted());
+    const QString batch = broken + "\n" + QFINDTESTDATA("testcpp.qdocconf") + "\n";
+    qdocProcess.write(batch.toLocal8Bit());
+    qdocProcess.closeWriteChannel();
+    QVERIFY(qdocProcess.waitForFinished());
+
+    // The fatal error in one module does not end the batch.
+    const QString output = QString::fromLocal8Bit(qdocProcess.readAllStandardOutput());
+    QVERIFY2(output.contains("qdoc: batch of 1 done\n"), qPrintable(output));
+    QVERIFY2(output.contains("qdoc: " + broken + " failed\n"), qPrintable(output));
+    QVERIFY2(output.contains("qdoc: batch of 2 done, 1 failed\n"), qPrintable(output));
+    QVERIFY(qdocProcess.exitCode() != 0);
+    compareLineByLine({ "testcpp-module.html", "testqdoc-test.html",
+                        "testqdoc-test-members.html", "testqdoc.html" });
+}
+
+void tst_generatedOutput::inheritedByFromIndex()
+{
+    QTemporaryDir sourceDir;
+    QVERIFY(sourceDir.isValid());
+    copyTestData({ "testcpp.qdocconf", "testcpp.h", "testcpp.cpp" }, sourceDir.path());
+    if (QTest::currentTestFailed())
+        return;
+
+    // Another module derives a class from TestQDoc::Test.
+    const QString index = sourceDir.filePath("elsewhere.index");
+    QFile indexFile(index);
+    QVERIFY(indexFile.open(QIODevice::WriteOnly));
+    indexFile.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                    "<!DOCTYPE QDOCINDEX>\n"
+                    "<INDEX url=\"\" title=\"Elsewhere Reference Documentation\" "
+                    "version=\"\" project=\"Elsewhere\">\n"
+                    "<namespace name=\"\" status=\"active\" access=\"public\" module=\"elsewhere\">\n"
+                    "<class name=\"Elsewhere\" href=\"elsewhere.html\" status=\"active\" "
+                    "access=\"public\" location=\"elsewhere.h\" documented=\"true\" "
+                    "bases=\"TestQDoc::Test\" module=\"Elsewhere\" brief=\"A derived class\"/>\n"
+                    "</namespace>\n"
+                    "</INDEX>\n");
+    indexFile.close();
+    const QString config = sourceDir.filePath("elsewhere.qdocconf");
+    QFile configFile(config);
+    QVERIFY(configFile.open(QIODevice::WriteOnly));
+    configFile.write("include(testcpp.qdocconf)\nindexes = elsewhere.index\n");
+    configFile.close();
+
+    // The XML index is read before parsing; the binary one on demand.
+    QTemporaryDir xmlDir;
+    QTemporaryDir binaryDir;
+    QVERIFY(xmlDir.isValid() && binaryDir.isValid());
+    runQDocProcess({ "-outputdir", xmlDir.path(), config });
+    if (QTest::currentTestFailed())
+        return;
+    QVERIFY(BinaryIndexReader::write(index));
+    runQDocProcess({ "-outputdir", binaryDir.path(), config });
+    if (QTest::currentTestFailed())
+        return;
+
+    QFile page(xmlDir.filePath("testqdoc-test.html"));
+    QVERIFY(page.open(QIODevice::ReadOnly));
+    QVERIFY(page.readAll().contains("elsewhere.html"));
+    compareDirectories(xmlDir.path(), binaryDir.path());
+}
+
+void tst_generatedOutput::linkSuggestions()
+{
+    QTemporaryDir sourceDir;
+    QVERIFY(sourceDir.isValid());
+    QFile config(sourceDir.filePath("links.qdocconf"));
+    QVERIFY(config.open(QIODevice::WriteOnly));
+    config.write("project = Links\nsources = links.qdoc\n");
+    config.close();
+    QFile source(sourceDir.filePath("links.qdoc"));
+    QVERIFY(source.open(QIODevice::WriteOnly));
+    source.write("/*!\n"
+                 "    \\page links.html\n"
+                 "    \\title Misspelled Links\n"
+                 "\n"
+                 "    See \\l {Target Page} and \\l {Targt Page}.\n"
+                 "*/\n"
+                 "\n"
+                 "/*!\n"
+                 "    \\page target.html\n"
+                 "    \\title Target Page\n"
+                 "*/\n");
+    source.close();
+
+    QProcess qdocProcess;
+    qdocProcess.setProgram(m_qdoc);
+    qdocProcess.setArguments({ "-outputdir", m_outputDir->path(),
+                               sourceDir.filePath("links.qdocconf") });
+    qdocProcess.start();
+    QVERIFY(qdocProcess.waitForFinished());
+    QCOMPARE(qdocProcess.exitCode(), 0);
+
+    const QString errors = QString::fromLocal8Bit(qdocProcess.readAllStandardError());
+    QVERIFY2(errors.contains("Can't link to 'Targt Page'"), qPrintable(errors));
+    QVERIFY2(errors.contains("[Maybe you meant 'Target Page'?]"), qPrintable(errors));
+    QVERIFY2(!errors.contains("Can't link to 'Target Page'"), qPrintable(errors));
+}
+
 QTEST_APPLESS_MAIN(tst_generatedOutput)
 
 #include "tst_generatedoutput.moc"
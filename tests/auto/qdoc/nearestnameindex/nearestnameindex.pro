@@ -0,0 +1,11 @@
+CONFIG += testcase
+QT = core testlib
+TARGET = tst_nearestnameindex
+INCLUDEPATH += $$PWD/../../../../src/qdoc
+
+HEADERS += \
+    $$PWD/../../../../src/qdoc/editdistance.h
+
+SOURCES += \
+    $$PWD/../../../../src/qdoc/editdistance.cpp \
+    tst_nearestnameindex.cpp
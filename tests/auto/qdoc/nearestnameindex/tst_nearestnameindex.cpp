@@ -0,0 +1,166 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "editdistance.h"
+
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+class tst_NearestNameIndex : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void emptyIndex();
+    void tolerance_data();
+    void tolerance();
+    void caseFolding();
+    void ordering();
+    void matchesLinearSearch();
+};
+
+void tst_NearestNameIndex::emptyIndex()
+{
+    NearestNameIndex index;
+    QVERIFY(index.isEmpty());
+    QVERIFY(index.nearest("QObject").isEmpty());
+
+    index.insert(QString());
+    QVERIFY(index.isEmpty());
+    index.insert("QObject");
+    QVERIFY(index.nearest(QString()).isEmpty());
+}
+
+void tst_NearestNameIndex::tolerance_data()
+{
+    QTest::addColumn<QString>("name");
+    QTest::addColumn<QString>("actual");
+    QTest::addColumn<bool>("found");
+
+    // One edit for names shorter than five characters
+    QTest::newRow("4 chars, 1 edit") << "abcd" << "abcx" << true;
+    QTest::newRow("4 chars, 2 edits") << "abcd" << "abxy" << false;
+    // Two edits for names of up to eleven characters
+    QTest::newRow("5 chars, 2 edits") << "abcde" << "abcxy" << true;
+    QTest::newRow("5 chars, 3 edits") << "abcde" << "abxyz" << false;
+    QTest::newRow("11 chars, 2 edits") << "abcdefghijk" << "abcdefghixy" << true;
+    QTest::newRow("11 chars, 3 edits") << "abcdefghijk" << "abcdefghxyz" << false;
+    // Three edits for longer names
+    QTest::newRow("12 chars, 3 edits") << "abcdefghijkl" << "abcdefghixyz" << true;
+    QTest::newRow("12 chars, 4 edits") << "abcdefghijkl" << "abcdefghwxyz" << false;
+    // The tolerance follows the length of the misspelled name
+    QTest::newRow("insertions") << "abcd" << "abcdxy" << true;
+    QTest::newRow("deletions") << "abcdefgh" << "abcd" << false;
+}
+
+void tst_NearestNameIndex::tolerance()
+{
+    QFETCH(QString, name);
+    QFETCH(QString, actual);
+    QFETCH(bool, found);
+
+    NearestNameIndex index;
+    index.insert(name);
+    QCOMPARE(index.nearest(actual), found ? QStringList(name) : QStringList());
+}
+
+void tst_NearestNameIndex::caseFolding()
+{
+    NearestNameIndex index;
+    index.insert("QObject");
+    index.insert("qobject");
+    QCOMPARE(index.size(), 1);
+
+    // A name that only differs in case is at distance 0, and is
+    // returned as it was inserted.
+    QCOMPARE(index.nearest("qobject"), QStringList("QObject"));
+    QCOMPARE(index.nearest("QOBJECT"), QStringList("QObject"));
+    QCOMPARE(index.nearest("qobjekt"), QStringList("QObject"));
+
+    // The misspelled name itself is never suggested.
+    QVERIFY(index.nearest("QObject").isEmpty());
+}
+
+void tst_NearestNameIndex::ordering()
+{
+    NearestNameIndex index;
+    const QStringList names = { "abcxyf", "abcdxf", "abcdeg", "abcdef" };
+    for (const auto &name : names)
+        index.insert(name);
+
+    // Closest first, and names at the same distance in order.
+    const QStringList expected = { "abcdef", "abcdeg", "abcdxf" };
+    QCOMPARE(index.nearest("abcdez"), expected);
+    QCOMPARE(index.nearest("abcdez", 2), expected.mid(0, 2));
+    QCOMPARE(index.nearest("abcdez", 1), expected.mid(0, 1));
+}
+
+void tst_NearestNameIndex::matchesLinearSearch()
+{
+    // Names that share prefixes and suffixes, so that the tree has
+    // many entries at small distances from each other.
+    const QStringList stems = { "Object", "Widget", "String", "List", "Map", "Item" };
+    const QStringList prefixes = { "Q", "QAbstract", "QQuick", "QStandard", "" };
+    const QStringList suffixes = { "", "Model", "View", "Private", "s", "::value" };
+    QStringList names;
+    for (const auto &prefix : prefixes) {
+        for (const auto &stem : stems) {
+            for (const auto &suffix : suffixes)
+                names << prefix + stem + suffix;
+        }
+    }
+
+    NearestNameIndex index;
+    for (const auto &name : qAsConst(names))
+        index.insert(name);
+    QCOMPARE(index.size(), names.size());
+
+    const QStringList queries = { "QObjekt", "QWidgt", "QStrnig", "QAbstractListModle",
+                                  "QQuickItemVeiw", "Maps", "QMap::valeu", "Lsit",
+                                  "qstandarditemmodel", "Widgets" };
+    for (const auto &actual : queries) {
+        const QString key = actual.toLower();
+        const int tolerance = key.length() < 5 ? 1 : (key.length() < 12 ? 2 : 3);
+        QVector<QPair<int, QString> > matches;
+        for (const auto &name : qAsConst(names)) {
+            const int distance = editDistance(key, name.toLower());
+            if (distance <= tolerance && name != actual)
+                matches.append(qMakePair(distance, name));
+        }
+        std::sort(matches.begin(), matches.end());
+        QStringList expected;
+        for (int i = 0; i < matches.size() && i < 3; ++i)
+            expected << matches.at(i).second;
+        QCOMPARE(index.nearest(actual), expected);
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_NearestNameIndex)
+
+#include "tst_nearestnameindex.moc"
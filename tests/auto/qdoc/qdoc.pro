@@ -2,4 +2,6 @@ TEMPLATE = subdirs
 
 SUBDIRS = \
     generatedoutput \
-    qdoccommandlineparser
+    nearestnameindex \
+    qdoccommandlineparser \
+    qdocindexreader
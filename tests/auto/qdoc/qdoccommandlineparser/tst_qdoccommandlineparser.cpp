@@ -121,6 +121,12 @@ void tst_QDocCommandLineParser::process()
     QVERIFY(!parser.isSet(parser.singleExecOption));
     QVERIFY(!parser.isSet(parser.writeQaPagesOption));
     QVERIFY(!parser.isSet(parser.frameworkOption));
+    QVERIFY(!parser.isSet(parser.jobsOption));
+    QVERIFY(!parser.isSet(parser.incrementalOption));
+    QVERIFY(!parser.isSet(parser.timingsOption));
+    QVERIFY(!parser.isSet(parser.snapshotOption));
+    QVERIFY(!parser.isSet(parser.batchOption));
+    QVERIFY(!parser.isSet(parser.pchCacheOption));
 
     const QStringList expectedPositionalArgument = {
         QStringLiteral("/src/qt5/qtgamepad/src/gamepad/doc/qtgamepad.qdocconf")
@@ -182,6 +188,12 @@ void tst_QDocCommandLineParser::argumentsFromCommandLineAndFile()
     QVERIFY(!parser.isSet(parser.singleExecOption));
     QVERIFY(!parser.isSet(parser.writeQaPagesOption));
     QVERIFY(!parser.isSet(parser.frameworkOption));
+    QVERIFY(!parser.isSet(parser.jobsOption));
+    QVERIFY(!parser.isSet(parser.incrementalOption));
+    QVERIFY(!parser.isSet(parser.timingsOption));
+    QVERIFY(!parser.isSet(parser.snapshotOption));
+    QVERIFY(!parser.isSet(parser.batchOption));
+    QVERIFY(!parser.isSet(parser.pchCacheOption));
 
     QCOMPARE(parser.positionalArguments(), expectedPositionalArgument);
 }
@@ -0,0 +1,12 @@
+CONFIG += testcase
+QT = core testlib
+TARGET = tst_qdocindexreader
+INCLUDEPATH += $$PWD/../../../../src/qdoc
+
+HEADERS += \
+    $$PWD/../../../../src/qdoc/qdocindexreader.h
+
+SOURCES += \
+    $$PWD/../../../../src/qdoc/qdocindexreader.cpp \
+    tst_qdocindexreader.cpp
+
@@ -0,0 +1,223 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "qdocindexreader.h"
+
+#include <QtCore/qfile.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtTest/QtTest>
+
+#include <functional>
+
+class tst_QDocIndexReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void roundTrip();
+    void cachedRoundTrip();
+    void staleBinaryIndex();
+    void malformedBinaryIndex();
+
+private:
+    QScopedPointer<QTemporaryDir> m_dir;
+    QString m_xmlPath;
+};
+
+/*
+  Returns the elements read through \a reader, one line per
+  element with its depth, name and attributes, in the order in
+  which QDocIndexFiles visits them.
+ */
+static void readElements(IndexReader &reader, int depth, QStringList &lines)
+{
+    QString line = QString(depth, QLatin1Char(' ')) + reader.name().toString();
+    const QXmlStreamAttributes attributes = reader.attributes();
+    for (const auto &attribute : attributes) {
+        line += QLatin1Char(' ') + attribute.qualifiedName().toString() + QLatin1String("=\"")
+                + attribute.value().toString() + QLatin1Char('"');
+    }
+    lines << line;
+    while (reader.readNextStartElement())
+        readElements(reader, depth + 1, lines);
+}
+
+static QStringList readTree(IndexReader &reader)
+{
+    QStringList lines;
+    if (reader.readNextStartElement())
+        readElements(reader, 0, lines);
+    return lines;
+}
+
+/*
+  Returns the link targets read through \a reader: the targets,
+  keywords and section titles, each qualified by the name of the
+  element that holds it.
+ */
+static QStringList readTargets(IndexReader &reader)
+{
+    QStringList targets;
+    QStringList nodeNames;
+    const std::function<void()> visit = [&]() {
+        const QString element = reader.name().toString();
+        const QXmlStreamAttributes attributes = reader.attributes();
+        const QString name = attributes.value(QLatin1String("name")).toString();
+        if (element == QLatin1String("target") || element == QLatin1String("keyword")
+                || element == QLatin1String("contents")) {
+            targets << element + QLatin1Char(' ') + nodeNames.constLast()
+                           + QLatin1Char('#') + name + QLatin1Char(' ')
+                           + attributes.value(QLatin1String("title")).toString();
+        }
+        nodeNames << name;
+        while (reader.readNextStartElement())
+            visit();
+        nodeNames.removeLast();
+    };
+    if (reader.readNextStartElement())
+        visit();
+    return targets;
+}
+
+void tst_QDocIndexReader::init()
+{
+    m_dir.reset(new QTemporaryDir);
+    QVERIFY(m_dir->isValid());
+    m_xmlPath = m_dir->filePath("testcpp.index");
+    QVERIFY(QFile::copy(QFINDTESTDATA("testdata/testcpp.index"), m_xmlPath));
+    QVERIFY(QFile::setPermissions(m_xmlPath, QFile::ReadOwner | QFile::WriteOwner));
+}
+
+void tst_QDocIndexReader::roundTrip()
+{
+    QVERIFY(BinaryIndexReader::write(m_xmlPath));
+    QVERIFY(QFile::exists(BinaryIndexReader::binaryPath(m_xmlPath)));
+
+    QFile xmlFile(m_xmlPath);
+    QVERIFY(xmlFile.open(QFile::ReadOnly));
+    XmlIndexReader xmlReader(&xmlFile);
+    const QStringList xmlTree = readTree(xmlReader);
+    QVERIFY(xmlTree.size() > 10);
+    QVERIFY(xmlTree.first().startsWith(QLatin1String("INDEX ")));
+    QVERIFY(xmlTree.contains(QLatin1String("     parameter type=\"const QList<int> &\" "
+                                           "name=\"other\" default=\"\"")));
+
+    BinaryIndexReader binaryReader;
+    QVERIFY(binaryReader.open(BinaryIndexReader::binaryPath(m_xmlPath), m_xmlPath));
+    QCOMPARE(readTree(binaryReader), xmlTree);
+
+    xmlFile.seek(0);
+    XmlIndexReader xmlTargetReader(&xmlFile);
+    const QStringList xmlTargets = readTargets(xmlTargetReader);
+    const QStringList expectedTargets = {
+        "contents TestQDoc#usage Usage",
+        "keyword TestCPP#testcpp QDoc Test C++ Classes",
+        "target testcpp-examples.html#first-example First Example",
+        "contents testcpp-examples.html#quoting Quoting \"Code\""
+    };
+    QCOMPARE(xmlTargets, expectedTargets);
+
+    BinaryIndexReader binaryTargetReader;
+    QVERIFY(binaryTargetReader.open(BinaryIndexReader::binaryPath(m_xmlPath), m_xmlPath));
+    QCOMPARE(readTargets(binaryTargetReader), xmlTargets);
+}
+
+void tst_QDocIndexReader::cachedRoundTrip()
+{
+    QFile xmlFile(m_xmlPath);
+    QVERIFY(xmlFile.open(QFile::ReadOnly));
+    XmlIndexReader xmlReader(&xmlFile);
+    const QStringList xmlTree = readTree(xmlReader);
+
+    BinaryIndexReader::setCachingEnabled(true);
+
+    // Without a binary index, the XML index is transcribed in memory.
+    BinaryIndexReader transcribed;
+    QVERIFY(transcribed.openCached(m_xmlPath));
+    QCOMPARE(readTree(transcribed), xmlTree);
+
+    // The second reader is served from the cache.
+    BinaryIndexReader cached;
+    QVERIFY(cached.openCached(m_xmlPath));
+    QCOMPARE(readTree(cached), xmlTree);
+
+    BinaryIndexReader::clearCache();
+    BinaryIndexReader::setCachingEnabled(false);
+}
+
+void tst_QDocIndexReader::staleBinaryIndex()
+{
+    QVERIFY(BinaryIndexReader::write(m_xmlPath));
+    const QString binaryPath = BinaryIndexReader::binaryPath(m_xmlPath);
+
+    // An XML index of another size was not transcribed into it.
+    QFile xmlFile(m_xmlPath);
+    QVERIFY(xmlFile.open(QFile::Append));
+    xmlFile.write("\n");
+    xmlFile.close();
+    QFile binaryFile(binaryPath);
+    QVERIFY(binaryFile.open(QFile::ReadWrite));
+    QVERIFY(binaryFile.setFileTime(QDateTime::currentDateTime().addSecs(60),
+                                   QFileDevice::FileModificationTime));
+    binaryFile.close();
+    BinaryIndexReader otherSize;
+    QVERIFY(!otherSize.open(binaryPath, m_xmlPath));
+
+    // A binary index older than the XML index is not used.
+    QVERIFY(BinaryIndexReader::write(m_xmlPath));
+    QVERIFY(binaryFile.open(QFile::ReadWrite));
+    QVERIFY(binaryFile.setFileTime(QDateTime::currentDateTime().addDays(-1),
+                                   QFileDevice::FileModificationTime));
+    binaryFile.close();
+    BinaryIndexReader older;
+    QVERIFY(!older.open(binaryPath, m_xmlPath));
+}
+
+void tst_QDocIndexReader::malformedBinaryIndex()
+{
+    QVERIFY(BinaryIndexReader::write(m_xmlPath));
+    const QString binaryPath = BinaryIndexReader::binaryPath(m_xmlPath);
+    QFile binaryFile(binaryPath);
+    QVERIFY(binaryFile.open(QFile::ReadWrite));
+    QVERIFY(binaryFile.resize(binaryFile.size() - 6));
+    binaryFile.close();
+
+    BinaryIndexReader truncated;
+    QVERIFY(!truncated.open(binaryPath, m_xmlPath));
+
+    QVERIFY(binaryFile.open(QFile::WriteOnly | QFile::Truncate));
+    binaryFile.write("QDIX");
+    binaryFile.close();
+    BinaryIndexReader headerOnly;
+    QVERIFY(!headerOnly.open(binaryPath, m_xmlPath));
+}
+
+QTEST_APPLESS_MAIN(tst_QDocIndexReader)
+
+#include "tst_qdocindexreader.moc"
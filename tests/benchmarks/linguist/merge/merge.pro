@@ -0,0 +1,13 @@
+CONFIG += benchmark
+QT = core-private tools-private testlib
+TARGET = tst_bench_merge
+DEFINES += QT_NO_CAST_TO_ASCII QT_NO_CAST_FROM_ASCII
+
+include($$PWD/../../../../src/linguist/shared/formats.pri)
+
+INCLUDEPATH += $$PWD/../../../../src/linguist/lupdate
+
+SOURCES += \
+    $$PWD/../../../../src/linguist/lupdate/merge.cpp \
+    $$PWD/../../../../src/linguist/shared/simtexth.cpp \
+    tst_bench_merge.cpp
@@ -0,0 +1,236 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Linguist of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "lupdate.h"
+#include "translator.h"
+
+#include <QtCore/qtemporarydir.h>
+#include <QtTest/QtTest>
+
+/*
+  The lookup that Translator::find(context, comment, refs) did before
+  it used the reference index: a scan of all messages, comparing the
+  references of each message in the context with all of \a refs.
+ */
+static int legacyFind(const Translator &tor, const QString &context, const QString &comment,
+                      const TranslatorMessage::References &refs)
+{
+    if (!refs.isEmpty()) {
+        for (int i = 0; i < tor.messageCount(); ++i) {
+            const TranslatorMessage &msg = tor.constMessage(i);
+            if (msg.context() == context && msg.comment() == comment) {
+                foreach (const TranslatorMessage::Reference &itref, msg.allReferences()) {
+                    foreach (const TranslatorMessage::Reference &ref, refs) {
+                        if (itref == ref)
+                            return i;
+                    }
+                }
+            }
+        }
+    }
+    return -1;
+}
+
+/*
+  Compares the reference lookup used by the similar-text heuristic
+  of lupdate with the linear scan it replaced, and measures merge()
+  on synthetic TS files of up to 60000 messages. In the updated
+  sources, every fifth message has a slightly changed source text,
+  every twentieth message is gone and new messages are added, so
+  the similar-text heuristic has to look up many messages by their
+  references.
+ */
+class tst_Bench_Merge : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void equivalence();
+    void find_data();
+    void find();
+    void merge_data();
+    void merge();
+
+private:
+    const Translator &translation(int count);
+    const Translator &sources(int count);
+    Translator loadTs(const QString &name, const Translator &tor);
+
+    QTemporaryDir dir_;
+    QHash<int, Translator> translations_;
+    QHash<int, Translator> sources_;
+};
+
+static const int messagesPerContext = 100;
+
+static QString sourceText(int i)
+{
+    return QStringLiteral("Message %1 about the item number %2").arg(i).arg(i * 7);
+}
+
+static TranslatorMessage makeMessage(int i, const QString &text)
+{
+    const int context = i / messagesPerContext;
+    return TranslatorMessage(QStringLiteral("Context%1").arg(context), text,
+                             (i % 3) ? QString() : QStringLiteral("comment"), QString(),
+                             QStringLiteral("src/file%1.cpp").arg(context),
+                             10 + 3 * (i % messagesPerContext));
+}
+
+Translator tst_Bench_Merge::loadTs(const QString &name, const Translator &tor)
+{
+    const QString fileName = dir_.filePath(name);
+    ConversionData cd;
+    if (!tor.save(fileName, cd, QStringLiteral("ts")))
+        qFatal("Cannot save %s: %s", qPrintable(fileName), qPrintable(cd.error()));
+    Translator loaded;
+    if (!loaded.load(fileName, cd, QStringLiteral("ts")))
+        qFatal("Cannot load %s: %s", qPrintable(fileName), qPrintable(cd.error()));
+    return loaded;
+}
+
+/*
+  Returns the TS file with \a count translated messages, as
+  read from disk.
+ */
+const Translator &tst_Bench_Merge::translation(int count)
+{
+    if (!translations_.contains(count)) {
+        Translator tor;
+        tor.setLanguageCode(QStringLiteral("de"));
+        for (int i = 0; i < count; ++i) {
+            TranslatorMessage msg = makeMessage(i, sourceText(i));
+            msg.setTranslation(QStringLiteral("Nachricht %1").arg(i));
+            msg.setType(TranslatorMessage::Finished);
+            tor.append(msg);
+        }
+        translations_.insert(count, loadTs(QStringLiteral("tr%1.ts").arg(count), tor));
+    }
+    return translations_[count];
+}
+
+/*
+  Returns the messages extracted from the updated sources for the
+  TS file with \a count messages, as read from disk.
+ */
+const Translator &tst_Bench_Merge::sources(int count)
+{
+    if (!sources_.contains(count)) {
+        Translator tor;
+        for (int i = 0; i < count; ++i) {
+            if (i % 20 == 19)
+                continue;
+            QString text = sourceText(i);
+            if (i % 5 == 0)
+                text += QLatin1Char('.');
+            tor.append(makeMessage(i, text));
+            if (i % 50 == 0)
+                tor.append(makeMessage(i, QStringLiteral("New message %1").arg(i)));
+        }
+        sources_.insert(count, loadTs(QStringLiteral("src%1.ts").arg(count), tor));
+    }
+    return sources_[count];
+}
+
+void tst_Bench_Merge::initTestCase()
+{
+    QVERIFY(dir_.isValid());
+}
+
+void tst_Bench_Merge::equivalence()
+{
+    const Translator &tor = translation(4000);
+    const Translator &virginTor = sources(4000);
+    for (int i = 0; i < virginTor.messageCount(); ++i) {
+        const TranslatorMessage &mv = virginTor.constMessage(i);
+        QCOMPARE(tor.find(mv.context(), mv.comment(), mv.allReferences()),
+                 legacyFind(tor, mv.context(), mv.comment(), mv.allReferences()));
+        QCOMPARE(virginTor.find(mv.context(), mv.comment(), mv.allReferences()),
+                 legacyFind(virginTor, mv.context(), mv.comment(), mv.allReferences()));
+    }
+}
+
+void tst_Bench_Merge::find_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("count");
+    QTest::newRow("scan 2000") << true << 2000;
+    QTest::newRow("scan 10000") << true << 10000;
+    QTest::newRow("index 2000") << false << 2000;
+    QTest::newRow("index 10000") << false << 10000;
+    QTest::newRow("index 60000") << false << 60000;
+}
+
+void tst_Bench_Merge::find()
+{
+    QFETCH(bool, legacy);
+    QFETCH(int, count);
+    const Translator &tor = translation(count);
+    const Translator &virginTor = sources(count);
+    int found = 0;
+    QBENCHMARK {
+        found = 0;
+        for (int i = 0; i < virginTor.messageCount(); ++i) {
+            const TranslatorMessage &mv = virginTor.constMessage(i);
+            const int mi = legacy
+                    ? legacyFind(tor, mv.context(), mv.comment(), mv.allReferences())
+                    : tor.find(mv.context(), mv.comment(), mv.allReferences());
+            if (mi >= 0)
+                ++found;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+void tst_Bench_Merge::merge_data()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("2000") << 2000;
+    QTest::newRow("10000") << 10000;
+    QTest::newRow("60000") << 60000;
+}
+
+void tst_Bench_Merge::merge()
+{
+    QFETCH(int, count);
+    const Translator &tor = translation(count);
+    const Translator &virginTor = sources(count);
+    int messages = 0;
+    QBENCHMARK {
+        QString err;
+        const Translator out = ::merge(tor, virginTor, QList<Translator>(),
+                                       HeuristicSimilarText, err);
+        messages = out.messageCount();
+    }
+    QVERIFY(messages >= count);
+}
+
+QTEST_APPLESS_MAIN(tst_Bench_Merge)
+
+#include "tst_bench_merge.moc"
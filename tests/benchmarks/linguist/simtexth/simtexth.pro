@@ -0,0 +1,10 @@
+CONFIG += benchmark
+QT = core-private tools-private testlib
+TARGET = tst_bench_simtexth
+DEFINES += QT_NO_CAST_TO_ASCII QT_NO_CAST_FROM_ASCII
+
+include($$PWD/../../../../src/linguist/shared/formats.pri)
+
+SOURCES += \
+    $$PWD/../../../../src/linguist/shared/simtexth.cpp \
+    tst_bench_simtexth.cpp
@@ -0,0 +1,269 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the Qt Linguist of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "simtexth.h"
+
+#include <QtTest/QtTest>
+
+#include <algorithm>
+
+/*
+  The scoring that StringSimilarityMatcher did before it counted the
+  bits with qPopulationCount(): the union and intersection matrices
+  are built, and their bits are counted a byte at a time through a
+  table.
+ */
+static int legacyBitCount[256];
+
+static int legacyWorth(const CoMatrix &m)
+{
+    int w = 0;
+    for (int i = 0; i < 50; i++)
+        w += legacyBitCount[m.b[i]];
+    return w;
+}
+
+static int legacyScore(const CoMatrix &m, int length, const CoMatrix &n, int candidateLength)
+{
+    CoMatrix u, v;
+    for (int i = 0; i < 13; ++i) {
+        u.w[i] = m.w[i] | n.w[i];
+        v.w[i] = m.w[i] & n.w[i];
+    }
+    const int delta = qAbs(length - candidateLength);
+    return ((legacyWorth(v) + 1) << 10) / (legacyWorth(u) + (delta << 1) + 1);
+}
+
+/*
+  Compares the search of similar texts through SimilarTextIndex with
+  the scan over all texts that Linguist's guess view did before, and
+  measures both on up to 60000 synthetic source texts. Also compares
+  the scoring of one text against many matrices at once with the
+  table-based scoring it replaced.
+ */
+class tst_Bench_SimText : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void equivalence();
+    void kernelEquivalence();
+    void search_data();
+    void search();
+    void kernel_data();
+    void kernel();
+
+private:
+    const QStringList &texts(int count);
+
+    QHash<int, QStringList> texts_;
+};
+
+static const char * const words[] = {
+    "file", "open", "save", "the", "cannot", "window", "close", "document",
+    "error", "print", "settings", "about", "help", "new", "recent", "quit",
+    "edit", "copy", "paste", "find", "replace", "next", "previous", "zoom"
+};
+static const int wordCount = sizeof(words) / sizeof(words[0]);
+
+static QString text(int i)
+{
+    QString s;
+    const int length = 1 + i % 7;
+    for (int j = 0; j < length; ++j) {
+        if (j)
+            s += QLatin1Char(' ');
+        s += QLatin1String(words[(i * 7 + j * 13 + i / wordCount) % wordCount]);
+    }
+    if (i % 3 == 0)
+        s += QStringLiteral(" %1").arg(i % 100);
+    if (i % 4 == 0)
+        s += QLatin1Char('.');
+    return s;
+}
+
+const QStringList &tst_Bench_SimText::texts(int count)
+{
+    if (!texts_.contains(count)) {
+        QStringList list;
+        for (int i = 0; i < count; ++i)
+            list << text(i);
+        texts_.insert(count, list);
+    }
+    return texts_[count];
+}
+
+void tst_Bench_SimText::initTestCase()
+{
+    for (int i = 0; i < 256; ++i)
+        legacyBitCount[i] = (i & 1) + legacyBitCount[i >> 1];
+}
+
+void tst_Bench_SimText::equivalence()
+{
+    const QStringList &list = texts(3000);
+    SimilarTextIndex index;
+    foreach (const QString &s, list)
+        index.append(s);
+    QCOMPARE(index.size(), list.size());
+
+    for (int q = 0; q < 200; ++q) {
+        const QString query = text(q * 31 + 5) + QLatin1String(q % 2 ? "!" : "");
+        StringSimilarityMatcher matcher(query);
+        QVector<SimilarTextIndex::Match> expected;
+        for (int i = 0; i < list.size(); ++i) {
+            const int score = matcher.getSimilarityScore(list.at(i));
+            if (score >= textSimilarityThreshold) {
+                const SimilarTextIndex::Match match = { i, score };
+                expected << match;
+            }
+        }
+        const QVector<SimilarTextIndex::Match> found = index.matches(query);
+        QCOMPARE(found.size(), expected.size());
+        for (int i = 0; i < found.size(); ++i) {
+            QCOMPARE(found.at(i).index, expected.at(i).index);
+            QCOMPARE(found.at(i).score, expected.at(i).score);
+        }
+    }
+}
+
+void tst_Bench_SimText::search_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("count");
+    QTest::newRow("scan 2000") << true << 2000;
+    QTest::newRow("scan 10000") << true << 10000;
+    QTest::newRow("scan 60000") << true << 60000;
+    QTest::newRow("index 2000") << false << 2000;
+    QTest::newRow("index 10000") << false << 10000;
+    QTest::newRow("index 60000") << false << 60000;
+}
+
+void tst_Bench_SimText::search()
+{
+    QFETCH(bool, legacy);
+    QFETCH(int, count);
+    const QStringList &list = texts(count);
+    SimilarTextIndex index;
+    if (!legacy) {
+        foreach (const QString &s, list)
+            index.append(s);
+    }
+
+    const QString query = text(count / 2) + QLatin1Char('?');
+    int found = 0;
+    QBENCHMARK {
+        found = 0;
+        if (legacy) {
+            StringSimilarityMatcher matcher(query);
+            foreach (const QString &s, list) {
+                if (matcher.getSimilarityScore(s) >= textSimilarityThreshold)
+                    ++found;
+            }
+        } else {
+            found = index.matches(query).size();
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+void tst_Bench_SimText::kernelEquivalence()
+{
+    const QStringList &list = texts(3000);
+    QVector<CoMatrix> matrices;
+    QVector<int> lengths;
+    foreach (const QString &s, list) {
+        matrices << CoMatrix(s);
+        lengths << s.length();
+    }
+    QVector<int> scores(list.size());
+
+    for (int q = 0; q < 50; ++q) {
+        const QString query = text(q * 17 + 3);
+        const CoMatrix cm(query);
+        StringSimilarityMatcher matcher(query);
+        matcher.getSimilarityScores(matrices.constData(), lengths.constData(),
+                                    matrices.size(), scores.data());
+        for (int i = 0; i < list.size(); ++i) {
+            const int expected = legacyScore(cm, query.length(), matrices.at(i), lengths.at(i));
+            QCOMPARE(scores.at(i), expected);
+            QCOMPARE(matcher.getSimilarityScore(list.at(i)), expected);
+        }
+    }
+}
+
+void tst_Bench_SimText::kernel_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("table") << 0;
+    QTest::newRow("popcount") << 1;
+    QTest::newRow("popcount batch") << 2;
+}
+
+/*
+  Scores one text against 10000 matrices that are already built,
+  which is the part of the search that the index cannot avoid.
+ */
+void tst_Bench_SimText::kernel()
+{
+    QFETCH(int, mode);
+    const QStringList &list = texts(10000);
+    QVector<CoMatrix> matrices;
+    QVector<int> lengths;
+    foreach (const QString &s, list) {
+        matrices << CoMatrix(s);
+        lengths << s.length();
+    }
+    QVector<int> scores(list.size());
+
+    const QString query = text(4321);
+    const CoMatrix cm(query);
+    const StringSimilarityMatcher matcher(query);
+    QBENCHMARK {
+        switch (mode) {
+        case 0:
+            for (int i = 0; i < matrices.size(); ++i)
+                scores[i] = legacyScore(cm, query.length(), matrices.at(i), lengths.at(i));
+            break;
+        case 1:
+            for (int i = 0; i < matrices.size(); ++i)
+                matcher.getSimilarityScores(&matrices.at(i), &lengths.at(i), 1, &scores[i]);
+            break;
+        default:
+            matcher.getSimilarityScores(matrices.constData(), lengths.constData(),
+                                        matrices.size(), scores.data());
+            break;
+        }
+    }
+    QVERIFY(*std::max_element(scores.cbegin(), scores.cend()) >= textSimilarityThreshold);
+}
+
+QTEST_APPLESS_MAIN(tst_Bench_SimText)
+
+#include "tst_bench_simtexth.moc"
@@ -0,0 +1,12 @@
+CONFIG += benchmark
+QT = core testlib
+TARGET = tst_bench_htmlescape
+INCLUDEPATH += $$PWD/../../../../src/qdoc
+DEFINES += SRCDIR=\\\"$$PWD/../../../../src\\\"
+
+HEADERS += \
+    $$PWD/../../../../src/qdoc/htmlescape.h
+
+SOURCES += \
+    $$PWD/../../../../src/qdoc/htmlescape.cpp \
+    tst_bench_htmlescape.cpp
@@ -0,0 +1,215 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "htmlescape.h"
+
+#include <QtCore/qbuffer.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qtextcodec.h>
+#include <QtCore/qtextstream.h>
+#include <QtCore/qvector.h>
+#include <QtTest/QtTest>
+
+/*
+  The escaping that HtmlGenerator::protect() did before it used
+  HtmlEscape: a new string, built one character at a time, as soon
+  as the first character needs escaping.
+ */
+static QString legacyProtect(const QString &string, const QString &outputEncoding)
+{
+#define APPEND(x) \
+    if (html.isEmpty()) { \
+    html = string; \
+    html.truncate(i); \
+} \
+    html += (x);
+
+    QString html;
+    int n = string.length();
+
+    for (int i = 0; i < n; ++i) {
+        QChar ch = string.at(i);
+
+        if (ch == QLatin1Char('&')) {
+            APPEND("&amp;");
+        } else if (ch == QLatin1Char('<')) {
+            APPEND("&lt;");
+        } else if (ch == QLatin1Char('>')) {
+            APPEND("&gt;");
+        } else if (ch == QLatin1Char('"')) {
+            APPEND("&quot;");
+        } else if ((outputEncoding == QLatin1String("ISO-8859-1") && ch.unicode() > 0x007F)
+                   || (ch == QLatin1Char('*') && i + 1 < n && string.at(i) == QLatin1Char('/'))
+                   || (ch == QLatin1Char('.') && i > 2 && string.at(i - 2) == QLatin1Char('.'))) {
+            APPEND("&#x");
+            html += QString::number(ch.unicode(), 16);
+            html += QLatin1Char(';');
+        } else {
+            if (!html.isEmpty())
+                html += ch;
+        }
+    }
+
+    if (!html.isEmpty())
+        return html;
+    return string;
+
+#undef APPEND
+}
+
+/*
+  Compares the escaping and page buffering of the HTML generator
+  with what it did before, over the lines of the headers and .qdoc
+  files in this repository.
+ */
+class tst_Bench_HtmlEscape : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void equivalence();
+    void protect_data();
+    void protect();
+    void pages_data();
+    void pages();
+
+private:
+    QStringList lines_;
+    QVector<QStringList> pages_;
+};
+
+void tst_Bench_HtmlEscape::initTestCase()
+{
+    QDirIterator it(QStringLiteral(SRCDIR), QStringList() << "*.h" << "*.qdoc",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (!file.open(QFile::ReadOnly | QFile::Text))
+            continue;
+        const QStringList lines = QString::fromUtf8(file.readAll()).split(QLatin1Char('\n'));
+        lines_ += lines;
+        pages_.append(lines);
+    }
+    lines_.append(QString::fromUtf8("Fran\xc3\xa7ois, e.g. i.e. <b>&amp;</b> \"\xe2\x82\xac\""));
+    lines_.append(QStringLiteral("/* comment */"));
+    QVERIFY(!lines_.isEmpty());
+}
+
+void tst_Bench_HtmlEscape::equivalence()
+{
+    const QString latin1 = QStringLiteral("ISO-8859-1");
+    const QString utf8 = QStringLiteral("UTF-8");
+    for (const QString &line : qAsConst(lines_)) {
+        QCOMPARE(HtmlEscape::protect(line, true), legacyProtect(line, latin1));
+        QCOMPARE(HtmlEscape::protect(line, false), legacyProtect(line, utf8));
+    }
+}
+
+void tst_Bench_HtmlEscape::protect_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<QString>("encoding");
+    QTest::newRow("legacy ISO-8859-1") << true << QStringLiteral("ISO-8859-1");
+    QTest::newRow("legacy UTF-8") << true << QStringLiteral("UTF-8");
+    QTest::newRow("HtmlEscape ISO-8859-1") << false << QStringLiteral("ISO-8859-1");
+    QTest::newRow("HtmlEscape UTF-8") << false << QStringLiteral("UTF-8");
+}
+
+void tst_Bench_HtmlEscape::protect()
+{
+    QFETCH(bool, legacy);
+    QFETCH(QString, encoding);
+    const bool escapeNonAscii = (encoding == QLatin1String("ISO-8859-1"));
+    int size = 0;
+    QBENCHMARK {
+        size = 0;
+        for (const QString &line : qAsConst(lines_)) {
+            if (legacy)
+                size += legacyProtect(line, encoding).size();
+            else
+                size += HtmlEscape::protect(line, escapeNonAscii).size();
+        }
+    }
+    QVERIFY(size > 0);
+}
+
+void tst_Bench_HtmlEscape::pages_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::newRow("new buffer per page") << true;
+    QTest::newRow("reused buffer") << false;
+}
+
+/*
+  Writes every file as a page of escaped lines, the way the
+  generator writes its pages through out(), either into a new
+  buffer and stream per page or into one reused buffer and stream.
+ */
+void tst_Bench_HtmlEscape::pages()
+{
+    QFETCH(bool, legacy);
+    QTextCodec *codec = QTextCodec::codecForName("UTF-8");
+    qint64 size = 0;
+    QBENCHMARK {
+        size = 0;
+        QBuffer spare;
+        QTextStream spareOut(&spare);
+        spareOut.setCodec(codec);
+        for (const QStringList &page : qAsConst(pages_)) {
+            if (legacy) {
+                QBuffer buffer;
+                buffer.open(QIODevice::WriteOnly);
+                QTextStream out(&buffer);
+                out.setCodec(codec);
+                for (const QString &line : page)
+                    out << legacyProtect(line, QStringLiteral("UTF-8")) << "<br/>\n";
+                out.flush();
+                size += buffer.data().size();
+            } else {
+                QByteArray &data = spare.buffer();
+                data.resize(0);
+                if (data.capacity() < 64 * 1024)
+                    data.reserve(64 * 1024);
+                spare.open(QIODevice::WriteOnly);
+                for (const QString &line : page)
+                    spareOut << HtmlEscape::protect(line, false) << "<br/>\n";
+                spareOut.flush();
+                size += spare.data().size();
+                spare.close();
+            }
+        }
+    }
+    QVERIFY(size > 0);
+}
+
+QTEST_APPLESS_MAIN(tst_Bench_HtmlEscape)
+
+#include "tst_bench_htmlescape.moc"
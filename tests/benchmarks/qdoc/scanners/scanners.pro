@@ -0,0 +1,12 @@
+CONFIG += benchmark
+QT = core testlib
+TARGET = tst_bench_scanners
+INCLUDEPATH += $$PWD/../../../../src/qdoc
+DEFINES += SRCDIR=\\\"$$PWD/../../../../src\\\"
+
+HEADERS += \
+    $$PWD/../../../../src/qdoc/scanners.h
+
+SOURCES += \
+    $$PWD/../../../../src/qdoc/scanners.cpp \
+    tst_bench_scanners.cpp
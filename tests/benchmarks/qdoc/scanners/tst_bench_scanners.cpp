@@ -0,0 +1,240 @@
+/****************************************************************************
+**
+** Copyright (C) 2019 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of the tools applications of the Qt Toolkit.
+**
+** $QT_BEGIN_LICENSE:GPL-EXCEPT$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 3 as published by the Free Software
+** Foundation with exceptions as appearing in the file LICENSE.GPL3-EXCEPT
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "scanners.h"
+
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qregexp.h>
+#include <QtCore/qstringlist.h>
+#include <QtTest/QtTest>
+
+/*
+  Compares the hand-written scanners used by qdoc with the regular
+  expressions they replaced, over the headers and .qdoc files in
+  this repository.
+ */
+class tst_Bench_Scanners : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void equivalence();
+    void identifiers_data();
+    void identifiers();
+    void preprocessorConditions_data();
+    void preprocessorConditions();
+    void synopses_data();
+    void synopses();
+
+private:
+    QStringList identifiers_;
+    QStringList conditions_;
+    QStringList synopses_;
+};
+
+void tst_Bench_Scanners::initTestCase()
+{
+    QDirIterator it(QStringLiteral(SRCDIR), QStringList() << "*.h" << "*.qdoc",
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QFile file(it.next());
+        if (!file.open(QFile::ReadOnly | QFile::Text))
+            continue;
+        const QString text = QString::fromUtf8(file.readAll());
+        const QStringList lines = text.split(QLatin1Char('\n'));
+        for (const QString &line : lines) {
+            const QString trimmed = line.trimmed();
+            if (trimmed.startsWith(QLatin1Char('#'))) {
+                int i = 1;
+                while (i < trimmed.size() && trimmed.at(i).isLetter())
+                    ++i;
+                conditions_.append(trimmed.mid(i) + QLatin1Char('\n'));
+            }
+        }
+        for (int i = 0; i < text.size(); ) {
+            if (text.at(i).isLetter() || text.at(i) == QLatin1Char('_')) {
+                int start = i;
+                while (i < text.size() && (text.at(i).isLetterOrNumber() || text.at(i) == QLatin1Char('_')))
+                    ++i;
+                identifiers_.append(text.mid(start, i - start));
+            } else {
+                ++i;
+            }
+        }
+    }
+    QVERIFY(!identifiers_.isEmpty());
+    QVERIFY(!conditions_.isEmpty());
+
+    for (int i = 0; i + 2 < identifiers_.size() && synopses_.size() < 20000; i += 3) {
+        synopses_.append(QStringLiteral("QList<%1> <@name>%2</@name>(<@param>%3_1</@param>, "
+                                        "<@type>%1</@type> <@param>%3</@param>)"
+                                        "<@extra>[static]</@extra> <@extra>%2</@extra>")
+                         .arg(identifiers_.at(i), identifiers_.at(i + 1),
+                              identifiers_.at(i + 2).toLower()));
+    }
+}
+
+void tst_Bench_Scanners::equivalence()
+{
+    QRegExp classRegExp("Qt?(?:[A-Z3]+[a-z][A-Za-z]*|t)");
+    QRegExp functionRegExp("q([A-Z][a-z]+)+");
+    for (const QString &ident : qAsConst(identifiers_)) {
+        QCOMPARE(Scanners::isQtClassName(ident), classRegExp.exactMatch(ident));
+        QCOMPARE(Scanners::isQtFunctionName(ident), functionRegExp.exactMatch(ident));
+    }
+
+    QRegExp comment("/(?:\\*.*\\*/|/.*\n|/[^\n]*$)");
+    comment.setMinimal(true);
+    QRegExp definedX("defined ?\\(?([A-Z_0-9a-z]+) ?\\)?");
+    for (const QString &condition : qAsConst(conditions_)) {
+        QString expected = condition;
+        expected.remove(comment);
+        QString actual = condition;
+        Scanners::removeComments(actual);
+        QCOMPARE(actual, expected);
+
+        const QString simplified = expected.simplified();
+        QString name;
+        const bool matched = Scanners::matchDefined(simplified, &name);
+        QCOMPARE(matched, definedX.exactMatch(simplified));
+        if (matched)
+            QCOMPARE(name, definedX.cap(1));
+    }
+
+    QRegExp templateTag("(<[^@>]*>)");
+    QRegExp subscript("<@param>([a-z]+)_([1-9n])</@param>");
+    QRegExp extraRegExp("<@extra>.*</@extra>");
+    extraRegExp.setMinimal(true);
+    for (const QString &synopsis : qAsConst(synopses_)) {
+        int length = 0;
+        const int pos = Scanners::indexOfTemplateTag(synopsis, &length);
+        QCOMPARE(pos, synopsis.indexOf(templateTag));
+        if (pos != -1)
+            QCOMPARE(length, templateTag.cap(1).length());
+
+        QString expected = synopsis;
+        expected.replace(subscript, "<i>\\1<sub>\\2</sub></i>");
+        expected.remove(extraRegExp);
+        QString actual = synopsis;
+        Scanners::markSubscriptParameters(actual);
+        Scanners::removeExtras(actual);
+        QCOMPARE(actual, expected);
+    }
+}
+
+void tst_Bench_Scanners::identifiers_data()
+{
+    QTest::addColumn<bool>("useRegExp");
+    QTest::newRow("QRegExp") << true;
+    QTest::newRow("Scanners") << false;
+}
+
+void tst_Bench_Scanners::identifiers()
+{
+    QFETCH(bool, useRegExp);
+    QRegExp classRegExp("Qt?(?:[A-Z3]+[a-z][A-Za-z]*|t)");
+    QRegExp functionRegExp("q([A-Z][a-z]+)+");
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        for (const QString &ident : qAsConst(identifiers_)) {
+            if (useRegExp) {
+                if (classRegExp.exactMatch(ident) || functionRegExp.exactMatch(ident))
+                    ++count;
+            } else if (Scanners::isQtClassName(ident) || Scanners::isQtFunctionName(ident)) {
+                ++count;
+            }
+        }
+    }
+    QVERIFY(count > 0);
+}
+
+void tst_Bench_Scanners::preprocessorConditions_data()
+{
+    identifiers_data();
+}
+
+void tst_Bench_Scanners::preprocessorConditions()
+{
+    QFETCH(bool, useRegExp);
+    QRegExp comment("/(?:\\*.*\\*/|/.*\n|/[^\n]*$)");
+    comment.setMinimal(true);
+    QRegExp definedX("defined ?\\(?([A-Z_0-9a-z]+) ?\\)?");
+    int count = 0;
+    QBENCHMARK {
+        count = 0;
+        for (const QString &condition : qAsConst(conditions_)) {
+            QString str = condition;
+            if (useRegExp) {
+                str.remove(comment);
+                if (definedX.exactMatch(str.simplified()))
+                    ++count;
+            } else {
+                QString name;
+                Scanners::removeComments(str);
+                if (Scanners::matchDefined(str.simplified(), &name))
+                    ++count;
+            }
+        }
+    }
+}
+
+void tst_Bench_Scanners::synopses_data()
+{
+    identifiers_data();
+}
+
+void tst_Bench_Scanners::synopses()
+{
+    QFETCH(bool, useRegExp);
+    QBENCHMARK {
+        for (const QString &synopsis : qAsConst(synopses_)) {
+            QString marked = synopsis;
+            if (useRegExp) {
+                QRegExp templateTag("(<[^@>]*>)");
+                marked.indexOf(templateTag);
+                marked.replace(QRegExp("<@param>([a-z]+)_([1-9n])</@param>"),
+                               "<i>\\1<sub>\\2</sub></i>");
+                QRegExp extraRegExp("<@extra>.*</@extra>");
+                extraRegExp.setMinimal(true);
+                marked.remove(extraRegExp);
+            } else {
+                int length = 0;
+                Scanners::indexOfTemplateTag(marked, &length);
+                Scanners::markSubscriptParameters(marked);
+                Scanners::removeExtras(marked);
+            }
+        }
+    }
+}
+
+QTEST_APPLESS_MAIN(tst_Bench_Scanners)
+
+#include "tst_bench_scanners.moc"